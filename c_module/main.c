@@ -1,6 +1,8 @@
 // Sample C integration for NLP bot
+// Build: gcc -c main.c && g++ -pthread -c ../cpp_module/python_bridge.cpp $(python3-config --includes)
+//        && g++ -pthread main.o python_bridge.o $(python3-config --ldflags --embed)
 #include <stdio.h>
-void call_python_nlp();
+#include "../cpp_module/python_bridge.h"
 
 int main() {
     printf("C module: calling Python NLP core...\n");
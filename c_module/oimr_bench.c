@@ -0,0 +1,148 @@
+// OIMR Benchmarks
+// Allocate/lookup throughput and latency under thread contention
+// Author: 1proprogrammerchant
+// Build: gcc -std=c11 -O2 -pthread oimr_bench.c -o oimr_bench
+// Usage: ./oimr_bench [keys] [threads] [file]
+// Output: one JSON object per line; each workload is followed by its OIMR counters
+// (probes, CAS retries).
+#define _XOPEN_SOURCE 700 // pthread barriers under -std=c11
+#define OIMR_NO_MAIN
+#include "oimr_highperf.c"
+#include <pthread.h>
+#include <time.h>
+
+#define BENCH_FILE "oimr_bench.dat"
+
+enum Workload { ALLOC_DISTINCT, ALLOC_SHARED, LOOKUP_HIT, LOOKUP_MISS, CHURN, WORKLOAD_COUNT };
+static const char *workload_names[WORKLOAD_COUNT] = {
+    "allocate_distinct", // each thread creates its own keys: bump/free-list and index inserts
+    "allocate_shared",   // all threads get-or-create the same keys: racing CAS on one slot
+    "lookup_hit",
+    "lookup_miss",
+    "release_reallocate" // free-list push/pop plus tombstones
+};
+
+struct Worker {
+    pthread_t thread;
+    int index, threads, keys;
+    enum Workload workload;
+    double *latency_ns;
+    size_t ops;
+};
+
+static pthread_barrier_t start_barrier;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void key_name(char *buf, const char *prefix, int i) { snprintf(buf, IDENTITY_KEY_SIZE, "%s%d", prefix, i); }
+
+static void *run_worker(void *arg) {
+    struct Worker *w = (struct Worker *)arg;
+    char key[IDENTITY_KEY_SIZE];
+    int begin = (int)((long long)w->keys * w->index / w->threads);
+    int end = (int)((long long)w->keys * (w->index + 1) / w->threads);
+    pthread_barrier_wait(&start_barrier);
+    for (int i = begin; i < end; ++i) {
+        double t0 = now_ns();
+        int id = 0;
+        switch (w->workload) {
+        case ALLOC_DISTINCT: key_name(key, "d", i); id = allocate_identity(key); break;
+        // Every thread walks the same keys in the same order
+        case ALLOC_SHARED: key_name(key, "s", i - begin); id = allocate_identity(key); break;
+        case LOOKUP_HIT: key_name(key, "d", (int)(((unsigned)i * 2654435761u) % (unsigned)w->keys)); id = lookup_identity(key); break;
+        case LOOKUP_MISS: key_name(key, "m", i); id = lookup_identity(key) < 0; break;
+        case CHURN:
+            key_name(key, "c", i);
+            id = allocate_identity(key);
+            if (id > 0) id = release_identity(id) == 0;
+            break;
+        default: break;
+        }
+        w->latency_ns[w->ops++] = now_ns() - t0;
+        if (id <= 0) {
+            fprintf(stderr, "%s: op %d failed\n", workload_names[w->workload], i);
+            break;
+        }
+    }
+    return NULL;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void run_workload(enum Workload wl, int keys, int threads) {
+    struct Worker *workers = calloc((size_t)threads, sizeof *workers);
+    double *samples = malloc(sizeof(double) * (size_t)keys);
+    pthread_barrier_init(&start_barrier, NULL, (unsigned)threads + 1);
+    for (int t = 0; t < threads; ++t) {
+        workers[t].index = t;
+        workers[t].threads = threads;
+        workers[t].keys = keys;
+        workers[t].workload = wl;
+        workers[t].latency_ns = samples + (size_t)keys * t / threads;
+        pthread_create(&workers[t].thread, NULL, run_worker, &workers[t]);
+    }
+    struct OimrMetrics before;
+    oimr_metrics_snapshot(&before);
+    pthread_barrier_wait(&start_barrier);
+    double t0 = now_ns();
+    size_t ops = 0;
+    for (int t = 0; t < threads; ++t) {
+        pthread_join(workers[t].thread, NULL);
+        ops += workers[t].ops;
+    }
+    double elapsed = now_ns() - t0;
+    pthread_barrier_destroy(&start_barrier);
+
+    // Gather the per-thread samples (each thread filled a prefix of its range)
+    size_t n = 0;
+    for (int t = 0; t < threads; ++t) {
+        memmove(samples + n, workers[t].latency_ns, workers[t].ops * sizeof(double));
+        n += workers[t].ops;
+    }
+    qsort(samples, n, sizeof(double), compare_double);
+#define PCT(p) (n ? samples[(size_t)((p) * (n - 1))] : 0.0)
+    printf("{\"bench\":\"%s\",\"keys\":%d,\"threads\":%d,\"ops\":%zu,\"ops_per_sec\":%.0f,"
+           "\"p50_ns\":%.0f,\"p90_ns\":%.0f,\"p99_ns\":%.0f,\"max_ns\":%.0f}\n",
+           workload_names[wl], keys, threads, ops, ops / (elapsed * 1e-9), PCT(0.5), PCT(0.9), PCT(0.99), PCT(1.0));
+#undef PCT
+    oimr_metrics_dump(stdout, 1, &before);
+    free(samples);
+    free(workers);
+}
+
+int main(int argc, char **argv) {
+    int keys = argc > 1 ? atoi(argv[1]) : 100000;
+    int threads = argc > 2 ? atoi(argv[2]) : 4;
+    const char *file = argc > 3 ? argv[3] : BENCH_FILE;
+    if (keys < 1 || threads < 1 || keys > MAX_IDENTITIES / 4) {
+        fprintf(stderr, "usage: %s [keys <= %d] [threads] [file]\n", argv[0], MAX_IDENTITIES / 4);
+        return 2;
+    }
+    unlink(file);
+    if (map_registry(file) != 0) {
+        fprintf(stderr, "Failed to map %s: %s\n", file, strerror(errno));
+        return 1;
+    }
+    registry_was_dirty();
+    for (int wl = 0; wl < WORKLOAD_COUNT; ++wl) run_workload((enum Workload)wl, keys, threads);
+
+    // Footprint: file blocks actually backed, per live identity (index pages are sparse)
+    struct stat st;
+    int live = 0, n = atomic_load(&registry->next_fresh);
+    for (int i = 0; i < n; ++i) live += atomic_load(&block_at((uint32_t)i)->committed);
+    if (stat(file, &st) == 0)
+        printf("{\"bench\":\"memory\",\"keys\":%d,\"threads\":%d,\"identities\":%d,\"segments\":%u,"
+               "\"block_bytes\":%zu,\"disk_bytes_per_identity\":%.1f}\n",
+               keys, threads, live, atomic_load(&registry->segment_count), sizeof(struct IdentityBlock),
+               live ? (double)st.st_blocks * 512 / live : 0.0);
+    unmap_registry();
+    unlink(file);
+    return 0;
+}
@@ -17,86 +17,597 @@ int ftruncate(int fd, off_t length);
 #include <windows.h>
 #else
 #include <sys/mman.h>
+#include <sys/file.h>
+#include <sys/stat.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <sys/types.h>
 #endif
 
 #define CACHE_LINE_SIZE 64
-#define MAX_IDENTITIES 1024
 #define IDENTITY_KEY_SIZE 32
+#define INDEX_EMPTY 0u
+#define INDEX_TOMBSTONE 0xFFFFFFFFu
+#define INDEX_LOCKED 0xFFFFFFFEu  // empty, held while the tombstone before it is emptied
+#define INDEX_PENDING 0x80000000u // flag: published, not yet confirmed the only entry for its key
 #define REGISTRY_FILE "identity_registry.dat"
 
+// File layout (every region starts on a 64 KiB boundary, the Windows mapping granularity):
+//   [header][key index][segment 0][segment 1]...
+// Segment k holds SEGMENT_BLOCKS << k blocks, so the registry doubles as it grows
+// and an existing segment is never remapped or moved: IdentityBlock pointers stay valid.
+#define REGISTRY_MAGIC "OIMRSEG"
+#define REGISTRY_VERSION 2
+#define REGION_ALIGN 65536
+#define SEGMENT_BLOCKS 1024
+#define MAX_SEGMENTS 32
+#define OPENER_LOCK_OFFSET ((uint64_t)1 << 40) // byte locked by openers, past any data
+#ifndef MAX_IDENTITIES
+#define MAX_IDENTITIES (1 << 22) // capacity limit; sizes the key index at file creation
+#endif
+
 // Fixed-size, cache-aligned identity block
 struct __attribute__((aligned(CACHE_LINE_SIZE))) IdentityBlock {
     atomic_int in_use; // 4 bytes, atomic for lock-free
     int id;            // 4 bytes
     char identity_key[IDENTITY_KEY_SIZE]; // 32 bytes
-    uint8_t reserved[CACHE_LINE_SIZE - 4 - 4 - IDENTITY_KEY_SIZE]; // pad to 64 bytes
+    uint32_t key_hash;  // 4 bytes, cached for index probes
+    uint32_t next_free; // 4 bytes, free-list link (block index + 1, 0 = end)
+    atomic_int committed; // 4 bytes, set after id/key are written (and synced in durable mode)
+    atomic_uint generation; // 4 bytes, bumped each time the block is recycled
+    uint8_t reserved[CACHE_LINE_SIZE - 4 - 4 - IDENTITY_KEY_SIZE - 4 - 4 - 4 - 4]; // pad to 64 bytes
 };
 
 _Static_assert(sizeof(struct IdentityBlock) == CACHE_LINE_SIZE, "IdentityBlock must be 64 bytes");
+_Static_assert(MAX_IDENTITIES < INDEX_PENDING, "block index + 1 must leave the pending bit clear");
 
-struct IdentityRegistry {
-    struct IdentityBlock blocks[MAX_IDENTITIES];
+// Persistent header. The key index is open-addressed with linear probing; a slot
+// holds block index + 1. Released keys leave a tombstone that later inserts reuse;
+// tombstones ending a probe chain are emptied again. An insert publishes its block flagged INDEX_PENDING, rescans the probe chain and
+// commits only if no other entry for its key is there, so two racing inserts of one
+// key settle on a single slot. The index is sized once for max_identities
+// (untouched pages stay sparse on disk).
+struct RegistryHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t block_size;
+    uint32_t segment_blocks;
+    uint32_t max_identities;
+    uint32_t index_slots;       // power of two, >= 2 * max_identities
+    uint32_t reserved0;
+    uint64_t index_offset;
+    uint64_t segments_offset;
+    _Atomic uint32_t segment_count; // segments backed by the file
+    atomic_int next_fresh;          // blocks [next_fresh, ...) have never been used
+    _Atomic uint64_t free_head;     // (ABA tag << 32) | (block index + 1)
+    atomic_int dirty;               // set while open; still set after a crash
 };
 
-struct IdentityRegistry *registry = NULL;
+struct RegistryHeader *registry = NULL;
+static _Atomic uint32_t *registry_index = NULL;
+static struct IdentityBlock *_Atomic segments[MAX_SEGMENTS];
+static atomic_flag grow_lock = ATOMIC_FLAG_INIT;
+// Durable mode: msync each block before it is marked committed and before it is
+// published, so power loss cannot persist an index entry for an unwritten block.
+int registry_durable = 0;
+// Set when this process found the registry dirty with no other opener: the last user
+// crashed. Others cannot open it until reclaim_stranded_blocks() has run.
+static int registry_recovering = 0;
 
-// Memory-map the registry file for persistence
-int map_registry(const char *filename) {
+// ---- metrics: per-thread counters, summed on demand ----
+// Each thread bumps its own cache line; oimr_metrics_snapshot() adds them up without
+// stopping anyone. Threads beyond OIMR_METRIC_THREADS share the last slot.
+enum {
+    OIMR_ALLOCATIONS, OIMR_LOOKUPS, OIMR_RELEASES,
+    OIMR_PROBES,            // index slots examined by allocate/lookup
+    OIMR_INDEX_CAS_LOST,    // allocate lost the publish CAS on an empty slot
+    OIMR_FREE_POP_RETRIES,  // free-list pop CAS retries
+    OIMR_FREE_PUSH_RETRIES, // free-list push CAS retries
+    OIMR_MAP_RACES,         // segment mapped twice, loser unmapped
+    OIMR_METRIC_COUNT
+};
+#define OIMR_METRIC_THREADS 256
+
+struct OimrMetrics {
+    uint64_t allocations, lookups, releases, probes, index_cas_lost, free_pop_retries, free_push_retries, map_races;
+};
+
+struct __attribute__((aligned(CACHE_LINE_SIZE))) MetricSlot {
+    _Atomic uint64_t v[OIMR_METRIC_COUNT];
+};
+static struct MetricSlot metric_slots[OIMR_METRIC_THREADS];
+static atomic_int metric_slots_used;
+static _Thread_local struct MetricSlot *metric_slot;
+
+static void count_event(int metric, uint64_t n) {
+    if (!metric_slot) {
+        int i = atomic_fetch_add(&metric_slots_used, 1);
+        metric_slot = &metric_slots[i < OIMR_METRIC_THREADS ? i : OIMR_METRIC_THREADS - 1];
+    }
+    atomic_fetch_add_explicit(&metric_slot->v[metric], n, memory_order_relaxed);
+}
+
+void oimr_metrics_snapshot(struct OimrMetrics *out) {
+    uint64_t sum[OIMR_METRIC_COUNT] = {0};
+    for (int t = 0; t < OIMR_METRIC_THREADS; ++t)
+        for (int m = 0; m < OIMR_METRIC_COUNT; ++m) sum[m] += atomic_load_explicit(&metric_slots[t].v[m], memory_order_relaxed);
+    out->allocations = sum[OIMR_ALLOCATIONS];
+    out->lookups = sum[OIMR_LOOKUPS];
+    out->releases = sum[OIMR_RELEASES];
+    out->probes = sum[OIMR_PROBES];
+    out->index_cas_lost = sum[OIMR_INDEX_CAS_LOST];
+    out->free_pop_retries = sum[OIMR_FREE_POP_RETRIES];
+    out->free_push_retries = sum[OIMR_FREE_PUSH_RETRIES];
+    out->map_races = sum[OIMR_MAP_RACES];
+}
+
+// Counters since *since (NULL: since start), as one JSON line or a text block.
+void oimr_metrics_dump(FILE *out, int json, const struct OimrMetrics *since) {
+    struct OimrMetrics m, zero = {0};
+    oimr_metrics_snapshot(&m);
+    if (!since) since = &zero;
+    uint64_t ops = (m.allocations - since->allocations) + (m.lookups - since->lookups);
+    fprintf(out, json ? "{\"metrics\":\"oimr\",\"allocations\":%llu,\"lookups\":%llu,\"releases\":%llu,\"probes\":%llu,"
+                        "\"probes_per_op\":%.2f,\"index_cas_lost\":%llu,\"free_pop_retries\":%llu,\"free_push_retries\":%llu,"
+                        "\"map_races\":%llu}\n"
+                      : "allocations %llu, lookups %llu, releases %llu\nprobes %llu (%.2f per op)\n"
+                        "CAS retries: index publish %llu, free-list pop %llu, free-list push %llu; segment map races %llu\n",
+            (unsigned long long)(m.allocations - since->allocations), (unsigned long long)(m.lookups - since->lookups),
+            (unsigned long long)(m.releases - since->releases), (unsigned long long)(m.probes - since->probes),
+            ops ? (double)(m.probes - since->probes) / ops : 0.0,
+            (unsigned long long)(m.index_cas_lost - since->index_cas_lost),
+            (unsigned long long)(m.free_pop_retries - since->free_pop_retries),
+            (unsigned long long)(m.free_push_retries - since->free_push_retries),
+            (unsigned long long)(m.map_races - since->map_races));
+}
+
+// ---- platform layer: file handle, cross-process lock, grow, map, sync ----
 #ifdef _WIN32
-    HANDLE hFile = CreateFileA(filename, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
-    if (hFile == INVALID_HANDLE_VALUE) return -1;
-    DWORD size = sizeof(struct IdentityRegistry);
-    SetFilePointer(hFile, size, NULL, FILE_BEGIN);
-    SetEndOfFile(hFile);
-    HANDLE hMap = CreateFileMappingA(hFile, NULL, PAGE_READWRITE, 0, size, NULL);
-    if (!hMap) return -1;
-    registry = (struct IdentityRegistry *)MapViewOfFile(hMap, FILE_MAP_ALL_ACCESS, 0, 0, size);
-    CloseHandle(hMap); CloseHandle(hFile);
-    return registry ? 0 : -1;
+static HANDLE registry_file = INVALID_HANDLE_VALUE;
+static int os_open(const char *filename) {
+    registry_file = CreateFileA(filename, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                                OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    return registry_file == INVALID_HANDLE_VALUE ? -1 : 0;
+}
+static void os_lock(void) { OVERLAPPED ov = {0}; LockFileEx(registry_file, LOCKFILE_EXCLUSIVE_LOCK, 0, 1, 0, &ov); }
+static void os_unlock(void) { OVERLAPPED ov = {0}; UnlockFileEx(registry_file, 0, 1, 0, &ov); }
+static uint64_t os_size(void) { LARGE_INTEGER sz; return GetFileSizeEx(registry_file, &sz) ? (uint64_t)sz.QuadPart : 0; }
+static int os_grow(uint64_t size) {
+    LARGE_INTEGER sz; sz.QuadPart = (LONGLONG)size;
+    return SetFilePointerEx(registry_file, sz, NULL, FILE_BEGIN) && SetEndOfFile(registry_file) ? 0 : -1;
+}
+static void *os_map(uint64_t offset, size_t len) {
+    HANDLE hMap = CreateFileMappingA(registry_file, NULL, PAGE_READWRITE, 0, 0, NULL);
+    if (!hMap) return NULL;
+    void *p = MapViewOfFile(hMap, FILE_MAP_ALL_ACCESS, (DWORD)(offset >> 32), (DWORD)offset, len);
+    CloseHandle(hMap);
+    return p;
+}
+static void os_unmap(void *p, size_t len) { (void)len; UnmapViewOfFile(p); }
+static void os_sync(void *p, size_t len) { FlushViewOfFile(p, len); }
+static void os_close(void) { CloseHandle(registry_file); registry_file = INVALID_HANDLE_VALUE; }
+static int opener_held = 0; // 1 shared, 2 exclusive
+static BOOL opener_lock(DWORD flags) {
+    OVERLAPPED ov = {0};
+    ov.Offset = (DWORD)OPENER_LOCK_OFFSET; ov.OffsetHigh = (DWORD)(OPENER_LOCK_OFFSET >> 32);
+    return LockFileEx(registry_file, flags, 0, 1, 0, &ov);
+}
+static void opener_unlock(void) {
+    OVERLAPPED ov = {0};
+    ov.Offset = (DWORD)OPENER_LOCK_OFFSET; ov.OffsetHigh = (DWORD)(OPENER_LOCK_OFFSET >> 32);
+    UnlockFileEx(registry_file, 0, 1, 0, &ov);
+}
+static int os_claim_sole(void) {
+    if (opener_held) { opener_unlock(); opener_held = 0; }
+    if (!opener_lock(LOCKFILE_EXCLUSIVE_LOCK | LOCKFILE_FAIL_IMMEDIATELY)) return 0;
+    opener_held = 2;
+    return 1;
+}
+static void os_share(void) {
+    if (opener_held == 1) return;
+    opener_lock(0);
+    if (opener_held == 2) opener_unlock(); // drops the exclusive lock, keeps the shared one
+    opener_held = 1;
+}
 #else
-    int fd = open(filename, O_RDWR | O_CREAT, 0666);
-    if (fd < 0) return -1;
-    size_t size = sizeof(struct IdentityRegistry);
-    if (ftruncate(fd, size) != 0) { close(fd); return -1; }
-    void *ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
-    close(fd);
-    if (ptr == MAP_FAILED) return -1;
-    registry = (struct IdentityRegistry *)ptr;
+static int registry_fd = -1;
+static int os_open(const char *filename) {
+    registry_fd = open(filename, O_RDWR | O_CREAT, 0666);
+    return registry_fd < 0 ? -1 : 0;
+}
+static void os_lock(void) { while (flock(registry_fd, LOCK_EX) != 0 && errno == EINTR) {} }
+static void os_unlock(void) { flock(registry_fd, LOCK_UN); }
+static uint64_t os_size(void) { struct stat st; return fstat(registry_fd, &st) == 0 ? (uint64_t)st.st_size : 0; }
+static int os_grow(uint64_t size) { return ftruncate(registry_fd, (off_t)size); }
+static void *os_map(uint64_t offset, size_t len) {
+    void *p = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, registry_fd, (off_t)offset);
+    return p == MAP_FAILED ? NULL : p;
+}
+static void os_unmap(void *p, size_t len) { munmap(p, len); }
+static void os_sync(void *p, size_t len) {
+    uintptr_t page = (uintptr_t)p & ~(uintptr_t)4095;
+    msync((void *)page, len + ((uintptr_t)p - page), MS_SYNC);
+}
+static void os_close(void) { close(registry_fd); registry_fd = -1; }
+static int opener_lock(short type, int wait) {
+    struct flock fl;
+    memset(&fl, 0, sizeof fl);
+    fl.l_type = type;
+    fl.l_whence = SEEK_SET;
+    fl.l_start = (off_t)OPENER_LOCK_OFFSET;
+    fl.l_len = 1;
+    while (fcntl(registry_fd, wait ? F_SETLKW : F_SETLK, &fl) != 0)
+        if (errno != EINTR) return -1;
     return 0;
+}
+static int os_claim_sole(void) { return opener_lock(F_WRLCK, 0) == 0; }
+static void os_share(void) { opener_lock(F_RDLCK, 1); }
 #endif
+
+// Opener tracking: every process with the registry mapped holds a shared lock on
+// OPENER_LOCK_OFFSET; os_claim_sole() takes it exclusively only if no other process
+// holds it. The OS drops the lock when its holder dies, so a set dirty flag with no
+// other opener means the last user crashed.
+
+// Serializes growth within this process (spin) and across processes (file lock,
+// released by the OS if the holder dies).
+static void lock_growth(void) { while (atomic_flag_test_and_set(&grow_lock)) {} os_lock(); }
+static void unlock_growth(void) { os_unlock(); atomic_flag_clear(&grow_lock); }
+
+static uint64_t align_region(uint64_t n) { return (n + REGION_ALIGN - 1) & ~(uint64_t)(REGION_ALIGN - 1); }
+static uint32_t segment_of(uint32_t b) { return 31u - (uint32_t)__builtin_clz(b / SEGMENT_BLOCKS + 1); }
+static uint32_t segment_first(uint32_t k) { return SEGMENT_BLOCKS * ((1u << k) - 1); }
+static size_t segment_bytes(uint32_t k) { return (size_t)(SEGMENT_BLOCKS << k) * sizeof(struct IdentityBlock); }
+static uint64_t segment_offset(uint32_t k) { return registry->segments_offset + (uint64_t)segment_first(k) * sizeof(struct IdentityBlock); }
+
+// Make sure segments [0, k] exist in the file. Only ever grows the file.
+static int ensure_segment(uint32_t k) {
+    if (k >= MAX_SEGMENTS) return -1;
+    if (atomic_load(&registry->segment_count) > k) return 0;
+    lock_growth();
+    int rc = 0;
+    while (rc == 0 && atomic_load(&registry->segment_count) <= k) {
+        uint32_t s = atomic_load(&registry->segment_count);
+        uint64_t end = segment_offset(s) + segment_bytes(s);
+        if (os_size() < end) rc = os_grow(end);
+        if (rc == 0) atomic_store(&registry->segment_count, s + 1);
+    }
+    unlock_growth();
+    return rc;
+}
+
+// Block by index; maps its segment into this process on first touch.
+static struct IdentityBlock *block_at(uint32_t b) {
+    uint32_t k = segment_of(b);
+    if (k >= MAX_SEGMENTS) return NULL;
+    struct IdentityBlock *base = atomic_load_explicit(&segments[k], memory_order_acquire);
+    if (!base) {
+        if (atomic_load(&registry->segment_count) <= k) return NULL;
+        struct IdentityBlock *mapped = (struct IdentityBlock *)os_map(segment_offset(k), segment_bytes(k));
+        if (!mapped) return NULL;
+        if (atomic_compare_exchange_strong(&segments[k], &base, mapped)) {
+            base = mapped;
+        } else {
+            os_unmap(mapped, segment_bytes(k)); // another thread mapped it first
+            count_event(OIMR_MAP_RACES, 1);
+        }
+    }
+    return base + (b - segment_first(k));
+}
+
+// Memory-map the registry file for persistence. Creates and formats a new file;
+// refuses files with a different magic or version.
+int map_registry(const char *filename) {
+    if (os_open(filename) != 0) return -1;
+    uint32_t slots = 1;
+    while (slots < 2u * MAX_IDENTITIES) slots <<= 1;
+    uint64_t index_offset = REGION_ALIGN;
+    uint64_t segments_offset = index_offset + align_region((uint64_t)slots * sizeof(uint32_t));
+    lock_growth();
+    if (os_size() < segments_offset && os_grow(segments_offset) != 0) { unlock_growth(); os_close(); return -1; }
+    registry = (struct RegistryHeader *)os_map(0, REGION_ALIGN);
+    if (!registry) { unlock_growth(); os_close(); return -1; }
+    if (registry->magic[0] == '\0') {
+        registry->version = REGISTRY_VERSION;
+        registry->block_size = sizeof(struct IdentityBlock);
+        registry->segment_blocks = SEGMENT_BLOCKS;
+        registry->max_identities = MAX_IDENTITIES;
+        registry->index_slots = slots;
+        registry->index_offset = index_offset;
+        registry->segments_offset = segments_offset;
+        os_sync(registry, sizeof *registry);
+        memcpy(registry->magic, REGISTRY_MAGIC, sizeof registry->magic); // written last: marks the header complete
+        os_sync(registry, sizeof *registry);
+    }
+    unlock_growth();
+    if (memcmp(registry->magic, REGISTRY_MAGIC, sizeof registry->magic) != 0 || registry->version != REGISTRY_VERSION ||
+        registry->block_size != sizeof(struct IdentityBlock) || registry->segment_blocks != SEGMENT_BLOCKS) {
+        os_unmap(registry, REGION_ALIGN);
+        registry = NULL;
+        os_close();
+        errno = EINVAL;
+        return -1;
+    }
+    registry_index = (_Atomic uint32_t *)os_map(registry->index_offset, (size_t)registry->index_slots * sizeof(uint32_t));
+    if (!registry_index) return -1;
+    int sole = os_claim_sole();
+    if (!sole) os_share(); // waits out a recovery in progress elsewhere
+    registry_recovering = atomic_exchange(&registry->dirty, 1) && sole;
+    if (sole && !registry_recovering) os_share();
+    return 0;
+}
+
+// Returns nonzero if the previous session did not close cleanly and no other process
+// has the registry open. Other processes are then held off until reclaim_stranded_blocks().
+int registry_was_dirty(void) { return registry_recovering; }
+
+void unmap_registry(void) {
+    if (!registry) return;
+    for (uint32_t k = 0; k < MAX_SEGMENTS; ++k) {
+        struct IdentityBlock *base = atomic_exchange(&segments[k], NULL);
+        if (base) { os_sync(base, segment_bytes(k)); os_unmap(base, segment_bytes(k)); }
+    }
+    os_sync(registry_index, (size_t)registry->index_slots * sizeof(uint32_t));
+    os_unmap((void *)registry_index, (size_t)registry->index_slots * sizeof(uint32_t));
+    if (os_claim_sole()) atomic_store(&registry->dirty, 0); // last one out
+    registry_recovering = 0;
+    os_sync(registry, sizeof *registry);
+    os_unmap(registry, REGION_ALIGN);
+    registry = NULL;
+    registry_index = NULL;
+    os_close();
+}
+
+static uint32_t key_hash(const char *key) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < IDENTITY_KEY_SIZE - 1 && key[i]; ++i) h = (h ^ (uint8_t)key[i]) * 16777619u;
+    return (h == INDEX_EMPTY || h == INDEX_TOMBSTONE) ? 1u : h;
+}
+
+static int key_equals(const struct IdentityBlock *blk, uint32_t h, const char *key) {
+    return blk->key_hash == h && strncmp(blk->identity_key, key, IDENTITY_KEY_SIZE - 1) == 0;
+}
+
+// Id of the block published in slot (as v) if it holds key, else 0. Release tombstones
+// the slot before recycling the block, and recycling bumps its generation; slots are
+// reused, so the block was only read intact if both are unchanged after the compare.
+static int slot_match(uint32_t slot, uint32_t v, uint32_t h, const char *key) {
+    struct IdentityBlock *blk = block_at((v & ~INDEX_PENDING) - 1);
+    uint32_t gen = atomic_load_explicit(&blk->generation, memory_order_acquire);
+    if (!key_equals(blk, h, key)) return 0;
+    int id = blk->id;
+    atomic_thread_fence(memory_order_acquire);
+    if (atomic_load(&registry_index[slot]) != v || atomic_load(&blk->generation) != gen) return 0;
+    return id;
+}
+
+// Pop a recycled block (Treiber stack, tagged against ABA) or bump-allocate a fresh one,
+// growing the file by a segment when the bump pointer crosses into a new one.
+static int take_block(void) {
+    uint64_t head = atomic_load(&registry->free_head);
+    for (uint64_t retries = 0; (uint32_t)head != 0; ++retries) {
+        uint32_t idx = (uint32_t)head - 1;
+        uint64_t next = ((head >> 32) + 1) << 32 | block_at(idx)->next_free;
+        if (atomic_compare_exchange_weak(&registry->free_head, &head, next)) {
+            if (retries) count_event(OIMR_FREE_POP_RETRIES, retries);
+            return (int)idx;
+        }
+    }
+    int idx = atomic_fetch_add(&registry->next_fresh, 1);
+    if (idx >= (int)registry->max_identities || ensure_segment(segment_of((uint32_t)idx)) != 0) {
+        atomic_fetch_sub(&registry->next_fresh, 1);
+        return -1;
+    }
+    return idx;
+}
+
+static void give_block(int idx) {
+    struct IdentityBlock *blk = block_at((uint32_t)idx);
+    atomic_fetch_add(&blk->generation, 1);
+    atomic_store(&blk->committed, 0);
+    atomic_store(&blk->in_use, 0);
+    uint64_t head = atomic_load(&registry->free_head);
+    uint64_t retries = 0;
+    for (;; ++retries) {
+        blk->next_free = (uint32_t)head;
+        if (atomic_compare_exchange_weak(&registry->free_head, &head, ((head >> 32) + 1) << 32 | (uint32_t)(idx + 1))) break;
+    }
+    if (retries) count_event(OIMR_FREE_PUSH_RETRIES, retries);
 }
 
-// Lock-free allocation of a new identity block
+// Turns the tombstone at slot back into an empty slot if it ends its probe chain, then
+// the ones before it. The empty slot after each is locked meanwhile, so no insert can
+// publish past a slot while it is being emptied.
+static void trim_tombstones(uint32_t slot) {
+    uint32_t mask = registry->index_slots - 1;
+    for (uint32_t n = 0; n < mask; ++n, slot = (slot - 1) & mask) {
+        uint32_t next = (slot + 1) & mask, v = INDEX_EMPTY;
+        if (!atomic_compare_exchange_strong(&registry_index[next], &v, INDEX_LOCKED)) return;
+        v = INDEX_TOMBSTONE;
+        int emptied = atomic_compare_exchange_strong(&registry_index[slot], &v, INDEX_EMPTY);
+        atomic_store(&registry_index[next], INDEX_EMPTY);
+        if (!emptied) return;
+    }
+}
+
+// Settles a pending entry at target against other inserts of the same key: returns
+// the id of a committed entry to defer to, -2 if an earlier pending one wins, 0 if
+// target may commit. Later pending entries are knocked out (their owners retry).
+static int settle_pending(uint32_t target, uint32_t h, const char *key, uint32_t *examined) {
+    uint32_t mask = registry->index_slots - 1, home = h & mask;
+    int past_target = 0;
+    for (uint32_t probes = 0, slot = home; probes <= mask; ++probes, slot = (slot + 1) & mask) {
+        if (slot == target) { past_target = 1; continue; }
+        ++*examined;
+        uint32_t v = atomic_load(&registry_index[slot]);
+        if ((v == INDEX_EMPTY || v == INDEX_LOCKED) && past_target) break;
+        if (v == INDEX_EMPTY || v == INDEX_LOCKED) return -2; // target fell off the chain's end
+        if (v == INDEX_TOMBSTONE) continue;
+        int id = slot_match(slot, v, h, key);
+        if (!id) continue;
+        if (!(v & INDEX_PENDING)) return id;
+        if (((slot - home) & mask) < ((target - home) & mask)) return -2;
+        if (atomic_compare_exchange_strong(&registry_index[slot], &v, INDEX_TOMBSTONE)) trim_tombstones(slot);
+    }
+    return 0;
+}
+
+// Get-or-create; *examined counts the index slots looked at.
+static int insert_identity(const char *key, uint32_t *examined) {
+    uint32_t h = key_hash(key);
+    uint32_t mask = registry->index_slots - 1;
+    int fresh = -1;
+    for (;;) {
+        // Look the key up, noting the first tombstone or else the empty slot ending the chain.
+        uint32_t slot = h & mask, target = 0, target_v = INDEX_EMPTY;
+        int have_target = 0, id = 0;
+        for (uint32_t probes = 0; probes <= mask && !id; ++probes, slot = (slot + 1) & mask) {
+            ++*examined;
+            uint32_t v = atomic_load_explicit(&registry_index[slot], memory_order_acquire);
+            if (v == INDEX_EMPTY || v == INDEX_LOCKED || v == INDEX_TOMBSTONE) {
+                if (!have_target) { target = slot; target_v = v == INDEX_LOCKED ? INDEX_EMPTY : v; have_target = 1; }
+                if (v != INDEX_TOMBSTONE) break;
+            } else if (!(v & INDEX_PENDING)) {
+                id = slot_match(slot, v, h, key);
+            }
+        }
+        if (id || !have_target) {
+            if (fresh >= 0) give_block(fresh);
+            return id ? id : -1; // found, or index full
+        }
+        if (fresh < 0) {
+            fresh = take_block();
+            if (fresh < 0) return -1; // full
+            struct IdentityBlock *blk = block_at((uint32_t)fresh);
+            atomic_store(&blk->in_use, 1);
+            blk->id = fresh + 1;
+            strncpy(blk->identity_key, key, IDENTITY_KEY_SIZE - 1);
+            blk->identity_key[IDENTITY_KEY_SIZE - 1] = '\0';
+            blk->key_hash = h;
+            if (registry_durable) os_sync(blk, sizeof *blk);
+            atomic_store_explicit(&blk->committed, 1, memory_order_release);
+            if (registry_durable) os_sync(blk, sizeof *blk);
+        }
+        // Publishing the slot releases the fully written block.
+        uint32_t pending = ((uint32_t)fresh + 1) | INDEX_PENDING;
+        if (!atomic_compare_exchange_strong(&registry_index[target], &target_v, pending)) {
+            count_event(OIMR_INDEX_CAS_LOST, 1);
+            continue;
+        }
+        id = settle_pending(target, h, key, examined);
+        if (id == 0 && atomic_compare_exchange_strong(&registry_index[target], &pending, (uint32_t)fresh + 1)) {
+            if (registry_durable) os_sync((void *)&registry_index[target], sizeof(uint32_t));
+            return fresh + 1;
+        }
+        if (atomic_compare_exchange_strong(&registry_index[target], &pending, INDEX_TOMBSTONE)) // unless knocked out already
+            trim_tombstones(target);
+        if (id > 0) {
+            give_block(fresh);
+            return id;
+        }
+        count_event(OIMR_INDEX_CAS_LOST, 1); // lost to another insert of this key; look again
+    }
+}
+
+// Lock-free get-or-create: concurrent callers with the same key get the same id.
+// O(1) expected: one hash probe sequence plus one free-list pop or bump.
+// Commit protocol: write id/key -> (msync) -> committed = 1 -> publish index slot pending
+// -> confirm no other entry for the key -> clear the pending flag (-> msync).
+// An index entry therefore never points at a block whose contents were not written first.
 int allocate_identity(const char *key) {
-    for (int i = 0; i < MAX_IDENTITIES; ++i) {
-        int expected = 0;
-        if (atomic_compare_exchange_strong(&registry->blocks[i].in_use, &expected, 1)) {
-            registry->blocks[i].id = i + 1;
-            strncpy(registry->blocks[i].identity_key, key, IDENTITY_KEY_SIZE - 1);
-            registry->blocks[i].identity_key[IDENTITY_KEY_SIZE - 1] = '\0';
-            return registry->blocks[i].id;
+    uint32_t examined = 0;
+    int id = insert_identity(key, &examined);
+    count_event(OIMR_ALLOCATIONS, 1);
+    count_event(OIMR_PROBES, examined);
+    return id;
+}
+
+// Lock-free lookup by identity key; -1 if absent.
+int lookup_identity(const char *key) {
+    uint32_t h = key_hash(key);
+    uint32_t mask = registry->index_slots - 1;
+    uint32_t slot = h & mask;
+    int id = -1;
+    uint32_t probes = 0;
+    for (; probes <= mask; ++probes, slot = (slot + 1) & mask) {
+        uint32_t v = atomic_load_explicit(&registry_index[slot], memory_order_acquire);
+        if (v == INDEX_EMPTY || v == INDEX_LOCKED) break;
+        int match = v != INDEX_TOMBSTONE && !(v & INDEX_PENDING) ? slot_match(slot, v, h, key) : 0;
+        if (match) { id = match; break; }
+    }
+    count_event(OIMR_LOOKUPS, 1);
+    count_event(OIMR_PROBES, probes + 1);
+    return id;
+}
+
+// Release an identity: tombstone its index slot and recycle the block. 0 on success.
+int release_identity(int id) {
+    if (id < 1 || id > atomic_load(&registry->next_fresh)) return -1;
+    struct IdentityBlock *blk = block_at((uint32_t)id - 1);
+    if (!blk || !atomic_load(&blk->committed)) return -1;
+    uint32_t mask = registry->index_slots - 1;
+    uint32_t slot = blk->key_hash & mask;
+    for (uint32_t probes = 0; probes <= mask; ++probes, slot = (slot + 1) & mask) {
+        uint32_t v = (uint32_t)id;
+        if (atomic_compare_exchange_strong(&registry_index[slot], &v, INDEX_TOMBSTONE)) {
+            trim_tombstones(slot);
+            count_event(OIMR_RELEASES, 1);
+            give_block(id - 1);
+            return 0;
         }
+        if (v == INDEX_EMPTY || v == INDEX_LOCKED) break;
     }
-    return -1; // full
+    return -1; // not published (already released)
 }
 
-// Lock-free retrieval by id
+// Lock-free retrieval by id; only committed blocks are visible
 struct IdentityBlock *get_identity(int id) {
-    if (id < 1 || id > MAX_IDENTITIES) return NULL;
-    struct IdentityBlock *blk = &registry->blocks[id - 1];
-    if (atomic_load(&blk->in_use)) return blk;
+    if (id < 1 || id > atomic_load(&registry->next_fresh)) return NULL;
+    struct IdentityBlock *blk = block_at((uint32_t)id - 1);
+    if (blk && atomic_load_explicit(&blk->committed, memory_order_acquire)) return blk;
     return NULL;
 }
 
+// Recovery after a crash. Readers never need this: an index entry only points at
+// committed blocks. It returns blocks stranded mid-allocation or mid-release to the
+// free list, along with index slots left pending or locked. Run it only while no other
+// process is using the registry, i.e. when registry_was_dirty() says so; other openers
+// are let in when it returns.
+int reclaim_stranded_blocks(void) {
+    uint32_t slots = registry->index_slots;
+    for (uint32_t s = 0; s < slots; ++s) {
+        uint32_t v = atomic_load(&registry_index[s]);
+        if (v == INDEX_LOCKED) atomic_store(&registry_index[s], INDEX_EMPTY);
+        else if (v != INDEX_TOMBSTONE && (v & INDEX_PENDING)) atomic_store(&registry_index[s], INDEX_TOMBSTONE);
+    }
+    for (uint32_t s = 0; s < slots; ++s)
+        if (atomic_load(&registry_index[s]) == INDEX_TOMBSTONE) trim_tombstones(s);
+    int n = atomic_load(&registry->next_fresh);
+    uint8_t *on_free_list = calloc((size_t)n + 1, 1);
+    if (!on_free_list) { registry_recovering = 0; os_share(); return -1; }
+    for (uint32_t f = (uint32_t)atomic_load(&registry->free_head); f != 0 && !on_free_list[f - 1]; f = block_at(f - 1)->next_free)
+        on_free_list[f - 1] = 1;
+    int reclaimed = 0;
+    for (int i = 0; i < n; ++i) {
+        if (on_free_list[i]) continue;
+        struct IdentityBlock *blk = block_at((uint32_t)i);
+        if (atomic_load(&blk->committed) && lookup_identity(blk->identity_key) == blk->id) continue;
+        give_block(i);
+        ++reclaimed;
+    }
+    free(on_free_list);
+    if (registry_recovering) { registry_recovering = 0; os_share(); }
+    return reclaimed;
+}
+
 // Print all identities
 void print_identities() {
     printf("Identity Registry:\n");
-    for (int i = 0; i < MAX_IDENTITIES; ++i) {
-        if (atomic_load(&registry->blocks[i].in_use)) {
-            printf("ID: %d | Key: %s\n", registry->blocks[i].id, registry->blocks[i].identity_key);
+    int n = atomic_load(&registry->next_fresh);
+    for (int i = 0; i < n; ++i) {
+        struct IdentityBlock *blk = block_at((uint32_t)i);
+        if (atomic_load(&blk->committed)) {
+            printf("ID: %d | Key: %s\n", blk->id, blk->identity_key);
         }
     }
 }
@@ -104,24 +615,33 @@ void print_identities() {
 // Leak check: ensure all allocated blocks are accounted for
 void leak_check() {
     int count = 0;
-    for (int i = 0; i < MAX_IDENTITIES; ++i) {
-        if (atomic_load(&registry->blocks[i].in_use)) ++count;
+    int n = atomic_load(&registry->next_fresh);
+    for (int i = 0; i < n; ++i) {
+        if (atomic_load(&block_at((uint32_t)i)->committed)) ++count;
     }
-    printf("[LeakCheck] Allocated blocks: %d\n", count);
+    printf("[LeakCheck] Allocated blocks: %d | Segments: %u\n", count, atomic_load(&registry->segment_count));
+    oimr_metrics_dump(stdout, 0, NULL);
 }
 
+#ifndef OIMR_NO_MAIN // defined by oimr_bench.c, which includes this file
 int main() {
     if (map_registry(REGISTRY_FILE) != 0) {
         fprintf(stderr, "Failed to map registry file: %s\n", strerror(errno));
         return 1;
     }
+    if (registry_was_dirty()) printf("Previous session did not close cleanly; reclaimed %d blocks\n", reclaim_stranded_blocks());
     int id1 = allocate_identity("the man");
     int id2 = allocate_identity("the voice");
     int id3 = allocate_identity("the silence");
     print_identities();
     struct IdentityBlock *ib = get_identity(id1);
     if (ib) printf("Retrieved: %d = %s\n", ib->id, ib->identity_key);
+    printf("Get-or-create \"the voice\": %d (was %d)\n", allocate_identity("the voice"), id2);
+    printf("Lookup \"the silence\": %d\n", lookup_identity("the silence"));
+    release_identity(id3);
+    printf("Released %d; lookup now %d\n", id3, lookup_identity("the silence"));
     leak_check();
-    // Unmap and cleanup handled by OS on exit
+    unmap_registry();
     return 0;
 }
+#endif
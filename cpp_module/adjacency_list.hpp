@@ -0,0 +1,123 @@
+// Lock-Free Adjacency Lists
+// Append-only id lists that any number of threads may grow and read concurrently
+// Author: 1proprogrammerchant
+// C++17+ required
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+// Ids are appended in place: the first INLINE in the object itself, the rest in a
+// chain of blocks that double in size. A writer claims a cell with one fetch_add and
+// publishes the id with a release store; readers skip cells that are claimed but not
+// yet written (0 is never a valid id). erase_if clears cells back to 0, but a cell is
+// never reused, so there is no ABA.
+class AdjacencyList {
+    static constexpr uint32_t INLINE = 2;
+    static constexpr uint32_t FIRST_BLOCK = 8;
+
+    struct Block {
+        const uint32_t capacity;
+        std::atomic<uint32_t> claimed{0};
+        std::atomic<Block*> next{nullptr};
+        std::atomic<size_t>* ids;
+        explicit Block(uint32_t cap) : capacity(cap), ids(new std::atomic<size_t>[cap]()) {}
+        ~Block() { delete[] ids; }
+    };
+
+    std::atomic<uint32_t> inline_claimed{0};
+    std::atomic<uint32_t> count{0};
+    std::atomic<size_t> inline_ids[INLINE] = {};
+    std::atomic<Block*> first{nullptr};
+    std::atomic<Block*> last{nullptr}; // hint: newest block
+
+    // Links a block after *link if it is still empty; returns whatever is there now.
+    static Block* extend(std::atomic<Block*>& link, uint32_t capacity) {
+        Block* b = link.load(std::memory_order_acquire);
+        if (b) return b;
+        Block* fresh = new Block(capacity);
+        if (link.compare_exchange_strong(b, fresh, std::memory_order_acq_rel)) return fresh;
+        delete fresh;
+        return b;
+    }
+
+public:
+    AdjacencyList() = default;
+    AdjacencyList(const AdjacencyList&) = delete;
+    AdjacencyList& operator=(const AdjacencyList&) = delete;
+    ~AdjacencyList() {
+        for (Block* b = first.load(std::memory_order_relaxed); b;) {
+            Block* n = b->next.load(std::memory_order_relaxed);
+            delete b;
+            b = n;
+        }
+    }
+
+    void push_back(size_t id) {
+        if (inline_claimed.load(std::memory_order_relaxed) < INLINE) {
+            uint32_t i = inline_claimed.fetch_add(1, std::memory_order_relaxed);
+            if (i < INLINE) {
+                inline_ids[i].store(id, std::memory_order_release);
+                count.fetch_add(1, std::memory_order_release);
+                return;
+            }
+        }
+        Block* b = last.load(std::memory_order_acquire);
+        if (!b) b = extend(first, FIRST_BLOCK);
+        while (true) {
+            uint32_t i = b->claimed.fetch_add(1, std::memory_order_relaxed);
+            if (i < b->capacity) {
+                b->ids[i].store(id, std::memory_order_release);
+                count.fetch_add(1, std::memory_order_release);
+                return;
+            }
+            b = extend(b->next, b->capacity * 2);
+            Block* hint = last.load(std::memory_order_relaxed);
+            if (!hint || hint->capacity < b->capacity) last.compare_exchange_strong(hint, b, std::memory_order_release);
+        }
+    }
+
+    // Published ids, in the order their cells were claimed.
+    template <typename F>
+    void for_each(F&& fn) const {
+        uint32_t n = std::min(inline_claimed.load(std::memory_order_acquire), INLINE);
+        for (uint32_t i = 0; i < n; ++i)
+            if (size_t id = inline_ids[i].load(std::memory_order_acquire)) fn(id);
+        for (const Block* b = first.load(std::memory_order_acquire); b; b = b->next.load(std::memory_order_acquire)) {
+            uint32_t m = std::min(b->claimed.load(std::memory_order_acquire), b->capacity);
+            for (uint32_t i = 0; i < m; ++i)
+                if (size_t id = b->ids[i].load(std::memory_order_acquire)) fn(id);
+        }
+    }
+
+    // Clears the published ids matching pred (dead references); readers skip the cells
+    // from then on and appends are unaffected. The blocks themselves stay. Returns how many.
+    template <typename P>
+    size_t erase_if(P&& pred) {
+        size_t n = 0;
+        auto clear = [&](std::atomic<size_t>& cell) {
+            size_t id = cell.load(std::memory_order_acquire);
+            if (id && pred(id) && cell.compare_exchange_strong(id, 0, std::memory_order_relaxed)) ++n;
+        };
+        uint32_t m = std::min(inline_claimed.load(std::memory_order_acquire), INLINE);
+        for (uint32_t i = 0; i < m; ++i) clear(inline_ids[i]);
+        for (Block* b = first.load(std::memory_order_acquire); b; b = b->next.load(std::memory_order_acquire)) {
+            uint32_t k = std::min(b->claimed.load(std::memory_order_acquire), b->capacity);
+            for (uint32_t i = 0; i < k; ++i) clear(b->ids[i]);
+        }
+        if (n) count.fetch_sub(static_cast<uint32_t>(n), std::memory_order_release);
+        return n;
+    }
+
+    size_t size() const { return count.load(std::memory_order_acquire); }
+    bool empty() const { return size() == 0; }
+    std::vector<size_t> to_vector() const {
+        std::vector<size_t> out;
+        out.reserve(size());
+        for_each([&](size_t id) { out.push_back(id); });
+        return out;
+    }
+};
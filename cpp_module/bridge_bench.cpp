@@ -0,0 +1,150 @@
+// Python Bridge Benchmarks
+// Embedded batched bridge vs a process-per-call baseline for NLPCore.propose_mutations
+// Author: 1proprogrammerchant
+// C++17+ required
+// Build: g++ -std=c++17 -O2 -pthread bridge_bench.cpp python_bridge.cpp $(python3-config --includes)
+//        $(python3-config --ldflags --embed) -o bridge_bench
+// Usage: ./bridge_bench [--keys N] [--threads T] [--baseline-calls N] [--python-dir DIR]
+// Output: one JSON object per line, as rie_bench.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include "python_bridge.h"
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchConfig {
+    size_t keys = 100000;          // identity keys per bridge run
+    size_t threads = 4;            // concurrent single-key callers
+    size_t baseline_calls = 20;    // processes spawned by the baseline
+    std::string python_dir = "../python_nlp";
+};
+
+static BenchConfig cfg;
+
+static double ns_since(Clock::time_point t0) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+}
+
+static void report(const char* impl, size_t batch, size_t threads, size_t keys, double total_ns, std::vector<double>& ns) {
+    std::sort(ns.begin(), ns.end());
+    auto pct = [&](double p) { return ns[std::min(ns.size() - 1, static_cast<size_t>(p * ns.size()))]; };
+    std::printf("{\"bench\":\"propose_mutations\",\"impl\":\"%s\",\"batch\":%zu,\"threads\":%zu,\"keys\":%zu,"
+                "\"keys_per_sec\":%.0f,\"calls\":%zu,\"p50_ns\":%.0f,\"p99_ns\":%.0f,\"max_ns\":%.0f}\n",
+                impl, batch, threads, keys, keys / (total_ns * 1e-9), ns.size(), pct(0.5), pct(0.99), ns.back());
+}
+
+struct Workload {
+    std::vector<std::string> keys;
+    const char* to[2] = {"the voice", "the silence"};
+    explicit Workload(size_t n) {
+        char buf[40];
+        for (size_t i = 0; i < n; ++i) {
+            std::snprintf(buf, sizeof buf, "%032zx", i * 2654435761u);
+            keys.push_back(buf);
+        }
+    }
+    NlpRequest request(size_t i) const { return {keys[i].c_str(), "the man", to, 2, static_cast<uint32_t>(i % 64)}; }
+};
+
+// One interpreter per call: what a CLI or naive RPC shim costs.
+static void bench_process_per_call(const Workload& w) {
+    std::vector<double> ns;
+    auto t0 = Clock::now();
+    for (size_t i = 0; i < cfg.baseline_calls; ++i) {
+        std::string cmd = "python3 -c \"import sys; sys.path.insert(0, '" + cfg.python_dir +
+                          "'); import nlp_core; c = nlp_core.NLPCore(); "
+                          "print(len(c.propose_mutations(sys.argv[1], 'the man', ['the voice', 'the silence'], 1)))\" " +
+                          w.keys[i % w.keys.size()];
+        auto c0 = Clock::now();
+        FILE* p = popen(cmd.c_str(), "r");
+        if (!p) return;
+        char out[32];
+        bool ok = std::fgets(out, sizeof out, p) && std::atoi(out) == 2;
+        if (pclose(p) != 0 || !ok) {
+            std::fprintf(stderr, "baseline: python3 call failed\n");
+            return;
+        }
+        ns.push_back(ns_since(c0));
+    }
+    report("process_per_call", 1, 1, cfg.baseline_calls, ns_since(t0), ns);
+}
+
+// Sequential batches of the given size; a batch is one interpreter call.
+static void bench_batched(const Workload& w, size_t batch, size_t keys) {
+    std::vector<NlpRequest> reqs;
+    std::vector<double> ns;
+    size_t proposals = 0;
+    auto t0 = Clock::now();
+    for (size_t b = 0; b < keys; b += batch) {
+        reqs.clear();
+        for (size_t i = b; i < std::min(keys, b + batch); ++i) reqs.push_back(w.request(i));
+        auto c0 = Clock::now();
+        NlpBatch* out;
+        if (nlp_propose_batch(reqs.data(), reqs.size(), &out) != 0) {
+            std::fprintf(stderr, "bridge: %s\n", nlp_bridge_error());
+            return;
+        }
+        NlpProposalView v;
+        for (size_t i = 0; nlp_batch_get(out, i, &v) == 0; ++i) proposals += v.to_len != 0;
+        nlp_batch_free(out);
+        ns.push_back(ns_since(c0));
+    }
+    if (proposals != 2 * keys) std::fprintf(stderr, "bridge: %zu proposals, expected %zu\n", proposals, 2 * keys);
+    report("embedded", batch, 1, keys, ns_since(t0), ns);
+}
+
+// Many callers with one key each: the worker coalesces whatever is queued under one GIL hold.
+static void bench_concurrent(const Workload& w, size_t keys) {
+    std::vector<std::vector<double>> per(cfg.threads);
+    std::vector<std::thread> ts;
+    auto t0 = Clock::now();
+    for (size_t t = 0; t < cfg.threads; ++t)
+        ts.emplace_back([&, t] {
+            for (size_t i = t; i < keys; i += cfg.threads) {
+                NlpRequest r = w.request(i);
+                auto c0 = Clock::now();
+                NlpBatch* out;
+                if (nlp_propose_batch(&r, 1, &out) != 0) return;
+                nlp_batch_free(out);
+                per[t].push_back(ns_since(c0));
+            }
+        });
+    for (auto& th : ts) th.join();
+    double total = ns_since(t0);
+    std::vector<double> ns;
+    for (auto& p : per) ns.insert(ns.end(), p.begin(), p.end());
+    if (!ns.empty()) report("embedded_concurrent", 1, cfg.threads, ns.size(), total, ns);
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string k = argv[i];
+        if (k == "--keys") cfg.keys = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (k == "--threads") cfg.threads = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (k == "--baseline-calls") cfg.baseline_calls = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (k == "--python-dir") cfg.python_dir = argv[i + 1];
+        else { std::fprintf(stderr, "unknown flag %s\n", argv[i]); return 2; }
+    }
+    cfg.keys = std::max<size_t>(cfg.keys, 1);
+    cfg.threads = std::max<size_t>(cfg.threads, 1);
+    Workload w(cfg.keys);
+    if (cfg.baseline_calls) bench_process_per_call(w);
+    auto s0 = Clock::now();
+    if (nlp_bridge_start(cfg.python_dir.c_str()) != 0) {
+        std::fprintf(stderr, "bridge: %s\n", nlp_bridge_error());
+        return 1;
+    }
+    std::printf("{\"bench\":\"bridge_start\",\"impl\":\"embedded\",\"ns\":%.0f}\n", ns_since(s0));
+    // Single-key calls are capped so the run stays short; throughput is per key either way.
+    for (size_t batch : {size_t(1), size_t(64), size_t(1024), size_t(4096)})
+        bench_batched(w, batch, batch == 1 ? std::min<size_t>(cfg.keys, 20000) : cfg.keys);
+    bench_concurrent(w, std::min<size_t>(cfg.keys, 20000));
+    nlp_bridge_stop();
+    return 0;
+}
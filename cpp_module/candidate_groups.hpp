@@ -0,0 +1,253 @@
+// Interned Id Groups
+// Immutable, deduplicated id arrays (split candidates, attribute overflow) shared by reference
+// Author: 1proprogrammerchant
+// C++17+ required
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "epoch_reclaim.hpp"
+
+// Global group interner. Groups are refcounted: intern() hands the caller one
+// reference, and the last release() unlinks the group. Its memory and id are
+// recycled once no thread pinned at that time can still read it, so a span stays
+// valid while its holder keeps the reference (or an epoch guard). Reads are
+// lock-free; interning and the last release take a mutex.
+template <typename Id>
+class GroupInterner {
+    struct Group {
+        std::atomic<uint64_t> refs;
+        uint32_t size;
+        Id ids[1]; // over-allocated to size
+    };
+    static constexpr size_t CHUNK_BITS = 12;
+    static constexpr size_t CHUNK_SIZE = size_t(1) << CHUNK_BITS;
+    static constexpr size_t MAX_CHUNKS = size_t(1) << 14;
+    static constexpr size_t CAPACITY = MAX_CHUNKS * CHUNK_SIZE; // ids, 0 included
+
+    struct ContentHash {
+        size_t operator()(const std::vector<Id>& v) const {
+            size_t h = 1469598103934665603ull;
+            for (Id x : v) h = (h ^ static_cast<size_t>(x)) * 1099511628211ull;
+            return h;
+        }
+    };
+
+    std::atomic<std::atomic<const Group*>*> chunks[MAX_CHUNKS] = {};
+    std::unordered_map<std::vector<Id>, uint32_t, ContentHash> index;
+    std::mutex mutex;
+    uint32_t next_id = 1; // 0 = empty group
+    size_t live = 0;
+    std::vector<uint32_t> free_ids;
+    std::vector<std::pair<uint64_t, uint32_t>> limbo; // (epoch, id) of unlinked groups, under mutex
+
+    Group* group(uint32_t gid) const {
+        if (gid == 0 || gid >= CAPACITY) return nullptr;
+        const auto* chunk = chunks[gid >> CHUNK_BITS].load(std::memory_order_acquire);
+        return chunk ? const_cast<Group*>(chunk[gid & (CHUNK_SIZE - 1)].load(std::memory_order_acquire)) : nullptr;
+    }
+    // Frees the unlinked groups no pinned reader can reach; mutex held. Limbo is in
+    // epoch order, so this stops at the first one still visible. Never runs
+    // EpochManager::collect, whose deleters may release groups themselves.
+    size_t recycle() {
+        size_t n = 0;
+        while (n < limbo.size() && EpochManager::global().reclaimable(limbo[n].first)) {
+            uint32_t gid = limbo[n++].second;
+            auto& slot = chunks[gid >> CHUNK_BITS].load(std::memory_order_relaxed)[gid & (CHUNK_SIZE - 1)];
+            ::operator delete(const_cast<Group*>(slot.exchange(nullptr, std::memory_order_relaxed)));
+            free_ids.push_back(gid);
+        }
+        limbo.erase(limbo.begin(), limbo.begin() + n);
+        return n;
+    }
+
+public:
+    GroupInterner() = default;
+    GroupInterner(const GroupInterner&) = delete;
+    GroupInterner& operator=(const GroupInterner&) = delete;
+    ~GroupInterner() {
+        for (uint32_t gid = 1; gid < next_id; ++gid) ::operator delete(group(gid));
+        for (auto& c : chunks) delete[] c.load();
+    }
+
+    // Never destroyed: objects retired to the EpochManager release their groups
+    // during its own static destruction.
+    static GroupInterner& global() {
+        static GroupInterner* instance = new GroupInterner;
+        return *instance;
+    }
+
+    // Sorted, deduplicated group for ids, with one reference for the caller; equal
+    // content gives equal ids (0 for an empty group). false if all MAX_CHUNKS *
+    // CHUNK_SIZE ids hold live or not yet reclaimable groups; gid is then 0.
+    bool try_intern(const Id* ids, size_t n, uint32_t& gid) {
+        gid = 0;
+        std::vector<Id> key(ids, ids + n);
+        std::sort(key.begin(), key.end());
+        key.erase(std::unique(key.begin(), key.end()), key.end());
+        if (key.empty()) return true;
+        std::lock_guard lock(mutex);
+        auto it = index.find(key);
+        if (it != index.end()) {
+            group(it->second)->refs.fetch_add(1, std::memory_order_relaxed);
+            gid = it->second;
+            return true;
+        }
+        if (free_ids.empty() && !limbo.empty()) recycle();
+        uint32_t id;
+        if (!free_ids.empty()) {
+            id = free_ids.back();
+            free_ids.pop_back();
+        } else if (next_id < CAPACITY) {
+            id = next_id++;
+        } else {
+            return false;
+        }
+        gid = id;
+        auto* chunk = chunks[gid >> CHUNK_BITS].load(std::memory_order_relaxed);
+        if (!chunk) {
+            chunk = new std::atomic<const Group*>[CHUNK_SIZE];
+            for (size_t i = 0; i < CHUNK_SIZE; ++i) chunk[i].store(nullptr, std::memory_order_relaxed);
+            chunks[gid >> CHUNK_BITS].store(chunk, std::memory_order_release);
+        }
+        void* mem = ::operator new(sizeof(Group) + (key.size() - 1) * sizeof(Id));
+        Group* g = static_cast<Group*>(mem);
+        new (&g->refs) std::atomic<uint64_t>(1);
+        g->size = static_cast<uint32_t>(key.size());
+        std::memcpy(g->ids, key.data(), key.size() * sizeof(Id));
+        chunk[gid & (CHUNK_SIZE - 1)].store(g, std::memory_order_release);
+        index.emplace(std::move(key), gid);
+        ++live;
+        return true;
+    }
+    // As try_intern; a full table throws std::bad_alloc, like a full slab.
+    uint32_t intern(const Id* ids, size_t n) {
+        uint32_t gid;
+        if (!try_intern(ids, n, gid)) throw std::bad_alloc();
+        return gid;
+    }
+
+    // Another reference to a group the caller already holds one to.
+    void retain(uint32_t gid) {
+        if (Group* g = group(gid)) g->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+    void release(uint32_t gid) {
+        Group* g = group(gid);
+        if (!g || g->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+        std::lock_guard lock(mutex);
+        // Re-read: another release may have unlinked it, and the id been reused, meanwhile.
+        g = group(gid);
+        if (!g || g->refs.load(std::memory_order_acquire) != 0) return; // interned again
+        auto it = index.find(std::vector<Id>(g->ids, g->ids + g->size));
+        if (it == index.end() || it->second != gid) return;
+        index.erase(it);
+        limbo.emplace_back(EpochManager::global().epoch(), gid);
+        --live;
+    }
+    // Recycles unlinked groups whose readers have all left (MemoryPool::reclaim calls
+    // this after collecting). Returns how many.
+    size_t reclaim() {
+        std::lock_guard lock(mutex);
+        return recycle();
+    }
+
+    const Id* data(uint32_t gid) const { const Group* g = group(gid); return g ? g->ids : nullptr; }
+    size_t size(uint32_t gid) const { const Group* g = group(gid); return g ? g->size : 0; }
+
+    // Live (referenced) groups
+    size_t group_count() {
+        std::lock_guard lock(mutex);
+        return live;
+    }
+};
+
+using CandidateGroups = GroupInterner<size_t>;
+
+// A reference's candidate targets: up to INLINE ids stored in place, larger
+// sets point at a shared interned group and hold a reference to it. Copying is a
+// 24-byte copy, plus a refcount increment for a shared set.
+class CandidateSet {
+    static constexpr uint32_t INLINE = 2;
+    static constexpr uint32_t SHARED = ~0u;
+    uint32_t count = 0;  // inline count, or SHARED
+    uint32_t group = 0;
+    size_t inline_ids[INLINE] = {};
+
+    // Takes over the reference intern() returned.
+    static CandidateSet adopt(uint32_t gid) {
+        CandidateSet c;
+        c.group = gid;
+        c.count = gid ? SHARED : 0;
+        return c;
+    }
+
+public:
+    CandidateSet() = default;
+    CandidateSet(const CandidateSet& o) : count(o.count), group(o.group) {
+        std::copy(o.inline_ids, o.inline_ids + INLINE, inline_ids);
+        if (is_shared()) CandidateGroups::global().retain(group);
+    }
+    CandidateSet(CandidateSet&& o) noexcept : count(o.count), group(o.group) {
+        std::copy(o.inline_ids, o.inline_ids + INLINE, inline_ids);
+        o.count = o.group = 0;
+    }
+    CandidateSet& operator=(CandidateSet o) noexcept {
+        std::swap(count, o.count);
+        std::swap(group, o.group);
+        std::swap(inline_ids, o.inline_ids);
+        return *this;
+    }
+    ~CandidateSet() { clear(); }
+
+    // Small sets stay inline (sorted, deduplicated); larger ones are interned.
+    static CandidateSet of(const size_t* ids, size_t n) {
+        CandidateSet c;
+        if (n <= INLINE) {
+            for (size_t i = 0; i < n; ++i) c.insert(ids[i]);
+        } else {
+            c = adopt(CandidateGroups::global().intern(ids, n));
+        }
+        return c;
+    }
+    static CandidateSet of(const std::vector<size_t>& ids) { return of(ids.data(), ids.size()); }
+
+    void clear() {
+        if (is_shared()) CandidateGroups::global().release(group);
+        count = 0;
+        group = 0;
+    }
+    bool empty() const { return count == 0; }
+    bool is_shared() const { return count == SHARED; }
+    uint32_t group_id() const { return is_shared() ? group : 0; }
+    size_t size() const { return is_shared() ? CandidateGroups::global().size(group) : count; }
+    const size_t* begin() const { return is_shared() ? CandidateGroups::global().data(group) : inline_ids; }
+    const size_t* end() const { return begin() + size(); }
+    bool contains(size_t id) const { return std::binary_search(begin(), end(), id); }
+    bool operator==(const CandidateSet& o) const {
+        if (is_shared() && o.is_shared()) return group == o.group;
+        return size() == o.size() && std::equal(begin(), end(), o.begin());
+    }
+    bool operator!=(const CandidateSet& o) const { return !(*this == o); }
+
+    // Adds one id, spilling to an interned group once the inline slots are full.
+    void insert(size_t id) {
+        if (contains(id)) return;
+        if (!is_shared() && count < INLINE) {
+            size_t* pos = std::upper_bound(inline_ids, inline_ids + count, id);
+            std::move_backward(pos, inline_ids + count, inline_ids + count + 1);
+            *pos = id;
+            ++count;
+            return;
+        }
+        std::vector<size_t> ids(begin(), end());
+        ids.push_back(id);
+        *this = adopt(CandidateGroups::global().intern(ids.data(), ids.size()));
+    }
+};
@@ -0,0 +1,425 @@
+// RIE Change Journal
+// Append-only binary log of pool mutations with group commit, and fast replay
+// Author: 1proprogrammerchant
+// C++17+ required (POSIX file I/O; little-endian layout)
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "oesm_highperf.hpp"
+
+// File layout: FileHeader, then frames of {uint32 payload bytes, uint32 FNV-1a of the
+// payload, payload}. A payload is a RecordType byte followed by its fields, packed.
+// A frame that is short or fails its checksum marks the end of the journal (torn tail).
+namespace journal {
+
+constexpr char MAGIC[8] = {'R', 'I', 'E', 'J', 'R', 'N', 'L', '\0'};
+constexpr uint32_t VERSION = 1;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+};
+
+enum RecordType : uint8_t {
+    EntityCreated = 1,     // id u64, state u8, layer u64, name (u16 len + bytes), u16 count, attrs (u16 len + bytes)
+    ReferenceCreated,      // id u64, source u64, target u64, target state u8, layer u64
+    EntityDestroyed,       // id u64, layer u64 (newest layer journaled so far)
+    ReferenceDestroyed,    // id u64, layer u64
+    EntityState,           // id u64, state u8, layer u64
+    ReferenceStatus        // id u64, status u8, layer u64, u32 count, candidates u64[count]
+};
+
+inline uint32_t fnv1a32(const void* data, size_t n) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < n; ++i) h = (h ^ static_cast<const uint8_t*>(data)[i]) * 16777619u;
+    return h;
+}
+
+// Offset just past the last intact frame in a journal image of size bytes.
+inline size_t intact_length(const char* data, size_t size) {
+    size_t pos = sizeof(FileHeader);
+    while (pos + 8 <= size) {
+        uint32_t head[2];
+        std::memcpy(head, data + pos, sizeof head);
+        if (head[0] == 0 || pos + 8 + head[0] > size || fnv1a32(data + pos + 8, head[0]) != head[1]) break;
+        pos += 8 + head[0];
+    }
+    return std::min(pos, size);
+}
+
+// Payload encoder into a reusable buffer
+class Encoder {
+    std::vector<char>& buf;
+public:
+    explicit Encoder(std::vector<char>& b) : buf(b) { buf.clear(); }
+    template <typename T>
+    Encoder& put(T v) {
+        const char* p = reinterpret_cast<const char*>(&v);
+        buf.insert(buf.end(), p, p + sizeof v);
+        return *this;
+    }
+    Encoder& str(std::string_view s) {
+        uint16_t n = static_cast<uint16_t>(std::min<size_t>(s.size(), UINT16_MAX));
+        put(n);
+        buf.insert(buf.end(), s.data(), s.data() + n);
+        return *this;
+    }
+};
+
+// Bounds-checked payload decoder
+class Decoder {
+    const char* p;
+    const char* end;
+public:
+    Decoder(const char* b, size_t n) : p(b), end(b + n) {}
+    bool ok = true;
+    template <typename T>
+    T get() {
+        T v{};
+        if (end - p < static_cast<ptrdiff_t>(sizeof v)) { ok = false; return v; }
+        std::memcpy(&v, p, sizeof v);
+        p += sizeof v;
+        return v;
+    }
+    std::string_view str() {
+        uint16_t n = get<uint16_t>();
+        if (end - p < n) { ok = false; return {}; }
+        std::string_view s(p, n);
+        p += n;
+        return s;
+    }
+};
+
+struct Options {
+    size_t group_bytes = size_t(1) << 20;             // flush once this much is buffered...
+    std::chrono::microseconds max_delay{2000};         // ...or this long after the first append
+    bool sync = true;                                  // fdatasync each group
+};
+
+struct Stats {
+    uint64_t records = 0, bytes = 0, groups = 0;
+};
+
+// MutationSink that journals everything the pool and engine do. Appends copy a small
+// frame into the open group under a mutex; a flusher thread writes and syncs whole
+// groups, so one fdatasync covers every mutation in the group. append() returns a
+// sequence number; wait_durable(seq) blocks until that record is on disk.
+class ChangeJournal : public MutationSink {
+    int fd = -1;
+    Options opts;
+    std::mutex mutex;
+    std::condition_variable work_cv, durable_cv;
+    std::vector<char> active, writing;
+    uint64_t appended = 0, durable = 0;
+    size_t high_layer = 0;
+    bool stopping = false, failed = false;
+    Stats stats;
+    std::thread flusher;
+
+    void flush_loop() {
+        std::unique_lock lock(mutex);
+        while (true) {
+            work_cv.wait_for(lock, opts.max_delay, [&] { return stopping || active.size() >= opts.group_bytes; });
+            if (active.empty()) {
+                if (stopping) return;
+                continue;
+            }
+            writing.swap(active);
+            uint64_t seq = appended;
+            lock.unlock();
+            bool ok = write_all(writing.data(), writing.size()) && (!opts.sync || ::fdatasync(fd) == 0);
+            lock.lock();
+            stats.bytes += writing.size();
+            ++stats.groups;
+            writing.clear();
+            if (!ok) failed = true;
+            durable = seq;
+            durable_cv.notify_all();
+        }
+    }
+    bool write_all(const char* p, size_t n) {
+        while (n) {
+            ssize_t w = ::write(fd, p, n);
+            if (w < 0) return false;
+            p += w;
+            n -= static_cast<size_t>(w);
+        }
+        return true;
+    }
+
+    uint64_t append(const std::vector<char>& payload) {
+        uint32_t head[2] = {static_cast<uint32_t>(payload.size()), fnv1a32(payload.data(), payload.size())};
+        std::lock_guard lock(mutex);
+        const char* h = reinterpret_cast<const char*>(head);
+        active.insert(active.end(), h, h + sizeof head);
+        active.insert(active.end(), payload.begin(), payload.end());
+        ++stats.records;
+        if (active.size() >= opts.group_bytes) work_cv.notify_one();
+        return ++appended;
+    }
+    static std::vector<char>& scratch() {
+        thread_local std::vector<char> buf;
+        return buf;
+    }
+    size_t note_layer(size_t layer) {
+        std::lock_guard lock(mutex);
+        high_layer = std::max(high_layer, layer);
+        return high_layer;
+    }
+
+public:
+    ChangeJournal() = default;
+    ChangeJournal(const ChangeJournal&) = delete;
+    ChangeJournal& operator=(const ChangeJournal&) = delete;
+    ~ChangeJournal() { close(); }
+
+    // Opens (creating if needed) and appends to path. Existing records are kept; a torn
+    // tail left by a crash is cut off first so new records follow the last intact one.
+    bool open(const std::string& path, Options o = {}, std::string* error = nullptr) {
+        opts = o;
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+        auto fail = [&](const std::string& msg) {
+            if (error) *error = msg;
+            if (fd >= 0) ::close(fd);
+            fd = -1;
+            return false;
+        };
+        if (fd < 0) return fail("cannot open " + path);
+        struct stat st;
+        if (::fstat(fd, &st) != 0) return fail("cannot stat " + path);
+        size_t size = static_cast<size_t>(st.st_size);
+        if (size > sizeof(FileHeader)) {
+            void* base = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            size_t keep = base == MAP_FAILED ? size : intact_length(static_cast<const char*>(base), size);
+            if (base != MAP_FAILED) ::munmap(base, size);
+            if (keep < size && ::ftruncate(fd, static_cast<off_t>(keep)) != 0) return fail("cannot truncate torn tail");
+        }
+        if (size == 0) {
+            FileHeader h{};
+            std::memcpy(h.magic, MAGIC, sizeof h.magic);
+            h.version = VERSION;
+            if (!write_all(reinterpret_cast<const char*>(&h), sizeof h)) return fail("cannot write header");
+        }
+        stopping = false;
+        flusher = std::thread(&ChangeJournal::flush_loop, this);
+        return true;
+    }
+
+    // Flushes what is buffered and stops the flusher.
+    void close() {
+        if (fd < 0) return;
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        work_cv.notify_one();
+        flusher.join();
+        ::close(fd);
+        fd = -1;
+    }
+
+    // Blocks until record seq (and all before it) is durable. False on a write error.
+    bool wait_durable(uint64_t seq) {
+        std::unique_lock lock(mutex);
+        work_cv.notify_one();
+        durable_cv.wait(lock, [&] { return durable >= seq || failed; });
+        return !failed;
+    }
+    bool flush() {
+        uint64_t seq;
+        {
+            std::lock_guard lock(mutex);
+            seq = appended;
+        }
+        return wait_durable(seq);
+    }
+    uint64_t last_sequence() {
+        std::lock_guard lock(mutex);
+        return appended;
+    }
+    Stats statistics() {
+        std::lock_guard lock(mutex);
+        return stats;
+    }
+
+    // MutationSink
+    void entity_created(const Entity& e) override {
+        note_layer(e.temporal_layer);
+        Encoder enc(scratch());
+        enc.put(EntityCreated).put<uint64_t>(e.id).put(static_cast<uint8_t>(e.state)).put<uint64_t>(e.temporal_layer);
+        enc.str(e.name_str());
+        std::vector<std::string_view> attrs;
+        e.attributes.for_each(AttributeDictionary::global(), [&](std::string_view a) { attrs.push_back(a); });
+        enc.put(static_cast<uint16_t>(attrs.size()));
+        for (auto a : attrs) enc.str(a);
+        append(scratch());
+    }
+    void reference_created(const ReferenceObject& r) override {
+        note_layer(r.creationLayer);
+        Encoder(scratch()).put(ReferenceCreated).put<uint64_t>(r.id).put<uint64_t>(r.sourceEntityId)
+            .put<uint64_t>(r.targetEntityId).put(static_cast<uint8_t>(r.targetStateAtCreation)).put<uint64_t>(r.creationLayer);
+        append(scratch());
+    }
+    void entity_destroyed(size_t eid) override {
+        Encoder(scratch()).put(EntityDestroyed).put<uint64_t>(eid).put<uint64_t>(note_layer(0));
+        append(scratch());
+    }
+    void reference_destroyed(size_t rid) override {
+        Encoder(scratch()).put(ReferenceDestroyed).put<uint64_t>(rid).put<uint64_t>(note_layer(0));
+        append(scratch());
+    }
+    void entity_state_changed(const Entity& e) override {
+        note_layer(e.temporal_layer);
+        Encoder(scratch()).put(EntityState).put<uint64_t>(e.id).put(static_cast<uint8_t>(e.state)).put<uint64_t>(e.temporal_layer);
+        append(scratch());
+    }
+    void reference_status_changed(const ReferenceObject& r) override {
+        note_layer(r.lastValidatedLayer);
+        Encoder enc(scratch());
+        enc.put(ReferenceStatus).put<uint64_t>(r.id).put(static_cast<uint8_t>(r.integrityStatus)).put<uint64_t>(r.lastValidatedLayer);
+        enc.put(static_cast<uint32_t>(r.candidateTargets.size()));
+        for (size_t c : r.candidateTargets) enc.put<uint64_t>(c);
+        append(scratch());
+    }
+};
+
+struct ReplayStats {
+    uint64_t records = 0, applied = 0;
+    uint64_t skipped = 0;  // newer than the replay layer
+    uint64_t rejected = 0; // id already live, or the object it changes is missing
+    uint64_t bytes = 0, torn_bytes = 0;             // torn_bytes: unreadable tail, ignored
+};
+
+// Rebuilds pool from the journal at path, applying only records at or before
+// until_layer. Objects keep their journaled ids. The file is mapped and decoded in
+// one sequential pass.
+inline bool replay(const std::string& path, MemoryPool& pool, size_t until_layer = ANY_LAYER,
+                   ReplayStats* out = nullptr, std::string* error = nullptr) {
+    auto fail = [&](const std::string& msg) {
+        if (error) *error = msg;
+        return false;
+    };
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return fail("cannot open " + path);
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(FileHeader))) {
+        ::close(fd);
+        return fail("not a journal: " + path);
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void* base = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) return fail("mmap failed");
+    ::madvise(base, size, MADV_SEQUENTIAL);
+    const char* data = static_cast<const char*>(base);
+    FileHeader h;
+    std::memcpy(&h, data, sizeof h);
+    if (std::memcmp(h.magic, MAGIC, sizeof MAGIC) != 0 || h.version != VERSION) {
+        ::munmap(base, size);
+        return fail("bad journal header");
+    }
+
+    ReplayStats stats;
+    std::vector<std::string_view> attrs;
+    std::vector<size_t> candidates;
+    size_t top_layer = 0;
+    size_t pos = sizeof h;
+    while (pos + 8 <= size) {
+        uint32_t head[2];
+        std::memcpy(head, data + pos, sizeof head);
+        if (head[0] == 0 || pos + 8 + head[0] > size || fnv1a32(data + pos + 8, head[0]) != head[1]) break;
+        Decoder d(data + pos + 8, head[0]);
+        pos += 8 + head[0];
+        ++stats.records;
+        uint8_t type = d.get<uint8_t>();
+        uint64_t id = d.get<uint64_t>();
+        bool applied = false, skip = false;
+        switch (type) {
+        case EntityCreated: {
+            auto state = static_cast<OntState>(d.get<uint8_t>());
+            uint64_t layer = d.get<uint64_t>();
+            std::string_view name = d.str();
+            attrs.resize(d.get<uint16_t>());
+            for (auto& a : attrs) a = d.str();
+            if (!d.ok || (skip = layer > until_layer)) break;
+            Symbol sym = SymbolTable::global().intern(name);
+            applied = pool.restore_entity(id, sym, AttributeDictionary::global().encode(attrs), state, layer) != nullptr;
+            top_layer = std::max<size_t>(top_layer, layer);
+            break;
+        }
+        case ReferenceCreated: {
+            uint64_t src = d.get<uint64_t>(), tgt = d.get<uint64_t>();
+            auto state = static_cast<OntState>(d.get<uint8_t>());
+            uint64_t layer = d.get<uint64_t>();
+            if (!d.ok || (skip = layer > until_layer)) break;
+            applied = pool.restore_reference(id, src, tgt, state, layer) != nullptr;
+            top_layer = std::max<size_t>(top_layer, layer);
+            break;
+        }
+        case EntityDestroyed:
+        case ReferenceDestroyed: {
+            uint64_t layer = d.get<uint64_t>();
+            if (!d.ok || (skip = layer > until_layer)) break;
+            applied = type == EntityDestroyed ? pool.destroy_entity(id) : pool.destroy_reference(id);
+            break;
+        }
+        case EntityState: {
+            auto state = static_cast<OntState>(d.get<uint8_t>());
+            uint64_t layer = d.get<uint64_t>();
+            if (!d.ok || (skip = layer > until_layer)) break;
+            if (Entity* e = pool.get_entity(id)) {
+                e->state = state;
+                e->temporal_layer = layer;
+                e->record_version();
+                applied = true;
+                top_layer = std::max<size_t>(top_layer, layer);
+            }
+            break;
+        }
+        case ReferenceStatus: {
+            auto status = static_cast<RefIntegrityStatus>(d.get<uint8_t>());
+            uint64_t layer = d.get<uint64_t>();
+            candidates.resize(d.get<uint32_t>());
+            for (auto& c : candidates) c = d.get<uint64_t>();
+            if (!d.ok || (skip = layer > until_layer)) break;
+            if (ReferenceObject* r = pool.get_reference(id)) {
+                r->integrityStatus = status;
+                r->candidateTargets = CandidateSet::of(candidates);
+                r->lastValidatedLayer = layer;
+                pool.sync_status(*r);
+                r->record_version();
+                applied = true;
+                top_layer = std::max<size_t>(top_layer, layer);
+            }
+            break;
+        }
+        default:
+            d.ok = false;
+        }
+        if (!d.ok) {
+            ::munmap(base, size);
+            return fail("malformed record at offset " + std::to_string(pos - head[0] - 8));
+        }
+        ++(skip ? stats.skipped : applied ? stats.applied : stats.rejected);
+    }
+    stats.bytes = pos;
+    stats.torn_bytes = size - pos;
+    ::munmap(base, size);
+    pool.commit_layer(top_layer);
+    if (out) *out = stats;
+    return true;
+}
+
+} // namespace journal
@@ -0,0 +1,149 @@
+// Epoch-Based Reclamation
+// Deferred frees for lock-free readers: memory retired in epoch E is freed once every
+// thread that could have seen it has left its critical section
+// Author: 1proprogrammerchant
+// C++17+ required
+#pragma once
+#include <atomic>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+class EpochManager {
+public:
+    static constexpr size_t MAX_THREADS = 256;
+
+private:
+    static constexpr uint64_t QUIESCENT = 0;
+
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> epoch{QUIESCENT}; // epoch observed at pin time
+        std::atomic<bool> claimed{false};
+    };
+    struct Retired {
+        uint64_t epoch;
+        void* ptr;
+        void (*deleter)(void*);
+    };
+    // Per-thread registration; the slot is released when the thread exits.
+    struct ThreadRecord {
+        EpochManager* owner = nullptr;
+        Slot* slot = nullptr;
+        size_t depth = 0;
+        ~ThreadRecord() {
+            if (slot) slot->claimed.store(false, std::memory_order_release);
+        }
+    };
+
+    std::atomic<uint64_t> global_epoch{1};
+    Slot slots[MAX_THREADS];
+    std::mutex retired_mutex;
+    std::vector<Retired> retired;
+    size_t collect_at = 64; // retire() collects once the list doubles, so bulk retires stay O(1) each
+
+    ThreadRecord& record() {
+        thread_local ThreadRecord rec;
+        if (rec.owner != this) {
+            for (auto& s : slots) {
+                bool expected = false;
+                if (s.claimed.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+                    rec.owner = this;
+                    rec.slot = &s;
+                    return rec;
+                }
+            }
+            throw std::runtime_error("EpochManager: more than MAX_THREADS concurrent threads");
+        }
+        return rec;
+    }
+
+    // The epoch can advance once every pinned thread has observed the current one.
+    bool try_advance() {
+        uint64_t e = global_epoch.load(std::memory_order_acquire);
+        for (auto& s : slots) {
+            uint64_t se = s.epoch.load(std::memory_order_seq_cst);
+            if (se != QUIESCENT && se != e) return false;
+        }
+        return global_epoch.compare_exchange_strong(e, e + 1, std::memory_order_acq_rel);
+    }
+
+public:
+    // One manager per process; thread registration is tied to this instance.
+    static EpochManager& global() {
+        static EpochManager instance;
+        return instance;
+    }
+
+    ~EpochManager() {
+        for (auto& r : retired) r.deleter(r.ptr);
+    }
+
+    // RAII critical section. Pointers loaded inside it stay valid until it ends. Nests.
+    class Guard {
+        EpochManager* mgr;
+    public:
+        explicit Guard(EpochManager& m) : mgr(&m) { mgr->enter(); }
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+        ~Guard() { mgr->exit(); }
+    };
+    Guard pin() { return Guard(*this); }
+
+    void enter() {
+        ThreadRecord& rec = record();
+        // seq_cst RMW: the pin is visible before any protected load that follows
+        if (rec.depth++ == 0) rec.slot->epoch.exchange(global_epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+    }
+    void exit() {
+        ThreadRecord& rec = record();
+        if (--rec.depth == 0) rec.slot->epoch.store(QUIESCENT, std::memory_order_release);
+    }
+
+    // Frees p with deleter once no pinned thread can still reach it.
+    void retire(void* p, void (*deleter)(void*)) {
+        bool due;
+        {
+            std::lock_guard lock(retired_mutex);
+            retired.push_back({global_epoch.load(std::memory_order_acquire), p, deleter});
+            due = retired.size() >= collect_at;
+        }
+        if (due) collect();
+    }
+    template <typename T>
+    void retire(T* p) {
+        retire(p, [](void* q) { delete static_cast<T*>(q); });
+    }
+
+    // Advances the epoch if possible and frees everything retired two epochs back.
+    // Returns the number of objects freed.
+    size_t collect() {
+        try_advance();
+        uint64_t safe = global_epoch.load(std::memory_order_acquire);
+        std::vector<Retired> ready;
+        {
+            std::lock_guard lock(retired_mutex);
+            auto keep = retired.begin();
+            for (auto& r : retired) {
+                if (r.epoch + 2 <= safe) ready.push_back(r);
+                else *keep++ = r;
+            }
+            retired.erase(keep, retired.end());
+            collect_at = std::max<size_t>(64, 2 * retired.size());
+        }
+        for (auto& r : ready) r.deleter(r.ptr);
+        return ready.size();
+    }
+
+    // True once nothing retired at epoch e (read after unlinking it) can still be reached
+    // by a pinned thread. For containers that keep their own retired lists.
+    bool reclaimable(uint64_t e) const { return e + 2 <= epoch(); }
+
+    size_t pending() {
+        std::lock_guard lock(retired_mutex);
+        return retired.size();
+    }
+    uint64_t epoch() const { return global_epoch.load(std::memory_order_acquire); }
+};
@@ -0,0 +1,284 @@
+// Graph Wire Format
+// One flat binary encoding of entities, references and proposals, read in place from C and C++
+// Author: 1proprogrammerchant
+// C11 / C++17 (little-endian layout)
+//
+// A batch is one contiguous buffer: RieWireHeader, then six 8-byte aligned sections of
+// fixed-size records. Every position is an offset from the start of the batch and every
+// string is an {offset, length} slice of the Strings section, so a batch can be written
+// to a file or shared memory and read where it lies, with no parsing and no pointers.
+// States and statuses are the numeric enums below, in the order of the C++ OntState and
+// RefIntegrityStatus (and the C / Go enums), never their names.
+//
+// Writing: size the batch with rie_wire_bytes(), rie_wire_begin() lays out the header,
+// fill the record arrays through the writer, then rie_wire_end() stamps size and checksum.
+// Reading: rie_wire_open() checks the header and section bounds (and, on request, the
+// checksum and every record) and returns typed pointers into the buffer.
+#ifndef GRAPH_WIRE_H
+#define GRAPH_WIRE_H
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#define RIE_WIRE_ASSERT(c, m) static_assert(c, m)
+#else
+#define RIE_WIRE_ASSERT(c, m) _Static_assert(c, m)
+#endif
+
+#define RIE_WIRE_MAGIC "RIEWIRE"
+#define RIE_WIRE_VERSION 1u
+#define RIE_WIRE_BYTE_ORDER 0x01020304u
+
+typedef enum RieWireState {
+    RIE_UNDEFINED, RIE_DEFINED, RIE_REFERENCED, RIE_REINTERPRETED, RIE_CONTRADICTED,
+    RIE_SPLIT, RIE_MERGED, RIE_ABSTRACTED, RIE_OBSERVER_RELATIVE, RIE_COLLAPSED,
+    RIE_STATE_COUNT
+} RieWireState;
+
+typedef enum RieWireStatus {
+    RIE_VALID, RIE_IDENTITY_CHANGED, RIE_IDENTITY_SPLIT, RIE_IDENTITY_MERGED,
+    RIE_INVALIDATED, RIE_UNRESOLVED, RIE_OBSERVER_RELATIVE_STATUS,
+    RIE_STATUS_COUNT
+} RieWireStatus;
+
+typedef enum RieWireSection {
+    RIE_WIRE_ENTITIES,   // RieWireEntity
+    RIE_WIRE_REFERENCES, // RieWireReference
+    RIE_WIRE_CANDIDATES, // uint64 entity ids, referenced by split references
+    RIE_WIRE_ATTRIBUTES, // RieWireString, referenced by entities
+    RIE_WIRE_PROPOSALS,  // RieWireProposal
+    RIE_WIRE_STRINGS,    // bytes, not NUL-terminated
+    RIE_WIRE_SECTIONS
+} RieWireSection;
+
+typedef struct RieWireString {
+    uint32_t offset; // into the Strings section
+    uint32_t length;
+} RieWireString;
+
+typedef struct RieWireEntity {
+    uint64_t id;
+    uint64_t layer;
+    RieWireString name;
+    uint32_t attr_first, attr_count; // slice of the Attributes section
+    uint8_t state;                   // RieWireState
+    uint8_t reserved[7];
+} RieWireEntity;
+
+typedef struct RieWireReference {
+    uint64_t id, source, target;
+    uint64_t creation_layer, validated_layer;
+    uint32_t candidate_first, candidate_count; // slice of the Candidates section
+    uint8_t created_state;                     // target's RieWireState at creation
+    uint8_t status;                            // RieWireStatus
+    uint8_t reserved[6];
+} RieWireReference;
+
+// An NLP mutation proposal (python_nlp / Triton output).
+typedef struct RieWireProposal {
+    RieWireString identity_key, from, to, type;
+    uint64_t layer;
+} RieWireProposal;
+
+typedef struct RieWireSectionDesc {
+    uint64_t offset; // from the start of the batch, 8-byte aligned
+    uint64_t count;  // records (bytes for Strings)
+} RieWireSectionDesc;
+
+typedef struct RieWireHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_bytes;
+    uint64_t total_bytes;
+    uint32_t byte_order; // RIE_WIRE_BYTE_ORDER as the writer saw it
+    uint32_t checksum;   // FNV-1a over bytes [header_bytes, total_bytes)
+    RieWireSectionDesc sections[RIE_WIRE_SECTIONS];
+} RieWireHeader;
+
+RIE_WIRE_ASSERT(sizeof(RieWireEntity) == 40, "RieWireEntity layout");
+RIE_WIRE_ASSERT(sizeof(RieWireReference) == 56, "RieWireReference layout");
+RIE_WIRE_ASSERT(sizeof(RieWireProposal) == 40, "RieWireProposal layout");
+RIE_WIRE_ASSERT(sizeof(RieWireHeader) == 128, "RieWireHeader layout");
+
+static const size_t rie_wire_record_size[RIE_WIRE_SECTIONS] = {
+    sizeof(RieWireEntity), sizeof(RieWireReference), sizeof(uint64_t), sizeof(RieWireString), sizeof(RieWireProposal), 1
+};
+
+static inline const char* rie_wire_state_name(uint8_t s) {
+    static const char* names[RIE_STATE_COUNT] = {"Undefined", "Defined", "Referenced", "Reinterpreted", "Contradicted",
+                                                 "Split", "Merged", "Abstracted", "ObserverRelative", "Collapsed"};
+    return s < RIE_STATE_COUNT ? names[s] : "?";
+}
+static inline const char* rie_wire_status_name(uint8_t s) {
+    static const char* names[RIE_STATUS_COUNT] = {"Valid", "IdentityChanged", "IdentitySplit", "IdentityMerged",
+                                                  "Invalidated", "Unresolved", "ObserverRelative"};
+    return s < RIE_STATUS_COUNT ? names[s] : "?";
+}
+
+static inline uint32_t rie_wire_fnv1a(const void* data, uint64_t n) {
+    uint32_t h = 2166136261u;
+    for (uint64_t i = 0; i < n; ++i) h = (h ^ ((const uint8_t*)data)[i]) * 16777619u;
+    return h;
+}
+
+// Record counts of a batch; strings is the total bytes of all strings.
+typedef struct RieWireCounts {
+    uint64_t count[RIE_WIRE_SECTIONS];
+} RieWireCounts;
+
+static inline uint64_t rie_wire_align8(uint64_t n) { return (n + 7) & ~(uint64_t)7; }
+
+// Bytes a batch with these counts occupies.
+static inline uint64_t rie_wire_bytes(const RieWireCounts* c) {
+    uint64_t n = sizeof(RieWireHeader);
+    for (int s = 0; s < RIE_WIRE_SECTIONS; ++s) n += rie_wire_align8(c->count[s] * rie_wire_record_size[s]);
+    return n;
+}
+
+typedef struct RieWireWriter {
+    unsigned char* base;
+    RieWireEntity* entities;
+    RieWireReference* references;
+    uint64_t* candidates;
+    RieWireString* attributes;
+    RieWireProposal* proposals;
+    char* strings;
+    uint64_t string_capacity, string_used;
+    int overflow; // a string did not fit
+} RieWireWriter;
+
+// Lays out a batch in buf (capacity bytes, 8-byte aligned). Records are zeroed; fill
+// them through the writer's arrays. Returns 0, or -1 if buf is too small or misaligned.
+static inline int rie_wire_begin(RieWireWriter* w, void* buf, uint64_t capacity, const RieWireCounts* c) {
+    uint64_t total = rie_wire_bytes(c), pos = sizeof(RieWireHeader);
+    if (!buf || ((uintptr_t)buf & 7) || capacity < total) return -1;
+    RieWireHeader* h = (RieWireHeader*)buf;
+    memset(buf, 0, (size_t)total);
+    memcpy(h->magic, RIE_WIRE_MAGIC, 8);
+    h->version = RIE_WIRE_VERSION;
+    h->header_bytes = sizeof(RieWireHeader);
+    h->byte_order = RIE_WIRE_BYTE_ORDER;
+    for (int s = 0; s < RIE_WIRE_SECTIONS; ++s) {
+        h->sections[s].offset = pos;
+        h->sections[s].count = c->count[s];
+        pos += rie_wire_align8(c->count[s] * rie_wire_record_size[s]);
+    }
+    w->base = (unsigned char*)buf;
+    w->entities = (RieWireEntity*)(w->base + h->sections[RIE_WIRE_ENTITIES].offset);
+    w->references = (RieWireReference*)(w->base + h->sections[RIE_WIRE_REFERENCES].offset);
+    w->candidates = (uint64_t*)(w->base + h->sections[RIE_WIRE_CANDIDATES].offset);
+    w->attributes = (RieWireString*)(w->base + h->sections[RIE_WIRE_ATTRIBUTES].offset);
+    w->proposals = (RieWireProposal*)(w->base + h->sections[RIE_WIRE_PROPOSALS].offset);
+    w->strings = (char*)(w->base + h->sections[RIE_WIRE_STRINGS].offset);
+    w->string_capacity = c->count[RIE_WIRE_STRINGS];
+    w->string_used = 0;
+    w->overflow = 0;
+    return 0;
+}
+
+// Copies a string into the Strings section and returns its slice.
+static inline RieWireString rie_wire_string(RieWireWriter* w, const char* s, uint64_t len) {
+    RieWireString r = {0, 0};
+    if (len > w->string_capacity - w->string_used || w->string_used + len > UINT32_MAX) {
+        w->overflow = 1;
+        return r;
+    }
+    memcpy(w->strings + w->string_used, s, (size_t)len);
+    r.offset = (uint32_t)w->string_used;
+    r.length = (uint32_t)len;
+    w->string_used += len;
+    return r;
+}
+
+// Seals the batch; returns its size in bytes, or 0 if a string overflowed.
+static inline uint64_t rie_wire_end(RieWireWriter* w) {
+    RieWireHeader* h = (RieWireHeader*)w->base;
+    if (w->overflow) return 0;
+    h->sections[RIE_WIRE_STRINGS].count = w->string_used; // unused reserve is dropped
+    h->total_bytes = h->sections[RIE_WIRE_STRINGS].offset + rie_wire_align8(w->string_used);
+    h->checksum = rie_wire_fnv1a(w->base + h->header_bytes, h->total_bytes - h->header_bytes);
+    return h->total_bytes;
+}
+
+typedef struct RieWireView {
+    const RieWireHeader* header;
+    const RieWireEntity* entities;
+    const RieWireReference* references;
+    const uint64_t* candidates;
+    const RieWireString* attributes;
+    const RieWireProposal* proposals;
+    const char* strings;
+    uint64_t entity_count, reference_count, candidate_count, attribute_count, proposal_count, string_bytes;
+} RieWireView;
+
+enum { RIE_WIRE_VERIFY_CHECKSUM = 1, RIE_WIRE_VERIFY_RECORDS = 2 };
+
+// Checks every slice and enum of the batch against its sections.
+static inline int rie_wire_check_records(const RieWireView* v) {
+#define RIE_WIRE_SLICE_OK(first, n, count) ((uint64_t)(first) + (n) <= (count))
+#define RIE_WIRE_STR_OK(s) RIE_WIRE_SLICE_OK((s).offset, (s).length, v->string_bytes)
+    for (uint64_t i = 0; i < v->entity_count; ++i) {
+        const RieWireEntity* e = &v->entities[i];
+        if (e->state >= RIE_STATE_COUNT || !RIE_WIRE_STR_OK(e->name) ||
+            !RIE_WIRE_SLICE_OK(e->attr_first, e->attr_count, v->attribute_count)) return -1;
+    }
+    for (uint64_t i = 0; i < v->reference_count; ++i) {
+        const RieWireReference* r = &v->references[i];
+        if (r->created_state >= RIE_STATE_COUNT || r->status >= RIE_STATUS_COUNT ||
+            !RIE_WIRE_SLICE_OK(r->candidate_first, r->candidate_count, v->candidate_count)) return -1;
+    }
+    for (uint64_t i = 0; i < v->attribute_count; ++i)
+        if (!RIE_WIRE_STR_OK(v->attributes[i])) return -1;
+    for (uint64_t i = 0; i < v->proposal_count; ++i) {
+        const RieWireProposal* p = &v->proposals[i];
+        if (!RIE_WIRE_STR_OK(p->identity_key) || !RIE_WIRE_STR_OK(p->from) || !RIE_WIRE_STR_OK(p->to) || !RIE_WIRE_STR_OK(p->type))
+            return -1;
+    }
+#undef RIE_WIRE_STR_OK
+#undef RIE_WIRE_SLICE_OK
+    return 0;
+}
+
+// Reads the batch at data (size bytes, 8-byte aligned) in place. verify: RIE_WIRE_VERIFY_*
+// flags; without them only the header and section bounds are checked. Returns 0, or -1.
+static inline int rie_wire_open(RieWireView* v, const void* data, uint64_t size, int verify) {
+    const RieWireHeader* h = (const RieWireHeader*)data;
+    if (!data || ((uintptr_t)data & 7) || size < sizeof(RieWireHeader)) return -1;
+    if (memcmp(h->magic, RIE_WIRE_MAGIC, 8) != 0 || h->version != RIE_WIRE_VERSION || h->byte_order != RIE_WIRE_BYTE_ORDER ||
+        h->header_bytes < sizeof(RieWireHeader) || h->total_bytes > size || h->total_bytes < h->header_bytes) return -1;
+    for (int s = 0; s < RIE_WIRE_SECTIONS; ++s) {
+        const RieWireSectionDesc* d = &h->sections[s];
+        if ((d->offset & 7) || d->offset < h->header_bytes || d->offset > h->total_bytes ||
+            d->count > (h->total_bytes - d->offset) / rie_wire_record_size[s]) return -1;
+    }
+    if ((verify & RIE_WIRE_VERIFY_CHECKSUM) &&
+        rie_wire_fnv1a((const unsigned char*)data + h->header_bytes, h->total_bytes - h->header_bytes) != h->checksum) return -1;
+    const unsigned char* b = (const unsigned char*)data;
+    v->header = h;
+    v->entities = (const RieWireEntity*)(b + h->sections[RIE_WIRE_ENTITIES].offset);
+    v->references = (const RieWireReference*)(b + h->sections[RIE_WIRE_REFERENCES].offset);
+    v->candidates = (const uint64_t*)(b + h->sections[RIE_WIRE_CANDIDATES].offset);
+    v->attributes = (const RieWireString*)(b + h->sections[RIE_WIRE_ATTRIBUTES].offset);
+    v->proposals = (const RieWireProposal*)(b + h->sections[RIE_WIRE_PROPOSALS].offset);
+    v->strings = (const char*)(b + h->sections[RIE_WIRE_STRINGS].offset);
+    v->entity_count = h->sections[RIE_WIRE_ENTITIES].count;
+    v->reference_count = h->sections[RIE_WIRE_REFERENCES].count;
+    v->candidate_count = h->sections[RIE_WIRE_CANDIDATES].count;
+    v->attribute_count = h->sections[RIE_WIRE_ATTRIBUTES].count;
+    v->proposal_count = h->sections[RIE_WIRE_PROPOSALS].count;
+    v->string_bytes = h->sections[RIE_WIRE_STRINGS].count;
+    if ((verify & RIE_WIRE_VERIFY_RECORDS) && rie_wire_check_records(v) != 0) return -1;
+    return 0;
+}
+
+// The bytes of a string slice (not NUL-terminated); NULL if it lies outside the batch.
+static inline const char* rie_wire_str(const RieWireView* v, RieWireString s) {
+    return (uint64_t)s.offset + s.length <= v->string_bytes ? v->strings + s.offset : NULL;
+}
+
+#ifdef __cplusplus
+}
+#endif
+#endif
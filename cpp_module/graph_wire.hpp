@@ -0,0 +1,186 @@
+// Graph Wire Batches
+// MemoryPool <-> graph_wire.h batches, and typed in-place views over them
+// Author: 1proprogrammerchant
+// C++17+ required
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include "graph_wire.h"
+#include "oesm_highperf.hpp"
+
+static_assert(ONT_STATE_COUNT == RIE_STATE_COUNT && static_cast<int>(OntState::Split) == RIE_SPLIT &&
+              static_cast<int>(OntState::Collapsed) == RIE_COLLAPSED, "wire states follow OntState");
+static_assert(static_cast<int>(RefIntegrityStatus::Invalidated) == RIE_INVALIDATED &&
+              static_cast<int>(RefIntegrityStatus::ObserverRelative) + 1 == RIE_STATUS_COUNT, "wire statuses follow RefIntegrityStatus");
+
+namespace wire {
+
+// A proposal to encode; the same fields as ingest::ProposalView.
+struct Proposal {
+    std::string_view identity_key, from, to, type;
+    uint64_t layer = 0;
+};
+
+// An 8-byte aligned batch buffer.
+class Batch {
+    std::vector<uint64_t> words;
+    size_t length = 0;
+
+public:
+    void* reserve(size_t bytes) {
+        words.assign((bytes + 7) / 8, 0);
+        return words.data();
+    }
+    void resize(size_t bytes) { length = bytes; }
+    const void* data() const { return words.data(); }
+    size_t size() const { return length; }
+};
+
+// Typed reads over a batch that stays where it is (a Batch, a mapped file, shared memory).
+class View {
+    RieWireView v{};
+
+public:
+    // verify: RIE_WIRE_VERIFY_* flags; use both for batches from outside the process.
+    bool open(const void* data, size_t size, int verify = RIE_WIRE_VERIFY_CHECKSUM | RIE_WIRE_VERIFY_RECORDS,
+              std::string* err = nullptr) {
+        if (rie_wire_open(&v, data, size, verify) == 0) return true;
+        if (err) *err = "not a valid graph wire batch";
+        return false;
+    }
+    bool open(const Batch& b, int verify = RIE_WIRE_VERIFY_CHECKSUM | RIE_WIRE_VERIFY_RECORDS, std::string* err = nullptr) {
+        return open(b.data(), b.size(), verify, err);
+    }
+    const RieWireView& raw() const { return v; }
+
+    size_t entity_count() const { return v.entity_count; }
+    size_t reference_count() const { return v.reference_count; }
+    size_t proposal_count() const { return v.proposal_count; }
+    const RieWireEntity& entity(size_t i) const { return v.entities[i]; }
+    const RieWireReference& reference(size_t i) const { return v.references[i]; }
+    const RieWireProposal& proposal(size_t i) const { return v.proposals[i]; }
+
+    std::string_view str(RieWireString s) const {
+        const char* p = rie_wire_str(&v, s);
+        return p ? std::string_view(p, s.length) : std::string_view();
+    }
+    static OntState state(uint8_t s) { return static_cast<OntState>(s); }
+    static RefIntegrityStatus status(uint8_t s) { return static_cast<RefIntegrityStatus>(s); }
+
+    template <typename F>
+    void for_each_attribute(const RieWireEntity& e, F&& fn) const {
+        for (uint32_t i = 0; i < e.attr_count; ++i) fn(str(v.attributes[e.attr_first + i]));
+    }
+    const uint64_t* candidates(const RieWireReference& r) const { return v.candidates + r.candidate_first; }
+};
+
+// Encodes every live entity and reference of the pool, plus proposals, into out.
+inline bool encode(MemoryPool& pool, Batch& out, const std::vector<Proposal>& proposals = {}, std::string* err = nullptr) {
+    std::vector<Entity*> ents = pool.all_entities();
+    std::vector<ReferenceObject*> refs = pool.all_references();
+    const AttributeDictionary& dict = AttributeDictionary::global();
+    RieWireCounts c{};
+    c.count[RIE_WIRE_ENTITIES] = ents.size();
+    c.count[RIE_WIRE_REFERENCES] = refs.size();
+    c.count[RIE_WIRE_PROPOSALS] = proposals.size();
+    for (Entity* e : ents) {
+        c.count[RIE_WIRE_STRINGS] += SymbolTable::global().str(e->name).size();
+        e->attributes.for_each(dict, [&](std::string_view a) {
+            ++c.count[RIE_WIRE_ATTRIBUTES];
+            c.count[RIE_WIRE_STRINGS] += a.size();
+        });
+    }
+    for (ReferenceObject* r : refs) c.count[RIE_WIRE_CANDIDATES] += r->candidateTargets.size();
+    for (const Proposal& p : proposals)
+        c.count[RIE_WIRE_STRINGS] += p.identity_key.size() + p.from.size() + p.to.size() + p.type.size();
+
+    RieWireWriter w;
+    uint64_t bytes = rie_wire_bytes(&c);
+    if (rie_wire_begin(&w, out.reserve(bytes), bytes, &c) != 0) {
+        if (err) *err = "cannot lay out batch";
+        return false;
+    }
+    uint64_t attrs = 0, cands = 0;
+    for (size_t i = 0; i < ents.size(); ++i) {
+        const Entity* e = ents[i];
+        RieWireEntity& o = w.entities[i];
+        std::string_view name = SymbolTable::global().str(e->name);
+        o.id = e->id;
+        o.layer = e->temporal_layer;
+        o.state = static_cast<uint8_t>(e->state);
+        o.name = rie_wire_string(&w, name.data(), name.size());
+        o.attr_first = static_cast<uint32_t>(attrs);
+        e->attributes.for_each(dict, [&](std::string_view a) { w.attributes[attrs++] = rie_wire_string(&w, a.data(), a.size()); });
+        o.attr_count = static_cast<uint32_t>(attrs - o.attr_first);
+    }
+    for (size_t i = 0; i < refs.size(); ++i) {
+        const ReferenceObject* r = refs[i];
+        RieWireReference& o = w.references[i];
+        o.id = r->id;
+        o.source = r->sourceEntityId;
+        o.target = r->targetEntityId;
+        o.creation_layer = r->creationLayer;
+        o.validated_layer = pool.validated_layer(r->id);
+        o.created_state = static_cast<uint8_t>(r->targetStateAtCreation);
+        o.status = static_cast<uint8_t>(r->integrityStatus);
+        o.candidate_first = static_cast<uint32_t>(cands);
+        // Split candidates may be rewritten meanwhile; a batch they no longer fit is refused.
+        for (size_t id : r->candidateTargets) {
+            if (cands == c.count[RIE_WIRE_CANDIDATES]) { w.overflow = 1; break; }
+            w.candidates[cands++] = id;
+        }
+        o.candidate_count = static_cast<uint32_t>(cands - o.candidate_first);
+    }
+    for (size_t i = 0; i < proposals.size(); ++i) {
+        const Proposal& p = proposals[i];
+        RieWireProposal& o = w.proposals[i];
+        o.identity_key = rie_wire_string(&w, p.identity_key.data(), p.identity_key.size());
+        o.from = rie_wire_string(&w, p.from.data(), p.from.size());
+        o.to = rie_wire_string(&w, p.to.data(), p.to.size());
+        o.type = rie_wire_string(&w, p.type.data(), p.type.size());
+        o.layer = p.layer;
+    }
+    out.resize(rie_wire_end(&w));
+    if (out.size()) return true;
+    if (err) *err = "pool changed while encoding";
+    return false;
+}
+
+// Recreates the batch's entities and references in pool under their original ids
+// (statuses and split candidates included) and commits the newest layer. The ids must
+// be free in pool. Returns false at the first object that cannot be restored.
+inline bool decode(MemoryPool& pool, const View& v, std::string* err = nullptr) {
+    auto fail = [&](const std::string& m) {
+        if (err) *err = m;
+        return false;
+    };
+    std::vector<std::string_view> attrs;
+    size_t top = 0;
+    for (size_t i = 0; i < v.entity_count(); ++i) {
+        const RieWireEntity& e = v.entity(i);
+        attrs.clear();
+        v.for_each_attribute(e, [&](std::string_view a) { attrs.push_back(a); });
+        Symbol name = SymbolTable::global().intern(v.str(e.name));
+        if (!pool.restore_entity(e.id, name, AttributeDictionary::global().encode(attrs), View::state(e.state), e.layer))
+            return fail("entity " + std::to_string(e.id) + " cannot be restored");
+        top = std::max<size_t>(top, e.layer);
+    }
+    std::vector<size_t> candidates;
+    for (size_t i = 0; i < v.reference_count(); ++i) {
+        const RieWireReference& r = v.reference(i);
+        ReferenceObject* ref = pool.restore_reference(r.id, r.source, r.target, View::state(r.created_state), r.creation_layer);
+        if (!ref) return fail("reference " + std::to_string(r.id) + " cannot be restored");
+        candidates.assign(v.candidates(r), v.candidates(r) + r.candidate_count);
+        ref->integrityStatus = View::status(r.status);
+        ref->candidateTargets = CandidateSet::of(candidates);
+        ref->lastValidatedLayer = r.validated_layer;
+        pool.sync_status(*ref);
+        ref->record_version();
+        top = std::max<size_t>(top, std::max(r.creation_layer, r.validated_layer));
+    }
+    pool.commit_layer(top);
+    return true;
+}
+
+} // namespace wire
@@ -0,0 +1,215 @@
+// Graph Wire Conformance Test
+// Golden layout, C/C++ agreement, pool round trip and rejection of damaged batches
+// Author: 1proprogrammerchant
+// C++17+ required
+// Build: g++ -std=c++17 -O2 -pthread graph_wire_test.cpp -o graph_wire_test && ./graph_wire_test
+//        The C side must also compile cleanly: gcc -std=c11 -Wall -Wextra -fsyntax-only -x c graph_wire.h
+// Output: one line per check; exit status 1 if any failed.
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "graph_wire.hpp"
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    std::printf("%s %s\n", ok ? "PASS" : "FAIL", what);
+    failures += !ok;
+}
+
+template <typename T>
+static T at(const void* base, size_t offset) {
+    T v;
+    std::memcpy(&v, static_cast<const char*>(base) + offset, sizeof v);
+    return v;
+}
+
+// A batch built with the C API only, checked byte for byte against the documented layout.
+// Any component that writes this batch must produce exactly these bytes.
+static void golden_layout() {
+    RieWireCounts c{};
+    c.count[RIE_WIRE_ENTITIES] = 1;
+    c.count[RIE_WIRE_REFERENCES] = 1;
+    c.count[RIE_WIRE_CANDIDATES] = 2;
+    c.count[RIE_WIRE_ATTRIBUTES] = 1;
+    c.count[RIE_WIRE_PROPOSALS] = 1;
+    c.count[RIE_WIRE_STRINGS] = 64; // reserve; end() keeps what was used
+    alignas(8) unsigned char buf[512];
+    RieWireWriter w;
+    check(rie_wire_bytes(&c) == 128 + 40 + 56 + 16 + 8 + 40 + 64, "golden: size from counts");
+    check(rie_wire_begin(&w, buf + 4, sizeof buf - 4, &c) != 0, "golden: misaligned buffer refused");
+    check(rie_wire_begin(&w, buf, 100, &c) != 0, "golden: short buffer refused");
+    if (rie_wire_begin(&w, buf, sizeof buf, &c) != 0) return check(false, "golden: begin");
+    w.entities[0] = RieWireEntity{1, 2, rie_wire_string(&w, "the man", 7), 0, 1, RIE_DEFINED, {}};
+    w.attributes[0] = rie_wire_string(&w, "human", 5);
+    w.candidates[0] = 7;
+    w.candidates[1] = 8;
+    w.references[0] = RieWireReference{5, 3, 1, 1, 2, 0, 2, RIE_DEFINED, RIE_UNRESOLVED, {}};
+    w.proposals[0] = RieWireProposal{rie_wire_string(&w, "k1", 2), rie_wire_string(&w, "the man", 7),
+                                     rie_wire_string(&w, "the voice", 9), rie_wire_string(&w, "mutation", 8), 3};
+    uint64_t size = rie_wire_end(&w);
+
+    check(size == 128 + 40 + 56 + 16 + 8 + 40 + 40 && at<uint64_t>(buf, 16) == size, "golden: total bytes (strings trimmed to 38 -> 40)");
+    check(std::memcmp(buf, "RIEWIRE\0", 8) == 0 && at<uint32_t>(buf, 8) == 1 && at<uint32_t>(buf, 12) == 128, "golden: magic, version, header bytes");
+    check(at<uint32_t>(buf, 24) == 0x01020304u, "golden: byte order mark");
+    const uint64_t offsets[] = {128, 168, 224, 240, 248, 288}, counts[] = {1, 1, 2, 1, 1, 38};
+    bool sections = true;
+    for (int s = 0; s < RIE_WIRE_SECTIONS; ++s)
+        sections &= at<uint64_t>(buf, 32 + 16 * s) == offsets[s] && at<uint64_t>(buf, 40 + 16 * s) == counts[s];
+    check(sections, "golden: section table");
+    check(at<uint64_t>(buf, 128) == 1 && at<uint64_t>(buf, 136) == 2 && at<uint32_t>(buf, 144) == 0 && at<uint32_t>(buf, 148) == 7 &&
+          at<uint32_t>(buf, 152) == 0 && at<uint32_t>(buf, 156) == 1 && buf[160] == RIE_DEFINED, "golden: entity record");
+    check(at<uint64_t>(buf, 168) == 5 && at<uint64_t>(buf, 176) == 3 && at<uint64_t>(buf, 184) == 1 && at<uint64_t>(buf, 192) == 1 &&
+          at<uint64_t>(buf, 200) == 2 && at<uint32_t>(buf, 208) == 0 && at<uint32_t>(buf, 212) == 2 && buf[216] == RIE_DEFINED &&
+          buf[217] == RIE_UNRESOLVED, "golden: reference record");
+    check(at<uint64_t>(buf, 224) == 7 && at<uint64_t>(buf, 232) == 8 && at<uint32_t>(buf, 240) == 7 && at<uint32_t>(buf, 244) == 5,
+          "golden: candidates and attribute slices");
+    const uint32_t slices[] = {12, 2, 14, 7, 21, 9, 30, 8};
+    bool proposal = at<uint64_t>(buf, 280) == 3;
+    for (int i = 0; i < 8; ++i) proposal &= at<uint32_t>(buf, 248 + 4 * i) == slices[i];
+    check(proposal, "golden: proposal record");
+    check(std::memcmp(buf + 288, "the manhumank1the manthe voicemutation", 38) == 0, "golden: string bytes");
+    check(at<uint32_t>(buf, 28) == 0x469c6f1du, "golden: checksum");
+
+    RieWireView v;
+    check(rie_wire_open(&v, buf, size, RIE_WIRE_VERIFY_CHECKSUM | RIE_WIRE_VERIFY_RECORDS) == 0, "golden: C reader accepts");
+    wire::View cpp;
+    check(cpp.open(buf, size) && cpp.reference(0).candidate_count == 2 && cpp.candidates(cpp.reference(0))[1] == 8 &&
+          cpp.str(cpp.proposal(0).to) == "the voice" && wire::View::status(cpp.reference(0).status) == RefIntegrityStatus::Unresolved,
+          "golden: C++ view reads the same records");
+}
+
+// The demo story, with a split, an invalidation and a merge.
+static void build_story(MemoryPool& pool, ReferentialIntegrityEngine& rie) {
+    Entity* man = pool.create_entity("the man", {"male", "human", "entered"}, OntState::Defined, 0);
+    Entity* voice = pool.create_entity("the voice", {"voice"}, OntState::Defined, 1);
+    Entity* room = pool.create_entity("the room", {}, OntState::Defined, 0);
+    pool.create_reference(voice->id, man->id, man->state, 1);
+    pool.create_reference(man->id, room->id, room->state, 1);
+    pool.create_reference(room->id, voice->id, voice->state, 1);
+    Entity* a = pool.create_entity("the man (aspect A)", {"male", "human", "aspectA"}, OntState::Split, 2);
+    Entity* b = pool.create_entity("the man (aspect B)", {"voice", "aspectB"}, OntState::Split, 2);
+    rie.apply_state_change({man->id, OntState::Split, 2, {a->id, b->id}});
+    rie.propagate_integrity(room->id, OntState::Collapsed, 3);
+    rie.apply_state_change({voice->id, OntState::Merged, 4, {}});
+}
+
+static std::vector<std::string> attributes_of(const Entity* e) {
+    std::vector<std::string> out;
+    e->attributes.for_each(AttributeDictionary::global(), [&](std::string_view a) { out.emplace_back(a); });
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+// Pool -> batch -> (C reader, C++ view) -> fresh pool: every field survives.
+static void pool_round_trip(wire::Batch& batch) {
+    MemoryPool pool;
+    ReferentialIntegrityEngine rie(pool);
+    build_story(pool, rie);
+    std::vector<wire::Proposal> proposals = {{"0a1b", "the man", "the voice", "mutation", 1},
+                                             {"0a1b", "the man", "the silence", "mutation", 1}};
+    std::string err;
+    check(wire::encode(pool, batch, proposals, &err), "round trip: encode pool and proposals");
+
+    RieWireView v;
+    bool c_ok = rie_wire_open(&v, batch.data(), batch.size(), RIE_WIRE_VERIFY_CHECKSUM | RIE_WIRE_VERIFY_RECORDS) == 0;
+    check(c_ok && v.entity_count == pool.all_entities().size() && v.reference_count == pool.all_references().size() &&
+          v.proposal_count == 2, "round trip: C reader counts");
+    bool same = c_ok;
+    for (uint64_t i = 0; same && i < v.reference_count; ++i) {
+        const RieWireReference& r = v.references[i];
+        const ReferenceObject* ref = pool.get_reference(r.id);
+        same = ref && ref->sourceEntityId == r.source && ref->targetEntityId == r.target &&
+               static_cast<uint8_t>(ref->integrityStatus) == r.status && ref->candidateTargets.size() == r.candidate_count &&
+               std::equal(ref->candidateTargets.begin(), ref->candidateTargets.end(), v.candidates + r.candidate_first);
+    }
+    check(same, "round trip: C reader sees the pool's references");
+
+    wire::View view;
+    MemoryPool copy;
+    check(view.open(batch, RIE_WIRE_VERIFY_CHECKSUM | RIE_WIRE_VERIFY_RECORDS, &err) && wire::decode(copy, view, &err),
+          "round trip: decode into a fresh pool");
+    same = copy.all_entities().size() == pool.all_entities().size() && copy.all_references().size() == pool.all_references().size();
+    for (Entity* e : pool.all_entities()) {
+        const Entity* d = copy.get_entity(e->id);
+        same &= d && d->state == e->state && d->temporal_layer == e->temporal_layer &&
+                SymbolTable::global().str(d->name) == SymbolTable::global().str(e->name) && attributes_of(d) == attributes_of(e);
+    }
+    for (ReferenceObject* r : pool.all_references()) {
+        const ReferenceObject* d = copy.get_reference(r->id);
+        same &= d && d->integrityStatus == r->integrityStatus && d->candidateTargets == r->candidateTargets &&
+                copy.validated_layer(d->id) == pool.validated_layer(r->id) && d->creationLayer == r->creationLayer &&
+                d->targetStateAtCreation == r->targetStateAtCreation && d->sourceEntityId == r->sourceEntityId;
+    }
+    check(same, "round trip: entities and references identical");
+    check(copy.committed_layer() == 4, "round trip: newest layer committed");
+    check(!wire::decode(copy, view, &err), "round trip: ids already taken are refused");
+    check(view.str(view.proposal(1).to) == "the silence" && view.proposal(1).layer == 1, "round trip: proposals");
+}
+
+// The batch as a file, mapped and read where it lies.
+static void mapped_file(const wire::Batch& batch) {
+    char path[] = "/tmp/graph_wire_test_XXXXXX";
+    int fd = ::mkstemp(path);
+    bool ok = fd >= 0 && ::write(fd, batch.data(), batch.size()) == static_cast<ssize_t>(batch.size());
+    void* map = ok ? ::mmap(nullptr, batch.size(), PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    wire::View v;
+    check(map != MAP_FAILED && v.open(map, batch.size()) && v.raw().entities == static_cast<const void*>(static_cast<char*>(map) + 128),
+          "mapped: view points into the mapping");
+    if (map != MAP_FAILED) ::munmap(map, batch.size());
+    if (fd >= 0) ::close(fd), ::unlink(path);
+}
+
+static void damaged(const wire::Batch& batch) {
+    std::vector<uint64_t> copy(batch.size() / 8 + 1);
+    auto bytes = [&] { return reinterpret_cast<unsigned char*>(copy.data()); };
+    auto reset = [&] { std::memcpy(bytes(), batch.data(), batch.size()); };
+    auto reseal = [&] {
+        RieWireHeader* h = reinterpret_cast<RieWireHeader*>(bytes());
+        h->checksum = rie_wire_fnv1a(bytes() + h->header_bytes, h->total_bytes - h->header_bytes);
+    };
+    const int all = RIE_WIRE_VERIFY_CHECKSUM | RIE_WIRE_VERIFY_RECORDS;
+    RieWireView v;
+    RieWireHeader* h = reinterpret_cast<RieWireHeader*>(copy.data());
+
+    reset();
+    bytes()[batch.size() - 20] ^= 1;
+    check(rie_wire_open(&v, bytes(), batch.size(), all) != 0 && rie_wire_open(&v, bytes(), batch.size(), 0) == 0,
+          "damaged: flipped byte fails the checksum only");
+    reset();
+    check(rie_wire_open(&v, bytes(), batch.size() - 8, 0) != 0, "damaged: truncated batch");
+    check(rie_wire_open(&v, bytes() + 8, batch.size() - 8, 0) != 0, "damaged: wrong offset");
+    reset();
+    h->version = 2;
+    check(rie_wire_open(&v, bytes(), batch.size(), 0) != 0, "damaged: unknown version");
+    reset();
+    h->byte_order = 0x04030201u;
+    check(rie_wire_open(&v, bytes(), batch.size(), 0) != 0, "damaged: other byte order");
+    reset();
+    h->sections[RIE_WIRE_REFERENCES].count = 1u << 30;
+    check(rie_wire_open(&v, bytes(), batch.size(), 0) != 0, "damaged: section past the end");
+    reset();
+    reinterpret_cast<RieWireEntity*>(bytes() + h->sections[RIE_WIRE_ENTITIES].offset)->state = RIE_STATE_COUNT;
+    reseal();
+    check(rie_wire_open(&v, bytes(), batch.size(), all) != 0, "damaged: state out of range");
+    reset();
+    reinterpret_cast<RieWireEntity*>(bytes() + h->sections[RIE_WIRE_ENTITIES].offset)->name.length = 1u << 20;
+    reseal();
+    check(rie_wire_open(&v, bytes(), batch.size(), all) != 0, "damaged: string slice out of bounds");
+    reset();
+    reinterpret_cast<RieWireReference*>(bytes() + h->sections[RIE_WIRE_REFERENCES].offset)->candidate_first = UINT32_MAX;
+    reseal();
+    check(rie_wire_open(&v, bytes(), batch.size(), all) != 0, "damaged: candidate slice out of bounds");
+}
+
+int main() {
+    golden_layout();
+    wire::Batch batch;
+    pool_round_trip(batch);
+    mapped_file(batch);
+    damaged(batch);
+    std::printf("%s\n", failures ? "FAILED" : "all checks passed");
+    return failures ? 1 : 0;
+}
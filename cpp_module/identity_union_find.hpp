@@ -0,0 +1,259 @@
+// Identity Union-Find
+// Canonical entities for merged identities: concurrent union-find with layer-versioned undo
+// Author: 1proprogrammerchant
+// C++17+ required
+#pragma once
+#include <deque>
+#include <memory>
+#include <mutex>
+#include "oesm_highperf.hpp"
+
+// Entities that took part in a merge get a node; a merged identity is a tree of nodes
+// whose root names the canonical entity (the survivor of the latest merge into it).
+// resolve() never locks: it walks to the root and compresses the path behind it.
+// Merges link roots by rank, so trees stay shallow even before compression; merges,
+// splits and undo serialize on a mutex.
+//
+// Undo: every merge and split is logged with its layer and rollback_to(layer) reverts
+// the ones after it. Compressed paths would survive a revert, so shortcuts are stamped
+// with an undo generation and a rollback invalidates all of them by bumping it; the
+// real parent links change only on merge and revert. A merge or split that changes
+// nothing is still logged when the history already holds a later layer: rolling back
+// that layer replays it, and by then it may apply.
+//
+// A split detaches the entity: it moves to a fresh node, and its old node stays in the
+// tree so the rest of the identity still resolves through it.
+class IdentityUnionFind : public IdentityEvents {
+    static constexpr unsigned CHUNK_BITS = 14;
+    static constexpr size_t CHUNK_SIZE = size_t(1) << CHUNK_BITS;
+    static constexpr size_t MAX_CHUNKS = size_t(1) << 16;
+    static constexpr size_t MAX_DEPTH = 64; // rank bounds tree height by log2(nodes)
+
+    struct Node {
+        std::atomic<uint32_t> parent{0};   // 0: root
+        uint32_t rank = 0;                 // writers only
+        std::atomic<uint64_t> shortcut{0}; // undo generation << 32 | ancestor
+        std::atomic<size_t> canonical{0};  // entity id; meaningful at roots
+    };
+
+    // Fixed directory of lazily allocated chunks; only writers allocate.
+    template <typename T>
+    struct Chunks {
+        std::unique_ptr<std::atomic<T*>[]> dir;
+        Chunks() : dir(new std::atomic<T*>[MAX_CHUNKS]) {
+            for (size_t i = 0; i < MAX_CHUNKS; ++i) dir[i].store(nullptr, std::memory_order_relaxed);
+        }
+        ~Chunks() {
+            for (size_t i = 0; i < MAX_CHUNKS; ++i) delete[] dir[i].load(std::memory_order_relaxed);
+        }
+        T& operator[](size_t i) const { return dir[i >> CHUNK_BITS].load(std::memory_order_acquire)[i & (CHUNK_SIZE - 1)]; }
+        T* at(size_t i) const {
+            if ((i >> CHUNK_BITS) >= MAX_CHUNKS) return nullptr;
+            T* c = dir[i >> CHUNK_BITS].load(std::memory_order_acquire);
+            return c ? &c[i & (CHUNK_SIZE - 1)] : nullptr;
+        }
+        T* make(size_t i) {
+            if ((i >> CHUNK_BITS) >= MAX_CHUNKS) return nullptr;
+            std::atomic<T*>& slot = dir[i >> CHUNK_BITS];
+            T* c = slot.load(std::memory_order_relaxed);
+            if (!c) {
+                c = new T[CHUNK_SIZE]();
+                slot.store(c, std::memory_order_release);
+            }
+            return &c[i & (CHUNK_SIZE - 1)];
+        }
+        size_t allocated() const {
+            size_t n = 0;
+            for (size_t i = 0; i < MAX_CHUNKS; ++i) n += dir[i].load(std::memory_order_relaxed) != nullptr;
+            return n;
+        }
+    };
+
+    struct Undo {
+        enum Kind : uint8_t { Merge, Split } kind;
+        size_t layer;
+        size_t entity, into;            // the call, for replay
+        uint32_t child, parent, parent_rank; // Merge: child 0 if it changed nothing
+        size_t parent_canonical;
+        uint64_t member;                // Split: the entity's previous membership, 0 if it changed nothing
+    };
+
+    MemoryPool& pool;
+    Chunks<Node> nodes;
+    Chunks<std::atomic<uint64_t>> members; // by entity slot: generation << 32 | node
+    std::atomic<uint32_t> generation{1};
+    uint32_t next_node = 1;
+    std::deque<Undo> history;
+    size_t top_layer = 0; // highest layer in history
+    std::atomic<size_t> merge_count{0}, split_count{0};
+    mutable std::mutex write_mutex;
+
+    Node& node(uint32_t n) const { return nodes[n]; }
+
+    // The entity's node, or 0 if it never merged (or its slot was reused since).
+    uint32_t node_of(size_t eid) const {
+        const std::atomic<uint64_t>* m = members.at(handle_index(eid));
+        if (!m) return 0;
+        uint64_t w = m->load(std::memory_order_acquire);
+        return (w >> 32) == handle_generation(eid) ? static_cast<uint32_t>(w) : 0;
+    }
+    // Follows valid shortcuts, then points every node on the way at the root.
+    uint32_t root(uint32_t n) const {
+        const uint32_t g = generation.load(std::memory_order_acquire);
+        uint32_t path[MAX_DEPTH];
+        size_t depth = 0;
+        for (;;) {
+            Node& x = node(n);
+            uint64_t s = x.shortcut.load(std::memory_order_relaxed);
+            uint32_t next = (s >> 32) == g ? static_cast<uint32_t>(s) : x.parent.load(std::memory_order_acquire);
+            if (!next) break;
+            if (depth < MAX_DEPTH) path[depth++] = n;
+            n = next;
+        }
+        for (size_t i = 0; i + 1 < depth; ++i)
+            node(path[i]).shortcut.store(uint64_t(g) << 32 | n, std::memory_order_relaxed);
+        return n;
+    }
+    uint32_t new_node(size_t eid) {
+        Node* x = nodes.make(next_node);
+        if (!x) return 0;
+        x->canonical.store(eid, std::memory_order_relaxed);
+        return next_node++;
+    }
+    uint32_t ensure_node(size_t eid) {
+        if (uint32_t n = node_of(eid)) return n;
+        std::atomic<uint64_t>* m = members.make(handle_index(eid));
+        uint32_t n = m ? new_node(eid) : 0;
+        if (n) m->store(uint64_t(handle_generation(eid)) << 32 | n, std::memory_order_release);
+        return n;
+    }
+
+    bool link(size_t eid, size_t into, size_t layer) {
+        if (!pool.get_entity(eid) || !pool.get_entity(into)) return false;
+        uint32_t a = ensure_node(eid), b = ensure_node(into);
+        if (!a || !b) return false;
+        uint32_t ra = root(a), rb = root(b);
+        if (ra == rb) {
+            // Logged behind a later layer, it must be replayed if that layer is rolled back.
+            if (layer < top_layer) log({Undo::Merge, layer, eid, into, 0, 0, 0, 0, 0});
+            return false;
+        }
+        size_t survivor = node(rb).canonical.load(std::memory_order_relaxed);
+        uint32_t child = ra, parent = rb;
+        if (node(ra).rank > node(rb).rank) std::swap(child, parent);
+        Node &c = node(child), &p = node(parent);
+        log({Undo::Merge, layer, eid, into, child, parent, p.rank, p.canonical.load(std::memory_order_relaxed), 0});
+        if (c.rank == p.rank) ++p.rank;
+        p.canonical.store(survivor, std::memory_order_release);
+        c.parent.store(parent, std::memory_order_release);
+        merge_count.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    bool detach(size_t eid, size_t layer) {
+        uint32_t n = node_of(eid);
+        if (!n || (root(n) == n && node(n).rank == 0)) { // not part of a merged identity
+            if (layer < top_layer) log({Undo::Split, layer, eid, 0, 0, 0, 0, 0, 0}); // as in link()
+            return false;
+        }
+        std::atomic<uint64_t>& m = members[handle_index(eid)];
+        uint64_t old = m.load(std::memory_order_relaxed);
+        uint32_t fresh = new_node(eid);
+        if (!fresh) return false;
+        log({Undo::Split, layer, eid, 0, 0, 0, 0, 0, old});
+        m.store(uint64_t(handle_generation(eid)) << 32 | fresh, std::memory_order_release);
+        split_count.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    void log(const Undo& u) {
+        history.push_back(u);
+        top_layer = std::max(top_layer, u.layer);
+    }
+    void revert(const Undo& u) {
+        if (u.kind == Undo::Merge ? !u.child : !u.member) return;
+        if (u.kind == Undo::Merge) {
+            Node& p = node(u.parent);
+            node(u.child).parent.store(0, std::memory_order_release);
+            p.rank = u.parent_rank;
+            p.canonical.store(u.parent_canonical, std::memory_order_release);
+            merge_count.fetch_sub(1, std::memory_order_relaxed);
+        } else {
+            members[handle_index(u.entity)].store(u.member, std::memory_order_release);
+            split_count.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+public:
+    explicit IdentityUnionFind(MemoryPool& p) : pool(p) {}
+
+    // eid now denotes the same individual as into; into's identity stays canonical.
+    // False if either entity is gone or they already share an identity.
+    bool merge(size_t eid, size_t into, size_t layer) {
+        std::lock_guard lock(write_mutex);
+        return link(eid, into, layer);
+    }
+    // eid stops resolving through the identity it merged into. False if it had none.
+    bool split(size_t eid, size_t layer) {
+        std::lock_guard lock(write_mutex);
+        return detach(eid, layer);
+    }
+    // RIE hooks (rie.attach_identities(&uf)): StateChange::mergedInto and Split changes.
+    void entity_merged(size_t eid, size_t into, size_t layer) override { merge(eid, into, layer); }
+    void entity_split(size_t eid, const std::vector<size_t>&, size_t layer) override { split(eid, layer); }
+
+    // The canonical entity for eid (eid itself if it never merged). Lock-free, near O(1).
+    size_t resolve(size_t eid) const {
+        uint32_t n = node_of(eid);
+        return n ? node(root(n)).canonical.load(std::memory_order_acquire) : eid;
+    }
+    bool same_identity(size_t a, size_t b) const { return resolve(a) == resolve(b); }
+    // The canonical entity a reference points at; 0 if the reference is gone.
+    size_t resolve_reference(size_t rid) const {
+        const ReferenceObject* ref = pool.get_reference(rid);
+        return ref ? resolve(ref->targetEntityId) : 0;
+    }
+
+    // Reverts every merge and split logged after layer, newest first; returns how many.
+    // Later calls logged for earlier layers are replayed on top.
+    size_t rollback_to(size_t layer) {
+        std::lock_guard lock(write_mutex);
+        size_t first = 0;
+        while (first < history.size() && history[first].layer <= layer) ++first;
+        if (first == history.size()) return 0;
+        std::vector<Undo> replay;
+        for (size_t i = history.size(); i-- > first;) {
+            revert(history[i]);
+            if (history[i].layer <= layer) replay.push_back(history[i]);
+        }
+        size_t reverted = 0;
+        for (size_t i = first; i < history.size(); ++i)
+            reverted += history[i].layer > layer && (history[i].kind == Undo::Split ? history[i].member != 0 : history[i].child != 0);
+        history.resize(first);
+        top_layer = 0;
+        for (const Undo& u : history) top_layer = std::max(top_layer, u.layer);
+        generation.fetch_add(1, std::memory_order_release);
+        for (auto it = replay.rbegin(); it != replay.rend(); ++it) {
+            if (it->kind == Undo::Merge) link(it->entity, it->into, it->layer);
+            else detach(it->entity, it->layer);
+        }
+        return reverted;
+    }
+    // Drops the undo records of layers <= layer; those can no longer be rolled back.
+    size_t compact(size_t layer) {
+        std::lock_guard lock(write_mutex);
+        size_t n = 0;
+        while (!history.empty() && history.front().layer <= layer) history.pop_front(), ++n;
+        return n;
+    }
+
+    size_t merges() const { return merge_count.load(std::memory_order_relaxed); }
+    size_t splits() const { return split_count.load(std::memory_order_relaxed); }
+    size_t undo_records() const {
+        std::lock_guard lock(write_mutex);
+        return history.size();
+    }
+    size_t bytes() const {
+        std::lock_guard lock(write_mutex);
+        return nodes.allocated() * CHUNK_SIZE * sizeof(Node) + members.allocated() * CHUNK_SIZE * sizeof(uint64_t) +
+               2 * MAX_CHUNKS * sizeof(void*) + history.size() * sizeof(Undo);
+    }
+};
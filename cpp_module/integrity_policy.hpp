@@ -0,0 +1,160 @@
+// Integrity Policies
+// OntState -> RefIntegrityStatus rules declared once, compiled into constexpr lookup tables
+// Author: 1proprogrammerchant
+// C++17+ required
+// Build flag: -DRIE_DEFAULT_POLICY=<policy> picks the build-time default (default: policy::STANDARD).
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+// Ontological states
+enum class OntState {
+    Undefined, Defined, Referenced, Reinterpreted, Contradicted, Split, Merged, Abstracted, ObserverRelative, Collapsed
+};
+
+// Reference integrity status
+enum class RefIntegrityStatus {
+    Valid, IdentityChanged, IdentitySplit, IdentityMerged, Invalidated, Unresolved, ObserverRelative
+};
+
+constexpr size_t ONT_STATE_COUNT = static_cast<size_t>(OntState::Collapsed) + 1;
+
+// One rule: when the target was created in `created` and moves to `next`, the reference
+// gets `status`. Either side may be ANY; `next` may also be SAME (equal to created).
+// Rules are tried in order and the first match wins, as an if/else chain would.
+struct IntegrityRule {
+    enum Match : uint8_t { STATE, ANY, SAME };
+    Match created_match, next_match;
+    OntState created, next;
+    RefIntegrityStatus status;
+
+    constexpr bool matches(OntState c, OntState n) const {
+        bool cm = created_match == ANY || created == c;
+        bool nm = next_match == ANY || (next_match == SAME ? n == c : next == n);
+        return cm && nm;
+    }
+};
+
+namespace rule {
+// When the target moves to `next` (whatever it was created as)
+constexpr IntegrityRule to(OntState next, RefIntegrityStatus s) {
+    return {IntegrityRule::ANY, IntegrityRule::STATE, OntState::Undefined, next, s};
+}
+// When the target moves from `created` to `next`
+constexpr IntegrityRule from_to(OntState created, OntState next, RefIntegrityStatus s) {
+    return {IntegrityRule::STATE, IntegrityRule::STATE, created, next, s};
+}
+// When the target is back in (or never left) its creation state
+constexpr IntegrityRule unchanged(RefIntegrityStatus s) {
+    return {IntegrityRule::ANY, IntegrityRule::SAME, OntState::Undefined, OntState::Undefined, s};
+}
+// Everything not matched earlier
+constexpr IntegrityRule otherwise(RefIntegrityStatus s) {
+    return {IntegrityRule::ANY, IntegrityRule::ANY, OntState::Undefined, OntState::Undefined, s};
+}
+} // namespace rule
+
+// A compiled rule set: table[created][next], one byte per cell. Classification is a
+// single indexed load. `uniform` is true when a row depends on the creation state only
+// through created == next, which lets the SIMD kernels use two 16-byte lookups.
+struct IntegrityPolicy {
+    const char* name;
+    std::array<uint8_t, ONT_STATE_COUNT * ONT_STATE_COUNT> table;
+    std::array<uint8_t, 16> changed_lut, same_lut; // by next state; valid when uniform
+    bool uniform;
+
+    constexpr RefIntegrityStatus classify(OntState created, OntState next) const {
+        return static_cast<RefIntegrityStatus>(table[static_cast<size_t>(created) * ONT_STATE_COUNT + static_cast<size_t>(next)]);
+    }
+};
+
+// Rule sets without a catch-all leave unmatched cells Valid.
+constexpr IntegrityPolicy compile_policy(const char* name, std::initializer_list<IntegrityRule> rules) {
+    IntegrityPolicy p{name, {}, {}, {}, true};
+    for (size_t c = 0; c < ONT_STATE_COUNT; ++c)
+        for (size_t n = 0; n < ONT_STATE_COUNT; ++n) {
+            RefIntegrityStatus s = RefIntegrityStatus::Valid;
+            for (const IntegrityRule& r : rules)
+                if (r.matches(static_cast<OntState>(c), static_cast<OntState>(n))) {
+                    s = r.status;
+                    break;
+                }
+            p.table[c * ONT_STATE_COUNT + n] = static_cast<uint8_t>(s);
+        }
+    for (size_t n = 0; n < ONT_STATE_COUNT; ++n) {
+        p.same_lut[n] = p.table[n * ONT_STATE_COUNT + n];
+        p.changed_lut[n] = p.table[(n == 0 ? 1 : 0) * ONT_STATE_COUNT + n];
+        for (size_t c = 0; c < ONT_STATE_COUNT; ++c)
+            if (c != n && p.table[c * ONT_STATE_COUNT + n] != p.changed_lut[n]) p.uniform = false;
+    }
+    return p;
+}
+
+namespace policy {
+
+// The engine's rules: split, merge, observer and collapse transitions decide the status;
+// any other change of state is an identity change.
+constexpr IntegrityPolicy STANDARD = compile_policy("standard", {
+    rule::to(OntState::Split, RefIntegrityStatus::Unresolved),
+    rule::to(OntState::Merged, RefIntegrityStatus::IdentityMerged),
+    rule::to(OntState::ObserverRelative, RefIntegrityStatus::ObserverRelative),
+    rule::to(OntState::Collapsed, RefIntegrityStatus::Invalidated),
+    rule::unchanged(RefIntegrityStatus::Valid),
+    rule::otherwise(RefIntegrityStatus::IdentityChanged),
+});
+
+// As STANDARD, but a reinterpretation (and a plain re-reference) keeps references Valid.
+constexpr IntegrityPolicy REINTERPRETATION_VALID = compile_policy("reinterpretation_valid", {
+    rule::to(OntState::Split, RefIntegrityStatus::Unresolved),
+    rule::to(OntState::Merged, RefIntegrityStatus::IdentityMerged),
+    rule::to(OntState::ObserverRelative, RefIntegrityStatus::ObserverRelative),
+    rule::to(OntState::Collapsed, RefIntegrityStatus::Invalidated),
+    rule::to(OntState::Reinterpreted, RefIntegrityStatus::Valid),
+    rule::to(OntState::Referenced, RefIntegrityStatus::Valid),
+    rule::unchanged(RefIntegrityStatus::Valid),
+    rule::otherwise(RefIntegrityStatus::IdentityChanged),
+});
+
+// Only the terminal transitions matter: collapse invalidates, split leaves the
+// reference unresolved, everything else stays Valid.
+constexpr IntegrityPolicy TERMINAL_ONLY = compile_policy("terminal_only", {
+    rule::to(OntState::Split, RefIntegrityStatus::Unresolved),
+    rule::to(OntState::Collapsed, RefIntegrityStatus::Invalidated),
+    rule::otherwise(RefIntegrityStatus::Valid),
+});
+
+static_assert(STANDARD.uniform && REINTERPRETATION_VALID.uniform && TERMINAL_ONLY.uniform);
+static_assert(STANDARD.classify(OntState::Defined, OntState::Defined) == RefIntegrityStatus::Valid);
+static_assert(STANDARD.classify(OntState::Defined, OntState::Reinterpreted) == RefIntegrityStatus::IdentityChanged);
+static_assert(STANDARD.classify(OntState::Split, OntState::Split) == RefIntegrityStatus::Unresolved);
+static_assert(STANDARD.classify(OntState::Defined, OntState::Collapsed) == RefIntegrityStatus::Invalidated);
+static_assert(REINTERPRETATION_VALID.classify(OntState::Defined, OntState::Reinterpreted) == RefIntegrityStatus::Valid);
+static_assert(TERMINAL_ONLY.classify(OntState::Defined, OntState::Merged) == RefIntegrityStatus::Valid);
+
+// Runtime lookup by name (configuration files, command-line flags); nullptr if unknown.
+inline const IntegrityPolicy* by_name(const char* name) {
+    static const IntegrityPolicy* all[] = {&STANDARD, &REINTERPRETATION_VALID, &TERMINAL_ONLY};
+    for (const IntegrityPolicy* p : all) {
+        const char *a = p->name, *b = name;
+        while (*a && *a == *b) ++a, ++b;
+        if (*a == *b) return p;
+    }
+    return nullptr;
+}
+
+} // namespace policy
+
+#ifndef RIE_DEFAULT_POLICY
+#define RIE_DEFAULT_POLICY policy::STANDARD
+#endif
+
+// The build-time default policy, used wherever no policy is passed.
+constexpr const IntegrityPolicy& default_policy() { return RIE_DEFAULT_POLICY; }
+
+// The reference-status decision for a target that moved to newState
+constexpr RefIntegrityStatus classify_status(OntState createdState, OntState newState,
+                                             const IntegrityPolicy& p = default_policy()) {
+    return p.classify(createdState, newState);
+}
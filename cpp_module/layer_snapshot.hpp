@@ -0,0 +1,74 @@
+// As-Of-Layer Snapshots
+// Read the graph as it stood at a temporal layer while writers commit newer ones
+// Author: 1proprogrammerchant
+// C++17+ required
+#pragma once
+#include "oesm_highperf.hpp"
+
+// A consistent view of entity states and reference statuses as of one layer.
+// Reads walk version chains inside an epoch guard: no locks on the version data, and
+// nothing a snapshot can reach is freed while it is open. While any snapshot is open,
+// MemoryPool::compact_history keeps the versions its layer needs, and MemoryPool::reclaim
+// retires only objects that were already dead at its layer (they then read as unknown).
+// Use a snapshot on the thread that opened it.
+class LayerSnapshot {
+    MemoryPool& pool;
+    size_t at;
+    bool ok;
+    EpochManager::Guard guard;
+
+public:
+    static constexpr size_t LATEST = SIZE_MAX;
+
+    // LATEST reads as of the pool's committed layer. valid() is false when the
+    // requested layer's history has already been compacted away.
+    explicit LayerSnapshot(MemoryPool& p, size_t layer = LATEST)
+        : pool(p), at(layer == LATEST ? p.committed_layer() : layer), ok(p.readers.enter(at)),
+          guard(EpochManager::global()) {}
+    LayerSnapshot(const LayerSnapshot&) = delete;
+    LayerSnapshot& operator=(const LayerSnapshot&) = delete;
+    ~LayerSnapshot() {
+        if (ok) pool.readers.leave(at);
+    }
+
+    bool valid() const { return ok; }
+    size_t layer() const { return at; }
+
+    // State of eid as of the snapshot layer; false if it did not exist yet.
+    // since (optional) receives the layer that state was committed in.
+    bool entity_state(size_t eid, OntState& out, size_t* since = nullptr) const {
+        Entity* e = ok ? pool.get_entity(eid) : nullptr;
+        const auto* v = e ? e->history.as_of(at) : nullptr;
+        if (!v) return false;
+        out = v->value;
+        if (since) *since = v->layer;
+        return true;
+    }
+
+    // Status (and split candidates) of rid as of the snapshot layer; false if the
+    // reference did not exist yet.
+    bool reference_status(size_t rid, RefIntegrityStatus& out, CandidateSet* candidates = nullptr) const {
+        ReferenceObject* r = ok ? pool.get_reference(rid) : nullptr;
+        const auto* v = r ? r->history.as_of(at) : nullptr;
+        if (!v) return false;
+        out = v->value.status;
+        if (candidates) *candidates = v->value.candidates;
+        return true;
+    }
+
+    // fn(entity, state) for each entity that existed at the snapshot layer.
+    template <typename F>
+    void for_each_entity(F&& fn) const {
+        if (!ok) return;
+        for (Entity* e : pool.all_entities())
+            if (const auto* v = e->history.as_of(at)) fn(*e, v->value);
+    }
+
+    // fn(reference, status, candidates) for each reference that existed at the snapshot layer.
+    template <typename F>
+    void for_each_reference(F&& fn) const {
+        if (!ok) return;
+        for (ReferenceObject* r : pool.all_references())
+            if (const auto* v = r->history.as_of(at)) fn(*r, v->value.status, v->value.candidates);
+    }
+};
@@ -0,0 +1,77 @@
+// Layer Snapshot Isolation Test
+// A latest snapshot opened while a layer is still being written must not see that layer
+// Author: 1proprogrammerchant
+// C++17+ required
+// Build: g++ -std=c++17 -O2 -pthread layer_snapshot_test.cpp -o layer_snapshot_test && ./layer_snapshot_test
+// Output: one line per check; exit status 1 if any failed.
+#include <cstdio>
+#include "layer_snapshot.hpp"
+#include "split_resolver.hpp"
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    std::printf("%s %s\n", ok ? "PASS" : "FAIL", what);
+    failures += !ok;
+}
+
+// Layer 2 is written in four calls (creation, state changes, propagation, resolution);
+// snapshots taken between them read layer 1 until the caller commits layer 2.
+static void mid_layer() {
+    MemoryPool pool;
+    ReferentialIntegrityEngine rie(pool);
+    size_t room = pool.create_entity("the room", {"place"}, OntState::Defined, 0)->id;
+    size_t man = pool.create_entity("the man", {"human"}, OntState::Defined, 1)->id;
+    size_t voice = pool.create_entity("the voice", {"voice"}, OntState::Defined, 1)->id;
+    size_t in_room = pool.create_reference(man, room, OntState::Defined, 1)->id;
+    size_t says = pool.create_reference(voice, man, OntState::Defined, 1)->id;
+    size_t figure = pool.create_entity("the figure", {"human"}, OntState::Defined, 1)->id;
+    size_t seen = pool.create_reference(man, figure, OntState::Defined, 1)->id;
+    pool.commit_layer(1);
+
+    size_t late = pool.create_entity("the echo", {"voice"}, OntState::Defined, 2)->id;
+    size_t person = pool.create_entity("the figure (person)", {"human"}, OntState::Split, 2)->id;
+    size_t statue = pool.create_entity("the figure (statue)", {"object"}, OntState::Split, 2)->id;
+    rie.apply_state_changes({{room, OntState::Collapsed, 2, {}}, {figure, OntState::Split, 2, {person, statue}}});
+    {
+        LayerSnapshot snap(pool);
+        OntState s;
+        RefIntegrityStatus st;
+        check(snap.layer() == 1, "mid-layer: latest is the last committed layer");
+        check(!snap.entity_state(late, s), "mid-layer: entity created in the open layer is unseen");
+        check(snap.entity_state(room, s) && s == OntState::Defined, "mid-layer: state change is unseen");
+        check(snap.reference_status(in_room, st) && st == RefIntegrityStatus::Valid, "mid-layer: direct status is unseen");
+    }
+    rie.propagate_integrity(room, OntState::Collapsed, 2);
+    {
+        LayerSnapshot snap(pool);
+        RefIntegrityStatus st;
+        check(snap.layer() == 1, "mid-layer: propagation alone commits nothing");
+        check(snap.reference_status(says, st) && st == RefIntegrityStatus::Valid, "mid-layer: cascade is unseen");
+    }
+    SplitResolver resolver(rie);
+    check(resolver.run({seen}, 2).resolved == 1, "mid-layer: split reference resolved");
+    check(pool.committed_layer() == 1, "mid-layer: resolution commits nothing");
+    {
+        LayerSnapshot snap(pool);
+        RefIntegrityStatus st;
+        check(snap.reference_status(seen, st) && st == RefIntegrityStatus::Valid, "mid-layer: resolution is unseen");
+    }
+
+    pool.commit_layer(2);
+    LayerSnapshot snap(pool);
+    OntState s;
+    RefIntegrityStatus st;
+    check(snap.layer() == 2, "committed: latest is layer 2");
+    check(snap.entity_state(late, s), "committed: new entity visible");
+    check(snap.entity_state(room, s) && s == OntState::Collapsed, "committed: state change visible");
+    check(snap.reference_status(in_room, st) && st == RefIntegrityStatus::Invalidated, "committed: direct status visible");
+    check(snap.reference_status(says, st) && st == RefIntegrityStatus::Invalidated, "committed: cascade visible");
+    check(snap.reference_status(seen, st) && st == RefIntegrityStatus::IdentitySplit, "committed: resolution visible");
+}
+
+int main() {
+    mid_layer();
+    std::printf("%s\n", failures ? "FAILED" : "all checks passed");
+    return failures ? 1 : 0;
+}
@@ -1,6 +1,7 @@
 // Sample C++ integration for NLP bot
+// Build: g++ -std=c++17 -O2 -pthread main.cpp python_bridge.cpp $(python3-config --includes) $(python3-config --ldflags --embed)
 #include <iostream>
-extern "C" void call_python_nlp();
+#include "python_bridge.h"
 
 int main() {
     std::cout << "C++ module: calling Python NLP core..." << std::endl;
@@ -0,0 +1,416 @@
+// Observer-Relative Overlays
+// Per-observer entity states and reference statuses layered over the shared graph
+// Author: 1proprogrammerchant
+// C++17+ required
+#pragma once
+#include <algorithm>
+#include <memory>
+#include <shared_mutex>
+#include <unordered_map>
+#include "oesm_highperf.hpp"
+
+// Sparse id -> value map with lock-free reads. Entries live in immutable sorted shards
+// picked by a hash of the id; a write copies only the shards it touches and publishes
+// them with one pointer store. Replaced shards are freed through epoch-based
+// reclamation, so readers must hold an EpochManager guard. The shard count doubles
+// as the map grows, keeping copies short; an empty map is one directory with one slot.
+// Writers serialize on a mutex.
+template <typename V>
+class CowMap {
+public:
+    struct Entry {
+        size_t key;
+        V value;
+    };
+
+private:
+    static constexpr size_t SHARD_TARGET = 64; // mean entries per shard before doubling
+    static constexpr unsigned MAX_BITS = 16;
+
+    struct Shard {
+        std::vector<Entry> entries; // sorted by key
+    };
+    struct Directory {
+        unsigned bits;
+        std::unique_ptr<std::atomic<Shard*>[]> shards;
+        explicit Directory(unsigned b) : bits(b), shards(new std::atomic<Shard*>[size_t(1) << b]) {
+            for (size_t i = 0; i < slots(); ++i) shards[i].store(nullptr, std::memory_order_relaxed);
+        }
+        ~Directory() {
+            for (size_t i = 0; i < slots(); ++i) delete shards[i].load(std::memory_order_relaxed);
+        }
+        size_t slots() const { return size_t(1) << bits; }
+        size_t slot(size_t key) const { return bits ? (key * 0x9E3779B97F4A7C15ull) >> (64 - bits) : 0; }
+    };
+
+    std::atomic<Directory*> dir;
+    std::atomic<size_t> count{0};
+    std::mutex write_mutex;
+
+    static const Entry* lower(const Shard* s, size_t key) {
+        return std::lower_bound(s->entries.data(), s->entries.data() + s->entries.size(), key,
+                                [](const Entry& e, size_t k) { return e.key < k; });
+    }
+    // Swaps in a new shard; the old one is retired, never freed under a reader.
+    static void publish(Directory* d, size_t i, Shard* s) {
+        Shard* old = d->shards[i].exchange(s, std::memory_order_acq_rel);
+        if (old) EpochManager::global().retire(old);
+    }
+    // Rehashes into a directory with more shards once the mean shard outgrows SHARD_TARGET.
+    void grow(Directory* d) {
+        unsigned bits = d->bits;
+        while (bits < MAX_BITS && count.load(std::memory_order_relaxed) > (size_t(SHARD_TARGET) << bits)) ++bits;
+        if (bits == d->bits) return;
+        auto* n = new Directory(bits);
+        std::vector<std::vector<Entry>> parts(n->slots());
+        for (size_t i = 0; i < d->slots(); ++i)
+            if (const Shard* s = d->shards[i].load(std::memory_order_relaxed))
+                for (const Entry& e : s->entries) parts[n->slot(e.key)].push_back(e);
+        for (size_t i = 0; i < n->slots(); ++i)
+            if (!parts[i].empty()) n->shards[i].store(new Shard{std::move(parts[i])}, std::memory_order_relaxed);
+        dir.store(n, std::memory_order_release);
+        EpochManager::global().retire(d);
+    }
+    // Applies the sorted, deduplicated (key, value-or-null) edits to one shard.
+    void rewrite(Directory* d, size_t i, const std::pair<size_t, const V*>* edits, size_t n) {
+        const Shard* old = d->shards[i].load(std::memory_order_relaxed);
+        std::vector<Entry> out;
+        out.reserve((old ? old->entries.size() : 0) + n);
+        const Entry* a = old ? old->entries.data() : nullptr;
+        const Entry* a_end = old ? a + old->entries.size() : nullptr;
+        size_t added = 0, removed = 0;
+        bool changed = false;
+        for (size_t k = 0; k < n; ++k) {
+            size_t key = edits[k].first;
+            while (a != a_end && a->key < key) out.push_back(*a++);
+            bool present = a != a_end && a->key == key;
+            if (present) ++a;
+            if (edits[k].second) {
+                out.push_back({key, *edits[k].second});
+                added += !present;
+                changed = true;
+            } else {
+                removed += present;
+                changed |= present;
+            }
+        }
+        while (a != a_end) out.push_back(*a++);
+        if (!changed) return;
+        count.fetch_add(added, std::memory_order_relaxed);
+        count.fetch_sub(removed, std::memory_order_relaxed);
+        publish(d, i, out.empty() ? nullptr : new Shard{std::move(out)});
+    }
+
+public:
+    CowMap() : dir(new Directory(0)) {}
+    CowMap(const CowMap&) = delete;
+    CowMap& operator=(const CowMap&) = delete;
+    ~CowMap() { delete dir.load(std::memory_order_relaxed); }
+
+    // Caller holds an epoch guard.
+    const V* find(size_t key) const {
+        const Directory* d = dir.load(std::memory_order_acquire);
+        const Shard* s = d->shards[d->slot(key)].load(std::memory_order_acquire);
+        if (!s) return nullptr;
+        const Entry* e = lower(s, key);
+        return e != s->entries.data() + s->entries.size() && e->key == key ? &e->value : nullptr;
+    }
+
+    // Batched upsert (value) / erase (nullptr); the last edit of a key wins. Each shard
+    // the batch touches is copied once.
+    void update(std::vector<std::pair<size_t, const V*>> edits) {
+        if (edits.empty()) return;
+        std::lock_guard lock(write_mutex);
+        Directory* d = dir.load(std::memory_order_relaxed);
+        std::stable_sort(edits.begin(), edits.end(), [&](const auto& x, const auto& y) {
+            size_t sx = d->slot(x.first), sy = d->slot(y.first);
+            return sx != sy ? sx < sy : x.first < y.first;
+        });
+        size_t w = 0;
+        for (size_t k = 0; k < edits.size(); ++k) {
+            if (w && edits[w - 1].first == edits[k].first) edits[w - 1] = edits[k];
+            else edits[w++] = edits[k];
+        }
+        edits.resize(w);
+        for (size_t b = 0; b < edits.size();) {
+            size_t i = d->slot(edits[b].first), e = b;
+            while (e < edits.size() && d->slot(edits[e].first) == i) ++e;
+            rewrite(d, i, edits.data() + b, e - b);
+            b = e;
+        }
+        grow(d);
+    }
+    void assign(size_t key, const V& value) { update({{key, &value}}); }
+    void erase(size_t key) { update({{key, nullptr}}); }
+
+    // Drops the entries pred(key, value) selects. Returns how many.
+    template <typename P>
+    size_t erase_if(P&& pred) {
+        std::lock_guard lock(write_mutex);
+        Directory* d = dir.load(std::memory_order_relaxed);
+        size_t n = 0;
+        for (size_t i = 0; i < d->slots(); ++i) {
+            const Shard* s = d->shards[i].load(std::memory_order_relaxed);
+            if (!s) continue;
+            std::vector<Entry> keep;
+            for (const Entry& e : s->entries)
+                if (!pred(e.key, e.value)) keep.push_back(e);
+            if (keep.size() == s->entries.size()) continue;
+            n += s->entries.size() - keep.size();
+            publish(d, i, keep.empty() ? nullptr : new Shard{std::move(keep)});
+        }
+        count.fetch_sub(n, std::memory_order_relaxed);
+        return n;
+    }
+
+    // fn(key, value) over the current entries. Caller holds an epoch guard.
+    template <typename F>
+    void for_each(F&& fn) const {
+        const Directory* d = dir.load(std::memory_order_acquire);
+        for (size_t i = 0; i < d->slots(); ++i)
+            if (const Shard* s = d->shards[i].load(std::memory_order_acquire))
+                for (const Entry& e : s->entries) fn(e.key, e.value);
+    }
+
+    size_t size() const { return count.load(std::memory_order_relaxed); }
+    // Heap footprint: directory plus live shards.
+    size_t bytes() const {
+        auto guard = EpochManager::global().pin();
+        const Directory* d = dir.load(std::memory_order_acquire);
+        size_t n = sizeof(*this) + sizeof(Directory) + d->slots() * sizeof(std::atomic<Shard*>);
+        for (size_t i = 0; i < d->slots(); ++i)
+            if (const Shard* s = d->shards[i].load(std::memory_order_acquire))
+                n += sizeof(Shard) + s->entries.capacity() * sizeof(Entry);
+        return n;
+    }
+};
+
+// One observer's view of the graph: only the entity states and reference statuses that
+// differ for this observer are stored; every other read falls through to the shared
+// pool. Reads are lock-free and may run on any number of threads alongside writers.
+// Base values are read from the newest committed version, never from a writer's
+// in-progress fields.
+class ObserverOverlay {
+    struct EntityOverride {
+        OntState state;
+        size_t layer;
+    };
+    struct ReferenceOverride {
+        ReferenceVersion version;
+        size_t layer;
+    };
+
+    MemoryPool& pool;
+    Symbol observer;
+    CowMap<EntityOverride> entities;
+    CowMap<ReferenceOverride> references;
+
+    static const OntState* base_state(const Entity* e) {
+        const auto* v = e->history.latest();
+        return v ? &v->value : nullptr;
+    }
+    static const ReferenceVersion* base_version(const ReferenceObject* r) {
+        const auto* v = r->history.latest();
+        return v ? &v->value : nullptr;
+    }
+
+public:
+    ObserverOverlay(MemoryPool& p, Symbol name) : pool(p), observer(name) {}
+    ObserverOverlay(MemoryPool& p, std::string_view name) : ObserverOverlay(p, SymbolTable::global().intern(name)) {}
+
+    Symbol name() const { return observer; }
+    std::string_view name_str() const { return SymbolTable::global().str(observer); }
+
+    // State of eid as this observer sees it; false for unknown or stale ids.
+    // overridden (optional) tells whether the value came from the overlay.
+    bool entity_state(size_t eid, OntState& out, bool* overridden = nullptr) const {
+        auto guard = EpochManager::global().pin();
+        const Entity* e = pool.get_entity(eid);
+        if (!e) return false;
+        const EntityOverride* o = entities.find(eid);
+        const OntState* base = o ? nullptr : base_state(e);
+        if (!o && !base) return false;
+        out = o ? o->state : *base;
+        if (overridden) *overridden = o != nullptr;
+        return true;
+    }
+
+    bool reference_status(size_t rid, RefIntegrityStatus& out, CandidateSet* candidates = nullptr,
+                          bool* overridden = nullptr) const {
+        auto guard = EpochManager::global().pin();
+        const ReferenceObject* r = pool.get_reference(rid);
+        if (!r) return false;
+        const ReferenceOverride* o = references.find(rid);
+        const ReferenceVersion* v = o ? &o->version : base_version(r);
+        if (!v) return false;
+        out = v->status;
+        if (candidates) *candidates = v->candidates;
+        if (overridden) *overridden = o != nullptr;
+        return true;
+    }
+
+    // Direct overrides. A value equal to the base drops the override instead.
+    void set_entity_state(size_t eid, OntState s, size_t layer) {
+        apply_state_changes({{eid, s, layer, {}}}, false);
+    }
+    void set_reference_status(size_t rid, RefIntegrityStatus s, size_t layer, const CandidateSet& candidates = {}) {
+        auto guard = EpochManager::global().pin();
+        const ReferenceObject* r = pool.get_reference(rid);
+        const ReferenceVersion* base = r ? base_version(r) : nullptr;
+        if (!base) return;
+        ReferenceOverride o{{s, candidates}, layer};
+        references.update({{rid, o.version == *base ? nullptr : &o}});
+    }
+    void revert_entity(size_t eid) { entities.erase(eid); }
+    void revert_reference(size_t rid) { references.erase(rid); }
+
+    // The observer-local counterpart of ReferentialIntegrityEngine::apply_state_changes:
+    // each entity takes its new state for this observer only and, when revalidate is set,
+    // its incoming references are classified against it. The shared graph is not touched.
+    // Only values that differ from the base are kept, so an observer that agrees with
+    // the graph again costs nothing: where its state equals the base state, the incoming
+    // references keep their base status too (which may come from a cascade or a split
+    // resolution, not from the target alone). Pass the engine's integrity_policy() if it
+    // is not the default.
+    void apply_state_changes(const std::vector<StateChange>& changes, bool revalidate = true,
+                             const IntegrityPolicy& rules = default_policy()) {
+        std::unordered_map<size_t, size_t> last;
+        last.reserve(changes.size());
+        for (size_t i = 0; i < changes.size(); ++i) last[changes[i].entityId] = i;
+        std::vector<EntityOverride> evals;
+        std::vector<ReferenceOverride> rvals;
+        std::vector<std::pair<size_t, size_t>> eedits, redits; // (id, value index or SIZE_MAX)
+        evals.reserve(last.size());
+        auto guard = EpochManager::global().pin();
+        std::vector<ReferenceObject*> incoming;
+        for (size_t i = 0; i < changes.size(); ++i) {
+            const StateChange& c = changes[i];
+            if (last[c.entityId] != i) continue;
+            const Entity* e = pool.get_entity(c.entityId);
+            const OntState* base = e ? base_state(e) : nullptr;
+            if (!base) continue;
+            if (c.newState == *base) {
+                eedits.push_back({c.entityId, SIZE_MAX});
+            } else {
+                eedits.push_back({c.entityId, evals.size()});
+                evals.push_back({c.newState, c.layer});
+            }
+            if (!revalidate) continue;
+            const bool agrees = c.newState == *base;
+            CandidateSet split = c.newState == OntState::Split ? CandidateSet::of(c.splitIds) : CandidateSet();
+            pool.visit_incoming(&c.entityId, 1, [&](size_t, Entity*, const std::vector<ReferenceObject*>& refs) {
+                for (const ReferenceObject* r : refs) {
+                    const ReferenceVersion* rb = base_version(r);
+                    if (!rb) continue;
+                    if (agrees) {
+                        redits.push_back({r->id, SIZE_MAX});
+                        continue;
+                    }
+                    ReferenceVersion v{classify_status(r->targetStateAtCreation, c.newState, rules), split};
+                    if (v == *rb) {
+                        redits.push_back({r->id, SIZE_MAX});
+                    } else {
+                        redits.push_back({r->id, rvals.size()});
+                        rvals.push_back({v, c.layer});
+                    }
+                }
+            });
+        }
+        // Values are addressed once the vectors stop growing.
+        auto resolve = [](const auto& edits, const auto& vals) {
+            std::vector<std::pair<size_t, const typename std::decay_t<decltype(vals)>::value_type*>> out;
+            out.reserve(edits.size());
+            for (const auto& [id, k] : edits) out.push_back({id, k == SIZE_MAX ? nullptr : &vals[k]});
+            return out;
+        };
+        entities.update(resolve(eedits, evals));
+        references.update(resolve(redits, rvals));
+    }
+
+    // Drops overrides that now equal the base (the graph caught up with the observer)
+    // or whose object is gone. Returns how many.
+    size_t prune() {
+        auto guard = EpochManager::global().pin();
+        size_t n = entities.erase_if([&](size_t eid, const EntityOverride& o) {
+            const Entity* e = pool.get_entity(eid);
+            const OntState* base = e ? base_state(e) : nullptr;
+            return !base || *base == o.state;
+        });
+        return n + references.erase_if([&](size_t rid, const ReferenceOverride& o) {
+            const ReferenceObject* r = pool.get_reference(rid);
+            const ReferenceVersion* base = r ? base_version(r) : nullptr;
+            return !base || *base == o.version;
+        });
+    }
+
+    // fn(eid, state, layer) / fn(rid, status, candidates, layer) over the overrides only.
+    template <typename F>
+    void for_each_entity_override(F&& fn) const {
+        auto guard = EpochManager::global().pin();
+        entities.for_each([&](size_t eid, const EntityOverride& o) { fn(eid, o.state, o.layer); });
+    }
+    template <typename F>
+    void for_each_reference_override(F&& fn) const {
+        auto guard = EpochManager::global().pin();
+        references.for_each([&](size_t rid, const ReferenceOverride& o) {
+            fn(rid, o.version.status, o.version.candidates, o.layer);
+        });
+    }
+
+    // Divergence from the shared graph, in entries and heap bytes.
+    size_t entity_overrides() const { return entities.size(); }
+    size_t reference_overrides() const { return references.size(); }
+    size_t bytes() const { return sizeof(*this) + entities.bytes() + references.bytes(); }
+};
+
+// Observers by name. Overlays are created on first use and live as long as the
+// registry; lookups of existing observers take a shared lock only.
+class ObserverRegistry {
+    MemoryPool& pool;
+    mutable std::shared_mutex mutex;
+    std::unordered_map<Symbol, std::unique_ptr<ObserverOverlay>> overlays;
+
+public:
+    explicit ObserverRegistry(MemoryPool& p) : pool(p) {}
+
+    ObserverOverlay& observer(std::string_view name) {
+        Symbol s = SymbolTable::global().intern(name);
+        {
+            std::shared_lock lock(mutex);
+            auto it = overlays.find(s);
+            if (it != overlays.end()) return *it->second;
+        }
+        std::unique_lock lock(mutex);
+        auto& slot = overlays[s];
+        if (!slot) slot = std::make_unique<ObserverOverlay>(pool, s);
+        return *slot;
+    }
+    // nullptr if the observer has no overlay yet (it sees the shared graph).
+    ObserverOverlay* find(std::string_view name) const {
+        Symbol s = SymbolTable::global().find(name);
+        if (!s) return nullptr;
+        std::shared_lock lock(mutex);
+        auto it = overlays.find(s);
+        return it == overlays.end() ? nullptr : it->second.get();
+    }
+    template <typename F>
+    void for_each(F&& fn) const {
+        std::shared_lock lock(mutex);
+        for (const auto& [s, o] : overlays) fn(*o);
+    }
+    size_t size() const {
+        std::shared_lock lock(mutex);
+        return overlays.size();
+    }
+    // prune() on every overlay; returns the overrides dropped.
+    size_t prune_all() {
+        size_t n = 0;
+        for_each([&](ObserverOverlay& o) { n += o.prune(); });
+        return n;
+    }
+    size_t bytes() const {
+        size_t n = 0;
+        for_each([&](const ObserverOverlay& o) { n += o.bytes(); });
+        return n;
+    }
+};
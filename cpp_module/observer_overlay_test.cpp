@@ -0,0 +1,51 @@
+// Observer Overlay Test
+// An observer that agrees with the graph on an entity must see the base status of its
+// incoming references, including statuses a cascade set
+// Author: 1proprogrammerchant
+// C++17+ required
+// Build: g++ -std=c++17 -O2 -pthread observer_overlay_test.cpp -o observer_overlay_test && ./observer_overlay_test
+// Output: one line per check; exit status 1 if any failed.
+#include <cstdio>
+#include "observer_overlay.hpp"
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    std::printf("%s %s\n", ok ? "PASS" : "FAIL", what);
+    failures += !ok;
+}
+
+// The room collapses at layer 2 and the cascade invalidates "the voice says the man".
+static void cascaded_base() {
+    MemoryPool pool;
+    ReferentialIntegrityEngine rie(pool);
+    size_t room = pool.create_entity("the room", {"place"}, OntState::Defined, 1)->id;
+    size_t man = pool.create_entity("the man", {"human"}, OntState::Defined, 1)->id;
+    size_t voice = pool.create_entity("the voice", {"voice"}, OntState::Defined, 1)->id;
+    size_t in_room = pool.create_reference(man, room, OntState::Defined, 1)->id;
+    size_t says = pool.create_reference(voice, man, OntState::Defined, 1)->id;
+    rie.apply_state_changes({{room, OntState::Collapsed, 2, {}}});
+    rie.propagate_integrity(room, OntState::Collapsed, 2);
+    pool.commit_layer(2);
+
+    ObserverOverlay witness(pool, "witness");
+    RefIntegrityStatus st;
+    bool overridden = true;
+    witness.apply_state_changes({{man, OntState::Defined, 3, {}}});
+    check(witness.reference_overrides() == 0, "agrees: no reference override");
+    check(witness.reference_status(says, st, nullptr, &overridden) && st == RefIntegrityStatus::Invalidated && !overridden,
+          "agrees: cascaded base status kept");
+
+    witness.apply_state_changes({{room, OntState::Defined, 3, {}}});
+    check(witness.reference_status(in_room, st, nullptr, &overridden) && st == RefIntegrityStatus::Valid && overridden,
+          "differs: incoming reference reclassified for the observer");
+    witness.apply_state_changes({{room, OntState::Collapsed, 4, {}}});
+    check(witness.entity_overrides() == 0 && witness.reference_overrides() == 0, "agrees again: overrides dropped");
+    check(witness.reference_status(in_room, st) && st == RefIntegrityStatus::Invalidated, "agrees again: base status");
+}
+
+int main() {
+    cascaded_base();
+    std::printf("%s\n", failures ? "FAILED" : "all checks passed");
+    return failures ? 1 : 0;
+}
@@ -2,161 +2,7 @@
 // Plane 1 & 2: Ontological Logic + Referential Integrity Plane
 // Author: 1proprogrammerchant
 // C++17+ required
-#include <iostream>
-#include <vector>
-#include <string>
-#include <unordered_map>
-#include <unordered_set>
-#include <memory>
-#include <atomic>
-#include <mutex>
-#include <shared_mutex>
-#include <cassert>
-
-constexpr size_t MAX_ENTITIES = 10000;
-constexpr size_t MAX_REFERENCES = 100000;
-
-// Ontological states
-enum class OntState {
-    Undefined, Defined, Referenced, Reinterpreted, Contradicted, Split, Merged, Abstracted, ObserverRelative, Collapsed
-};
-
-// Reference integrity status
-enum class RefIntegrityStatus {
-    Valid, IdentityChanged, IdentitySplit, IdentityMerged, Invalidated, Unresolved, ObserverRelative
-};
-
-// Forward declaration
-struct Entity;
-
-// Reference object
-struct ReferenceObject {
-    size_t id; // unique reference id
-    size_t sourceEntityId;
-    size_t targetEntityId;
-    OntState targetStateAtCreation;
-    size_t creationLayer;
-    size_t lastValidatedLayer;
-    RefIntegrityStatus integrityStatus;
-    std::unordered_set<size_t> candidateTargets; // for split
-
-    ReferenceObject(size_t rid, size_t src, size_t tgt, OntState tgtState, size_t layer)
-        : id(rid), sourceEntityId(src), targetEntityId(tgt), targetStateAtCreation(tgtState),
-          creationLayer(layer), lastValidatedLayer(layer), integrityStatus(RefIntegrityStatus::Valid) {}
-
-    void print() const {
-        std::cout << "Reference[" << id << "]: " << sourceEntityId << " -> " << targetEntityId
-                  << " | Status: " << static_cast<int>(integrityStatus);
-        if (!candidateTargets.empty()) {
-            std::cout << " | Candidates: ";
-            for (auto c : candidateTargets) std::cout << c << " ";
-        }
-        std::cout << std::endl;
-    }
-};
-
-// Entity object
-struct Entity {
-    size_t id;
-    std::string name;
-    std::vector<std::string> attributes;
-    OntState state;
-    size_t temporal_layer;
-    std::vector<size_t> incomingReferences;
-    std::vector<size_t> outgoingReferences;
-
-    Entity(size_t eid, const std::string& n, const std::vector<std::string>& attr, OntState s, size_t layer)
-        : id(eid), name(n), attributes(attr), state(s), temporal_layer(layer) {}
-
-    void print() const {
-        std::cout << "Entity[" << id << "]: " << name << " | State: " << static_cast<int>(state)
-                  << " | Layer: " << temporal_layer << " | Attr: ";
-        for (const auto& a : attributes) std::cout << a << " ";
-        std::cout << std::endl;
-    }
-};
-
-// Memory pool for entities and references
-class MemoryPool {
-    std::vector<std::unique_ptr<Entity>> entities;
-    std::vector<std::unique_ptr<ReferenceObject>> references;
-    std::shared_mutex entity_mutex, ref_mutex;
-    std::atomic<size_t> entity_id_counter{1};
-    std::atomic<size_t> ref_id_counter{1};
-public:
-    Entity* create_entity(const std::string& name, const std::vector<std::string>& attr, OntState s, size_t layer) {
-        std::unique_lock lock(entity_mutex);
-        size_t eid = entity_id_counter++;
-        entities.emplace_back(std::make_unique<Entity>(eid, name, attr, s, layer));
-        return entities.back().get();
-    }
-    ReferenceObject* create_reference(size_t src, size_t tgt, OntState tgtState, size_t layer) {
-        std::unique_lock lock(ref_mutex);
-        size_t rid = ref_id_counter++;
-        references.emplace_back(std::make_unique<ReferenceObject>(rid, src, tgt, tgtState, layer));
-        return references.back().get();
-    }
-    Entity* get_entity(size_t eid) {
-        std::shared_lock lock(entity_mutex);
-        for (auto& e : entities) if (e->id == eid) return e.get();
-        return nullptr;
-    }
-    ReferenceObject* get_reference(size_t rid) {
-        std::shared_lock lock(ref_mutex);
-        for (auto& r : references) if (r->id == rid) return r.get();
-        return nullptr;
-    }
-    std::vector<Entity*> all_entities() {
-        std::shared_lock lock(entity_mutex);
-        std::vector<Entity*> out;
-        for (auto& e : entities) out.push_back(e.get());
-        return out;
-    }
-    std::vector<ReferenceObject*> all_references() {
-        std::shared_lock lock(ref_mutex);
-        std::vector<ReferenceObject*> out;
-        for (auto& r : references) out.push_back(r.get());
-        return out;
-    }
-    void leak_check() {
-        std::cout << "[LeakCheck] Entities: " << entities.size() << ", References: " << references.size() << std::endl;
-    }
-};
-
-// Referential Integrity Engine
-class ReferentialIntegrityEngine {
-    MemoryPool& pool;
-public:
-    ReferentialIntegrityEngine(MemoryPool& p) : pool(p) {}
-    // Validate all references to a changed entity
-    void validate_references(size_t changedEntityId, OntState newState, size_t newLayer, const std::vector<size_t>& splitIds = {}) {
-        for (auto* ref : pool.all_references()) {
-            if (ref->targetEntityId == changedEntityId) {
-                if (newState == OntState::Split) {
-                    ref->integrityStatus = RefIntegrityStatus::Unresolved;
-                    ref->candidateTargets.clear();
-                    for (auto id : splitIds) ref->candidateTargets.insert(id);
-                } else if (newState == OntState::Merged) {
-                    ref->integrityStatus = RefIntegrityStatus::IdentityMerged;
-                } else if (newState == OntState::ObserverRelative) {
-                    ref->integrityStatus = RefIntegrityStatus::ObserverRelative;
-                } else if (newState == OntState::Collapsed) {
-                    ref->integrityStatus = RefIntegrityStatus::Invalidated;
-                } else if (newState != ref->targetStateAtCreation) {
-                    ref->integrityStatus = RefIntegrityStatus::IdentityChanged;
-                } else {
-                    ref->integrityStatus = RefIntegrityStatus::Valid;
-                }
-                ref->lastValidatedLayer = newLayer;
-            }
-        }
-    }
-    // Propagate integrity to all incoming/outgoing references
-    void propagate_integrity(size_t entityId, OntState newState, size_t newLayer, const std::vector<size_t>& splitIds = {}) {
-        validate_references(entityId, newState, newLayer, splitIds);
-        // Could add outgoing propagation here if needed
-    }
-};
+#include "layer_snapshot.hpp"
 
 int main() {
     MemoryPool pool;
@@ -167,18 +13,23 @@ int main() {
     // Layer 1: E2 = "the voice", reference(E2 -> E1)
     Entity* E2 = pool.create_entity("the voice", {"voice"}, OntState::Defined, 1);
     ReferenceObject* refE2toE1 = pool.create_reference(E2->id, E1->id, E1->state, 1);
-    E2->outgoingReferences.push_back(refE2toE1->id);
-    E1->incomingReferences.push_back(refE2toE1->id);
     E2->print(); refE2toE1->print();
     // Layer 2: E1 splits into E1a and E1b
     Entity* E1a = pool.create_entity("the man (aspect A)", {"male", "human", "aspectA"}, OntState::Split, 2);
     Entity* E1b = pool.create_entity("the man (aspect B)", {"male", "human", "aspectB"}, OntState::Split, 2);
-    E1->state = OntState::Split;
-    E1->temporal_layer = 2;
-    rie.propagate_integrity(E1->id, OntState::Split, 2, {E1a->id, E1b->id});
+    rie.apply_state_change({E1->id, OntState::Split, 2, {E1a->id, E1b->id}});
+    pool.commit_layer(2);
     E1->print(); refE2toE1->print();
     // Layer 3: E2 denies being E1 (no merge, reference remains unresolved)
     E2->print(); refE2toE1->print();
+    // History: the graph as of layer 1, read while layer 2 stays committed
+    {
+        LayerSnapshot before(pool, 1);
+        OntState s;
+        RefIntegrityStatus st;
+        if (before.entity_state(E1->id, s) && before.reference_status(refE2toE1->id, st))
+            std::cout << "As of layer 1: E1 state " << static_cast<int>(s) << ", reference status " << static_cast<int>(st) << std::endl;
+    }
     // Output summary
     std::cout << "\nSummary:\n";
     std::cout << "reference(E2 -> E1) = ";
@@ -0,0 +1,713 @@
+// High-Performance Referential Integrity Engine (RIE)
+// Plane 1 & 2: Ontological Logic + Referential Integrity Plane
+// Author: 1proprogrammerchant
+// C++17+ required
+#pragma once
+#include <iostream>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <cassert>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include "slab_storage.hpp"
+#include "adjacency_list.hpp"
+#include "thread_pool.hpp"
+#include "candidate_groups.hpp"
+#include "integrity_policy.hpp"
+#include "reference_table.hpp"
+#include "rie_metrics.hpp"
+#include "symbol_table.hpp"
+#include "version_chain.hpp"
+
+constexpr size_t MAX_ENTITIES = 10000;
+constexpr size_t MAX_REFERENCES = 100000;
+
+// Forward declaration
+struct Entity;
+
+// A reference's versioned fields
+struct ReferenceVersion {
+    RefIntegrityStatus status;
+    CandidateSet candidates;
+    bool operator==(const ReferenceVersion& o) const { return status == o.status && candidates == o.candidates; }
+};
+
+// Reference object
+struct ReferenceObject {
+    size_t id; // unique reference id
+    size_t sourceEntityId;
+    size_t targetEntityId;
+    OntState targetStateAtCreation;
+    size_t creationLayer;
+    size_t lastValidatedLayer; // as of the last write here; MemoryPool::validated_layer has the latest
+    RefIntegrityStatus integrityStatus;
+    CandidateSet candidateTargets; // for split: inline or a shared interned group
+    VersionChain<ReferenceVersion> history; // status/candidates by validation layer
+
+    ReferenceObject(size_t rid, size_t src, size_t tgt, OntState tgtState, size_t layer)
+        : id(rid), sourceEntityId(src), targetEntityId(tgt), targetStateAtCreation(tgtState),
+          creationLayer(layer), lastValidatedLayer(layer), integrityStatus(RefIntegrityStatus::Valid) {
+        record_version();
+    }
+
+    // Appends the current status at lastValidatedLayer if it differs from the newest
+    // version. Returns true when it did, i.e. the status actually changed.
+    bool record_version() {
+        ReferenceVersion v{integrityStatus, candidateTargets};
+        const auto* head = history.latest();
+        if (head && head->value == v) return false;
+        history.push(v, lastValidatedLayer);
+        return true;
+    }
+
+    void print() const {
+        std::cout << "Reference[" << id << "]: " << sourceEntityId << " -> " << targetEntityId
+                  << " | Status: " << static_cast<int>(integrityStatus);
+        if (!candidateTargets.empty()) {
+            std::cout << " | Candidates: ";
+            for (auto c : candidateTargets) std::cout << c << " ";
+        }
+        std::cout << std::endl;
+    }
+};
+
+// Entity object
+// Name and attributes are interned: a symbol id and an attribute bitset.
+struct Entity {
+    size_t id;
+    Symbol name;
+    AttributeSet attributes;
+    OntState state;
+    size_t temporal_layer;
+    AdjacencyList incomingReferences; // lock-free append-only; see adjacency_list.hpp
+    AdjacencyList outgoingReferences;
+    VersionChain<OntState> history; // state by temporal layer
+
+    Entity(size_t eid, Symbol n, const AttributeSet& attr, OntState s, size_t layer)
+        : id(eid), name(n), attributes(attr), state(s), temporal_layer(layer) {
+        record_version();
+    }
+
+    // Appends the current state at temporal_layer if it differs from the newest version.
+    bool record_version() {
+        const auto* head = history.latest();
+        if (head && head->value == state) return false;
+        history.push(state, temporal_layer);
+        return true;
+    }
+
+    std::string_view name_str() const { return SymbolTable::global().str(name); }
+    bool has_attribute(std::string_view a) const {
+        bool ok;
+        AttributeQuery q = AttributeDictionary::global().lookup(std::initializer_list<std::string_view>{a}, ok);
+        return ok && attributes.contains_all(q);
+    }
+
+    void print() const {
+        std::cout << "Entity[" << id << "]: " << name_str() << " | State: " << static_cast<int>(state)
+                  << " | Layer: " << temporal_layer << " | Attr: ";
+        attributes.for_each(AttributeDictionary::global(), [](std::string_view a) { std::cout << a << " "; });
+        std::cout << std::endl;
+    }
+};
+
+constexpr size_t ANY_LAYER = SIZE_MAX;
+
+// Receives every pool mutation, in an order consistent with each object's history
+// (see change_journal.hpp). Called from writer threads; implementations must be thread-safe.
+struct MutationSink {
+    virtual ~MutationSink() = default;
+    virtual void entity_created(const Entity& e) = 0;
+    virtual void reference_created(const ReferenceObject& r) = 0;
+    virtual void entity_destroyed(size_t eid) = 0;
+    virtual void reference_destroyed(size_t rid) = 0;
+    virtual void entity_state_changed(const Entity& e) = 0;
+    virtual void reference_status_changed(const ReferenceObject& r) = 0;
+};
+
+// What one MemoryPool::reclaim pass did
+struct ReclaimStats {
+    size_t entities = 0, references = 0; // retired
+    size_t adjacency = 0;                // dead reference ids cleared from adjacency lists
+    size_t freed = 0;                    // retired objects destroyed, slots back on the free lists
+    size_t chunks = 0;                   // slab chunks released
+};
+
+// Memory pool for entities and references
+// Ids are generational slab handles: lookup is O(1) and stale ids return nullptr.
+// Creation, lookup, traversal and adjacency wiring are lock-free: each thread fills
+// its own slab chunks and readers never wait on writers.
+// Lifetime: a pointer from get_*, all_* or visit_incoming stays valid while its caller
+// holds an EpochManager guard (the engine and LayerSnapshot take one), even if reclaim()
+// retires the object meanwhile. Without a guard, only until the next reclaim().
+class MemoryPool {
+    Slab<Entity> entities{metrics::Lock::EntityFreeList};
+    Slab<ReferenceObject> references{metrics::Lock::ReferenceFreeList};
+    ReferenceTable columns; // hot reference fields, kept in step with the objects
+    std::atomic<size_t> committed{0};
+    std::mutex compact_mutex;
+    std::atomic<MutationSink*> sink{nullptr};
+
+    void wire(ReferenceObject* ref) {
+        if (Entity* s = entities.get(ref->sourceEntityId)) s->outgoingReferences.push_back(ref->id);
+        if (Entity* t = entities.get(ref->targetEntityId)) t->incomingReferences.push_back(ref->id);
+    }
+public:
+    ReaderHorizon readers; // layers held by open LayerSnapshots
+
+    // Mutations from now on are reported to s (nullptr detaches).
+    void attach_sink(MutationSink* s) { sink.store(s, std::memory_order_release); }
+    MutationSink* mutation_sink() const { return sink.load(std::memory_order_acquire); }
+
+    Entity* create_entity(const std::string& name, const std::vector<std::string>& attr, OntState s, size_t layer) {
+        return create_entity(SymbolTable::global().intern(name), AttributeDictionary::global().encode(attr), s, layer);
+    }
+    // The sink sees the entity before any other thread can.
+    Entity* create_entity(Symbol name, const AttributeSet& attr, OntState s, size_t layer) {
+        metrics::Scope probe(metrics::Op::CreateEntity);
+        return entities.emplace_init([&](Entity* e) {
+            if (MutationSink* m = mutation_sink()) m->entity_created(*e);
+        }, name, attr, s, layer);
+    }
+    // Also wires the source's outgoing and the target's incoming adjacency.
+    ReferenceObject* create_reference(size_t src, size_t tgt, OntState tgtState, size_t layer) {
+        metrics::Scope probe(metrics::Op::CreateReference);
+        ReferenceObject* ref = references.emplace_init([&](ReferenceObject* r) {
+            columns.put(r->id, tgt, tgtState, r->integrityStatus, layer);
+            if (MutationSink* m = mutation_sink()) m->reference_created(*r);
+        }, src, tgt, tgtState, layer);
+        wire(ref);
+        return ref;
+    }
+    // Recreate an object under its original id (journal replay). nullptr if the id is taken.
+    // Not reported to the sink.
+    Entity* restore_entity(size_t eid, Symbol name, const AttributeSet& attr, OntState s, size_t layer) {
+        return entities.emplace_at(eid, name, attr, s, layer);
+    }
+    ReferenceObject* restore_reference(size_t rid, size_t src, size_t tgt, OntState tgtState, size_t layer) {
+        ReferenceObject* ref = references.emplace_at(rid, src, tgt, tgtState, layer);
+        if (ref) {
+            columns.put(rid, tgt, tgtState, ref->integrityStatus, layer);
+            wire(ref);
+        }
+        return ref;
+    }
+    Entity* get_entity(size_t eid) const {
+        metrics::Scope probe(metrics::Op::GetEntity);
+        return entities.get(eid);
+    }
+    ReferenceObject* get_reference(size_t rid) const {
+        metrics::Scope probe(metrics::Op::GetReference);
+        return references.get(rid);
+    }
+    // Frees the slot; the id goes stale. Callers must not hold pointers to the object.
+    bool destroy_entity(size_t eid) {
+        if (!entities.erase(eid)) return false;
+        if (MutationSink* m = mutation_sink()) m->entity_destroyed(eid);
+        return true;
+    }
+    bool destroy_reference(size_t rid) {
+        columns.erase(rid);
+        if (!references.erase(rid)) return false;
+        if (MutationSink* m = mutation_sink()) m->reference_destroyed(rid);
+        return true;
+    }
+    // As destroy_*, but safe while other threads use the object: the id goes stale at
+    // once and the memory is reused after every guard that could see it has ended.
+    bool retire_entity(size_t eid) {
+        if (!entities.retire(eid)) return false;
+        if (MutationSink* m = mutation_sink()) m->entity_destroyed(eid);
+        return true;
+    }
+    bool retire_reference(size_t rid) {
+        columns.erase(rid);
+        if (!references.retire(rid)) return false;
+        if (MutationSink* m = mutation_sink()) m->reference_destroyed(rid);
+        return true;
+    }
+    // Calls fn(k, entity, refs) for each eids[k] with the live references targeting it.
+    // Unknown or stale ids are skipped.
+    template <typename F>
+    void visit_incoming(const size_t* eids, size_t n, F&& fn) {
+        std::vector<ReferenceObject*> incoming;
+        for (size_t k = 0; k < n; ++k) {
+            Entity* e = entities.get(eids[k]);
+            if (!e) continue;
+            incoming.clear();
+            e->incomingReferences.for_each([&](size_t rid) {
+                ReferenceObject* r = references.get(rid);
+                if (r && r->targetEntityId == e->id) incoming.push_back(r);
+            });
+            fn(k, e, incoming);
+        }
+    }
+    template <typename F>
+    void visit_incoming(const std::vector<size_t>& eids, F&& fn) {
+        visit_incoming(eids.data(), eids.size(), std::forward<F>(fn));
+    }
+    // As visit_incoming, but passes the ids on each incoming list without looking the
+    // references up; some may be stale (ReferenceTable::validate skips those).
+    template <typename F>
+    void visit_incoming_ids(const size_t* eids, size_t n, F&& fn) {
+        std::vector<size_t> incoming;
+        for (size_t k = 0; k < n; ++k) {
+            Entity* e = entities.get(eids[k]);
+            if (!e) continue;
+            incoming.clear();
+            e->incomingReferences.for_each([&](size_t rid) { incoming.push_back(rid); });
+            fn(k, e, incoming);
+        }
+    }
+    template <typename F>
+    void visit_incoming_ids(const std::vector<size_t>& eids, F&& fn) {
+        visit_incoming_ids(eids.data(), eids.size(), std::forward<F>(fn));
+    }
+    // The hot columns of every live reference (see reference_table.hpp)
+    ReferenceTable& reference_columns() { return columns; }
+    size_t validated_layer(size_t rid) const { return columns.last_layer(rid); }
+    // Copies r's status and lastValidatedLayer into the columns. Writers outside the
+    // engine (journal replay, snapshot and wire loads, SplitResolver) call it after theirs.
+    void sync_status(const ReferenceObject& r) { columns.set(r.id, r.integrityStatus, r.lastValidatedLayer); }
+    // Upper bounds on slot indices, for dense per-object scratch tables
+    size_t entity_capacity() const { return entities.capacity(); }
+    size_t reference_capacity() const { return references.capacity(); }
+    // Entities carrying all of attrs (in layer, unless ANY_LAYER): a bitset test per entity.
+    std::vector<Entity*> entities_with(const std::vector<std::string>& attrs, size_t layer = ANY_LAYER) {
+        bool ok;
+        AttributeQuery q = AttributeDictionary::global().lookup(attrs, ok);
+        std::vector<Entity*> out;
+        if (!ok) return out;
+        entities.for_each([&](Entity* e) {
+            if ((layer == ANY_LAYER || e->temporal_layer == layer) && e->attributes.contains_all(q)) out.push_back(e);
+        });
+        return out;
+    }
+    std::vector<Entity*> all_entities() {
+        std::vector<Entity*> out;
+        out.reserve(entities.size());
+        entities.for_each([&](Entity* e) { out.push_back(e); });
+        return out;
+    }
+    // State, id and state layer of every live entity by slot; other slots hold 0.
+    void entity_states(std::vector<uint8_t>& states, std::vector<size_t>& ids, std::vector<size_t>& layers) {
+        states.assign(entities.capacity(), 0);
+        ids.assign(entities.capacity(), 0);
+        layers.assign(entities.capacity(), 0);
+        entities.for_each([&](Entity* e) {
+            states[handle_index(e->id)] = static_cast<uint8_t>(e->state);
+            ids[handle_index(e->id)] = e->id;
+            layers[handle_index(e->id)] = e->temporal_layer;
+        });
+    }
+    std::vector<ReferenceObject*> all_references() {
+        std::vector<ReferenceObject*> out;
+        out.reserve(references.size());
+        references.for_each([&](ReferenceObject* r) { out.push_back(r); });
+        return out;
+    }
+    // Newest layer whose writes are complete; "latest" snapshots read as of it.
+    // The engine never commits: whoever makes a layer's last write (creations, state
+    // changes, propagation, resolution) commits it once, after that write.
+    size_t committed_layer() const { return committed.load(std::memory_order_acquire); }
+    void commit_layer(size_t layer) {
+        size_t cur = committed.load(std::memory_order_relaxed);
+        while (cur < layer && !committed.compare_exchange_weak(cur, layer, std::memory_order_acq_rel)) {}
+    }
+    // Drops history no snapshot at or after horizon can read, stopping at the oldest
+    // open snapshot. Dropped versions are freed once in-flight readers leave their epoch.
+    // Returns the number of versions retired.
+    size_t compact_history(size_t horizon) {
+        metrics::TimedLock guard(compact_mutex, metrics::Lock::Compaction);
+        size_t floor = readers.advance(std::min(horizon, committed_layer()));
+        size_t n = 0;
+        entities.for_each([&](Entity* e) { n += e->history.trim(floor); });
+        references.for_each([&](ReferenceObject* r) { n += r->history.trim(floor); });
+        EpochManager::global().collect();
+        return n;
+    }
+    // Retires what no read at horizon or later needs (the floor of compact_history):
+    // entities Collapsed, and references Invalidated, at or below it, and references
+    // whose source or target is gone. Collapsed and Invalidated are terminal from then
+    // on: the ids read as unknown. Then clears dead ids from the adjacency lists,
+    // destroys retired objects no guard can still reach and releases emptied chunks.
+    ReclaimStats reclaim(size_t horizon) {
+        metrics::TimedLock guard(compact_mutex, metrics::Lock::Compaction);
+        size_t floor = readers.advance(std::min(horizon, committed_layer()));
+        ReclaimStats st;
+        {
+            auto epoch = EpochManager::global().pin();
+            std::vector<size_t> dead;
+            entities.for_each([&](Entity* e) {
+                const auto* v = e->history.latest();
+                if (v && v->value == OntState::Collapsed && v->layer <= floor) dead.push_back(e->id);
+            });
+            for (size_t eid : dead) st.entities += retire_entity(eid);
+            dead.clear();
+            auto gone = [&](size_t eid) { return !is_external(eid) && !entities.get(eid); };
+            references.for_each([&](ReferenceObject* r) {
+                const auto* v = r->history.latest();
+                if ((v && v->value.status == RefIntegrityStatus::Invalidated && v->layer <= floor) ||
+                    gone(r->sourceEntityId) || gone(r->targetEntityId))
+                    dead.push_back(r->id);
+            });
+            for (size_t rid : dead) st.references += retire_reference(rid);
+            auto stale = [&](size_t rid) { return !references.get(rid); };
+            entities.for_each([&](Entity* e) {
+                st.adjacency += e->incomingReferences.erase_if(stale) + e->outgoingReferences.erase_if(stale);
+            });
+        }
+        // The epoch moves at most one step per collect; with no reader pinned, two free
+        // what this pass retired (and the candidate groups its versions released).
+        for (int i = 0; i < 2; ++i) {
+            EpochManager::global().collect();
+            st.freed += entities.reclaim() + references.reclaim();
+            CandidateGroups::global().reclaim();
+        }
+        st.chunks = entities.release_chunks() + references.release_chunks();
+        return st;
+    }
+    SlabUsage entity_usage() const { return entities.usage(); }
+    SlabUsage reference_usage() const { return references.usage(); }
+    // Live objects, retired ones still waiting for readers, free slots and slab memory,
+    // plus dead objects a reclaim() would retire.
+    void leak_check() {
+        SlabUsage e = entities.usage(), r = references.usage();
+        size_t collapsed = 0, invalidated = 0;
+        entities.for_each([&](Entity* x) {
+            const auto* v = x->history.latest();
+            collapsed += v && v->value == OntState::Collapsed;
+        });
+        references.for_each([&](ReferenceObject* x) {
+            const auto* v = x->history.latest();
+            invalidated += v && v->value.status == RefIntegrityStatus::Invalidated;
+        });
+        std::cout << "[LeakCheck] Entities: " << e.live << ", References: " << r.live << std::endl;
+        std::cout << "[LeakCheck] Retired: " << e.retired << " / " << r.retired << " | Free slots: " << e.free << " / " << r.free
+                  << " | Chunks: " << e.chunks << " / " << r.chunks << " (" << (e.bytes + r.bytes) / 1024 << " KiB)"
+                  << " | Unreclaimed Collapsed: " << collapsed << ", Invalidated: " << invalidated << std::endl;
+    }
+};
+
+// A single entity state transition
+struct StateChange {
+    size_t entityId;
+    OntState newState;
+    size_t layer;
+    std::vector<size_t> splitIds;
+    size_t mergedInto = 0; // Merged: the entity it merged into (0: unknown)
+};
+
+// Receives the identity events of apply_state_changes: a merge with the entity it merged
+// into, and a split with its aspects (see identity_union_find.hpp).
+struct IdentityEvents {
+    virtual ~IdentityEvents() = default;
+    virtual void entity_merged(size_t eid, size_t into, size_t layer) = 0;
+    virtual void entity_split(size_t eid, const std::vector<size_t>& aspects, size_t layer) = 0;
+};
+
+// Bounds for transitive propagation
+struct PropagationLimits {
+    size_t max_depth = SIZE_MAX;     // cascade hops beyond the direct references
+    size_t min_creation_layer = 0;   // references created before this layer are left alone
+};
+
+struct PropagationStats {
+    size_t references_touched = 0;
+    size_t depth_reached = 0;
+};
+
+// Receives an external entity a cascade reached, and the status it carries there
+using ExitFn = std::function<void(size_t, RefIntegrityStatus)>;
+
+// Referential Integrity Engine
+// Every entry point holds an epoch guard, so a concurrent MemoryPool::reclaim never
+// frees an object under a propagation. No entry point commits its layer: a layer can
+// take several calls (apply_state_changes, then propagate_integrity), and the caller
+// commits it with MemoryPool::commit_layer after the last one.
+class ReferentialIntegrityEngine {
+    MemoryPool& pool;
+    WorkStealingPool* workers;
+    std::atomic<const IntegrityPolicy*> rules{&default_policy()};
+    std::atomic<IdentityEvents*> identities{nullptr};
+    std::mutex propagation_mutex; // serializes status writers; guards the cascade scratch tables
+    std::unique_ptr<std::atomic<uint8_t>[]> ref_rank, entity_rank;
+    size_t ref_rank_size = 0, entity_rank_size = 0;
+
+    // Classifies the references in rids (one entity's incoming list) on the pool's hot
+    // columns. Only those whose status changes are written back; on a split, all of them
+    // (split is the candidate set built once per state change, not once per reference).
+    // touched(rid, status) sees every reference. Returns how many there were.
+    template <typename F>
+    size_t classify(const std::vector<size_t>& rids, OntState newState, size_t newLayer, const CandidateSet& split, F&& touched) {
+        const bool splitting = newState == OntState::Split;
+        thread_local std::vector<size_t> changed;
+        thread_local std::vector<RefIntegrityStatus> status;
+        thread_local std::vector<ReferenceObject*> refs;
+        changed.clear();
+        status.clear();
+        size_t n = pool.reference_columns().validate(rids, newState, newLayer, *rules.load(std::memory_order_relaxed),
+                                                     [&](size_t rid, RefIntegrityStatus old, RefIntegrityStatus now) {
+            if (now != old || splitting) {
+                changed.push_back(rid);
+                status.push_back(now);
+            }
+            touched(rid, now);
+        });
+        // Look the objects up in one pass, then write them
+        refs.clear();
+        for (size_t rid : changed) refs.push_back(pool.get_reference(rid));
+        for (size_t i = 0; i < refs.size(); ++i)
+            if (ReferenceObject* ref = refs[i]) {
+                ref->integrityStatus = status[i];
+                if (splitting) ref->candidateTargets = split;
+                ref->lastValidatedLayer = newLayer;
+                record(ref);
+            }
+        return n;
+    }
+    size_t classify(const std::vector<size_t>& rids, OntState newState, size_t newLayer, const CandidateSet& split) {
+        return classify(rids, newState, newLayer, split, [](size_t, RefIntegrityStatus) {});
+    }
+    // New version, and a journal record when the status actually changed
+    void record(ReferenceObject* ref) {
+        if (ref->record_version())
+            if (MutationSink* m = pool.mutation_sink()) m->reference_status_changed(*ref);
+    }
+    static CandidateSet split_set(OntState newState, const std::vector<size_t>& splitIds) {
+        return newState == OntState::Split ? CandidateSet::of(splitIds) : CandidateSet();
+    }
+
+    // Cascade severity: only Unresolved and Invalidated spread past the direct references.
+    static uint8_t cascade_rank(RefIntegrityStatus s) {
+        return s == RefIntegrityStatus::Invalidated ? 2 : s == RefIntegrityStatus::Unresolved ? 1 : 0;
+    }
+    static RefIntegrityStatus rank_status(uint8_t r) {
+        return r == 2 ? RefIntegrityStatus::Invalidated : RefIntegrityStatus::Unresolved;
+    }
+    static void raise(std::atomic<uint8_t>& slot, uint8_t r, uint8_t& old) {
+        old = slot.load(std::memory_order_relaxed);
+        while (old < r && !slot.compare_exchange_weak(old, r, std::memory_order_relaxed)) {}
+    }
+    static void ensure_scratch(std::unique_ptr<std::atomic<uint8_t>[]>& table, size_t& size, size_t needed) {
+        if (needed <= size) return;
+        table.reset(new std::atomic<uint8_t>[needed]);
+        for (size_t i = 0; i < needed; ++i) table[i].store(0, std::memory_order_relaxed);
+        size = needed;
+    }
+    // Frontier levels of propagate_integrity; external sources are collected in out.
+    void cascade(std::vector<size_t>& frontier, std::vector<uint8_t>& frontier_rank, size_t newLayer,
+                 const PropagationLimits& limits, PropagationStats& stats, std::vector<std::pair<size_t, uint8_t>>& out) {
+        ensure_scratch(ref_rank, ref_rank_size, pool.reference_capacity());
+        ensure_scratch(entity_rank, entity_rank_size, pool.entity_capacity());
+        std::mutex merge_mutex;
+        while (!frontier.empty() && stats.depth_reached < limits.max_depth) {
+            ++stats.depth_reached;
+            // Gather: raise the rank of every reference into a frontier entity.
+            std::vector<ReferenceObject*> touched;
+            parallel_for(workers, frontier.size(), 64, [&](size_t b, size_t e) {
+                std::vector<ReferenceObject*> local;
+                pool.visit_incoming(frontier.data() + b, e - b, [&](size_t k, Entity*, const std::vector<ReferenceObject*>& refs) {
+                    uint8_t r = frontier_rank[b + k];
+                    for (auto* ref : refs) {
+                        if (ref->creationLayer > newLayer || ref->creationLayer < limits.min_creation_layer) continue;
+                        if (pool.validated_layer(ref->id) > newLayer || cascade_rank(ref->integrityStatus) >= r) continue;
+                        if (handle_index(ref->id) >= ref_rank_size) continue; // created mid-cascade
+                        uint8_t old;
+                        raise(ref_rank[handle_index(ref->id)], r, old);
+                        if (old == 0) local.push_back(ref);
+                    }
+                });
+                std::lock_guard lock(merge_mutex);
+                touched.insert(touched.end(), local.begin(), local.end());
+            });
+            // Apply: commit the merged ranks and collect the next frontier.
+            std::vector<size_t> next;
+            parallel_for(workers, touched.size(), 256, [&](size_t b, size_t e) {
+                std::vector<size_t> local;
+                std::vector<std::pair<size_t, uint8_t>> exits;
+                for (size_t i = b; i < e; ++i) {
+                    ReferenceObject* ref = touched[i];
+                    uint8_t r = ref_rank[handle_index(ref->id)].exchange(0, std::memory_order_relaxed);
+                    ref->integrityStatus = rank_status(r);
+                    ref->lastValidatedLayer = newLayer;
+                    pool.sync_status(*ref);
+                    record(ref);
+                    if (is_external(ref->sourceEntityId)) {
+                        exits.emplace_back(ref->sourceEntityId, r);
+                        continue;
+                    }
+                    if (handle_index(ref->sourceEntityId) >= entity_rank_size) continue;
+                    uint8_t old;
+                    raise(entity_rank[handle_index(ref->sourceEntityId)], r, old);
+                    if (old == 0) local.push_back(ref->sourceEntityId);
+                }
+                std::lock_guard lock(merge_mutex);
+                next.insert(next.end(), local.begin(), local.end());
+                out.insert(out.end(), exits.begin(), exits.end());
+            });
+            stats.references_touched += touched.size();
+            std::sort(next.begin(), next.end());
+            frontier.swap(next);
+            frontier_rank.resize(frontier.size());
+            for (size_t i = 0; i < frontier.size(); ++i)
+                frontier_rank[i] = entity_rank[handle_index(frontier[i])].exchange(0, std::memory_order_relaxed);
+        }
+    }
+    void finish(const PropagationStats& stats, std::vector<std::pair<size_t, uint8_t>>& out, const ExitFn& exits) {
+        metrics::refs_touched(stats.references_touched);
+        metrics::propagation_depth(stats.depth_reached);
+        if (!exits || out.empty()) return;
+        std::sort(out.begin(), out.end(), [](const auto& a, const auto& b) { return a.first != b.first ? a.first < b.first : a.second > b.second; });
+        for (size_t i = 0; i < out.size(); ++i)
+            if (i == 0 || out[i].first != out[i - 1].first) exits(out[i].first, rank_status(out[i].second));
+    }
+public:
+    // Without a worker pool, propagation runs on the calling thread.
+    ReferentialIntegrityEngine(MemoryPool& p, WorkStealingPool* w = nullptr) : pool(p), workers(w) {}
+    MemoryPool& memory_pool() const { return pool; }
+    // Held by every status writer; writers outside the engine (SplitResolver) take it too.
+    std::mutex& status_mutex() { return propagation_mutex; }
+    // Rules for classifying references from now on (see integrity_policy.hpp). The
+    // policy must outlive the engine; the compiled policies in namespace policy do.
+    void set_integrity_policy(const IntegrityPolicy& p) { rules.store(&p, std::memory_order_relaxed); }
+    const IntegrityPolicy& integrity_policy() const { return *rules.load(std::memory_order_relaxed); }
+    // Merges and splits applied from now on are reported to ev (nullptr detaches).
+    void attach_identities(IdentityEvents* ev) { identities.store(ev, std::memory_order_release); }
+    // Validate all references to a changed entity (touches only its incoming references)
+    void validate_references(size_t changedEntityId, OntState newState, size_t newLayer, const std::vector<size_t>& splitIds = {}) {
+        metrics::Scope probe(metrics::Op::ValidateReferences);
+        metrics::TimedLock guard(propagation_mutex, metrics::Lock::Propagation);
+        auto epoch = EpochManager::global().pin();
+        CandidateSet split = split_set(newState, splitIds);
+        size_t touched = 0;
+        pool.visit_incoming_ids({changedEntityId}, [&](size_t, Entity*, const std::vector<size_t>& rids) {
+            touched += classify(rids, newState, newLayer, split);
+        });
+        metrics::refs_touched(touched);
+    }
+    // Reclassifies, in one sweep over the pool's hot columns, every reference last
+    // validated before its target's current state (a state set outside the engine, or
+    // a target that is gone: counts as Collapsed). References validated since keep
+    // their status, so cascades and split resolutions stand. Targets that are Split or
+    // external are left alone, and the sweep does not cascade. A reference whose
+    // status changed is written back with its candidates cleared. Returns the number
+    // of statuses that changed.
+    size_t revalidate_all(size_t layer) {
+        metrics::Scope probe(metrics::Op::ValidateReferences);
+        metrics::TimedLock guard(propagation_mutex, metrics::Lock::Propagation);
+        auto epoch = EpochManager::global().pin();
+        std::vector<uint8_t> states;
+        std::vector<size_t> current, layers;
+        pool.entity_states(states, current, layers);
+        size_t changed = 0;
+        size_t swept = pool.reference_columns().revalidate_all(states, current, layers, layer, *rules.load(std::memory_order_relaxed),
+                                                               [&](size_t rid, RefIntegrityStatus st) {
+            if (ReferenceObject* r = pool.get_reference(rid)) {
+                r->integrityStatus = st;
+                r->candidateTargets = CandidateSet();
+                r->lastValidatedLayer = layer;
+                record(r);
+                ++changed;
+            }
+        });
+        metrics::refs_touched(swept);
+        return changed;
+    }
+    // Validate the direct references, then cascade: an entity whose outgoing reference
+    // became Unresolved or Invalidated is no longer grounded, so references into it
+    // inherit that status (Invalidated dominates Unresolved), level by level.
+    // Each level is a parallel frontier step; ranks only ever rise and are merged with
+    // an atomic max, so final statuses do not depend on scheduling. References created
+    // after newLayer, or already validated at a later layer, are not touched.
+    // Sources that are external entities end the cascade here; each is passed to exits
+    // once, with the strongest status it inherited.
+    PropagationStats propagate_integrity(size_t entityId, OntState newState, size_t newLayer,
+                                         const std::vector<size_t>& splitIds = {}, PropagationLimits limits = {},
+                                         const ExitFn& exits = {}) {
+        metrics::Scope probe(metrics::Op::PropagateIntegrity); // includes the wait for propagation_mutex
+        metrics::TimedLock guard(propagation_mutex, metrics::Lock::Propagation);
+        auto epoch = EpochManager::global().pin();
+        PropagationStats stats;
+        std::vector<size_t> frontier;
+        std::vector<uint8_t> frontier_rank;
+        std::vector<std::pair<size_t, uint8_t>> out;
+        CandidateSet split = split_set(newState, splitIds);
+        pool.visit_incoming_ids({entityId}, [&](size_t, Entity*, const std::vector<size_t>& rids) {
+            stats.references_touched += classify(rids, newState, newLayer, split, [&](size_t rid, RefIntegrityStatus st) {
+                uint8_t r = cascade_rank(st);
+                const ReferenceObject* ref = r ? pool.get_reference(rid) : nullptr;
+                if (!ref) return;
+                if (is_external(ref->sourceEntityId)) out.emplace_back(ref->sourceEntityId, r);
+                else {
+                    frontier.push_back(ref->sourceEntityId);
+                    frontier_rank.push_back(r);
+                }
+            });
+        });
+        cascade(frontier, frontier_rank, newLayer, limits, stats, out);
+        finish(stats, out, exits);
+        return stats;
+    }
+    // Continues a cascade that reached these entities from outside the pool: references
+    // into them inherit status (Unresolved or Invalidated) and it spreads as above.
+    PropagationStats propagate_ungrounded(const std::vector<size_t>& entityIds, RefIntegrityStatus status, size_t layer,
+                                          PropagationLimits limits = {}, const ExitFn& exits = {}) {
+        metrics::Scope probe(metrics::Op::PropagateIntegrity);
+        metrics::TimedLock guard(propagation_mutex, metrics::Lock::Propagation);
+        auto epoch = EpochManager::global().pin();
+        PropagationStats stats;
+        std::vector<std::pair<size_t, uint8_t>> out;
+        const uint8_t r = cascade_rank(status);
+        std::vector<size_t> frontier;
+        for (size_t eid : entityIds)
+            if (r && !is_external(eid)) frontier.push_back(eid);
+        std::vector<uint8_t> frontier_rank(frontier.size(), r);
+        cascade(frontier, frontier_rank, layer, limits, stats, out);
+        finish(stats, out, exits);
+        return stats;
+    }
+    // Set the entity's state/layer and validate its incoming references
+    void apply_state_change(const StateChange& change) {
+        apply_state_changes({change});
+    }
+    // Batch form: every change is applied, in order, under the same lock as a cascade.
+    // The batch is cut into runs in which each entity appears once; each run is one
+    // pass over the touched entities, so an entity changed twice gets both versions
+    // (and both journal records).
+    void apply_state_changes(const std::vector<StateChange>& changes) {
+        metrics::Scope probe(metrics::Op::ApplyStateChanges);
+        {
+            metrics::TimedLock guard(propagation_mutex, metrics::Lock::Propagation);
+            auto epoch = EpochManager::global().pin();
+            std::unordered_set<size_t> in_run;
+            std::vector<size_t> eids;
+            size_t touched = 0;
+            for (size_t begin = 0, i = 0; begin < changes.size(); begin = i) {
+                in_run.clear();
+                eids.clear();
+                for (; i < changes.size() && in_run.insert(changes[i].entityId).second; ++i) eids.push_back(changes[i].entityId);
+                pool.visit_incoming_ids(eids, [&](size_t k, Entity* e, const std::vector<size_t>& rids) {
+                    const StateChange& c = changes[begin + k];
+                    e->state = c.newState;
+                    e->temporal_layer = c.layer;
+                    if (e->record_version())
+                        if (MutationSink* m = pool.mutation_sink()) m->entity_state_changed(*e);
+                    CandidateSet split = split_set(c.newState, c.splitIds);
+                    touched += classify(rids, c.newState, c.layer, split);
+                });
+            }
+            metrics::refs_touched(touched);
+        }
+        if (IdentityEvents* ev = identities.load(std::memory_order_acquire))
+            for (const auto& c : changes) {
+                if (c.newState == OntState::Merged && c.mergedInto) ev->entity_merged(c.entityId, c.mergedInto, c.layer);
+                else if (c.newState == OntState::Split) ev->entity_split(c.entityId, c.splitIds, c.layer);
+            }
+    }
+};
@@ -5,14 +5,7 @@
 #include <string>
 #include <map>
 #include <set>
-
-enum class OntState {
-    Undefined, Defined, Referenced, Reinterpreted, Contradicted, Split, Merged, Abstracted, ObserverRelative, Collapsed
-};
-
-enum class RefIntegrityStatus {
-    Valid, IdentityChanged, IdentitySplit, IdentityMerged, Invalidated, Unresolved, ObserverRelative
-};
+#include "integrity_policy.hpp"
 
 struct ReferenceObject {
     int sourceEntityId;
@@ -66,20 +59,10 @@ std::map<int, Entity> entityRegistry;
 void validateReferences(int changedEntityId, OntState newState, int newLayer, const std::vector<int>& splitIds = {}) {
     for (auto& ref : referenceRegistry) {
         if (ref.targetEntityId == changedEntityId) {
+            ref.integrityStatus = classify_status(ref.targetStateAtCreation, newState);
             if (newState == OntState::Split) {
-                ref.integrityStatus = RefIntegrityStatus::Unresolved;
                 ref.candidateTargets.clear();
                 for (int id : splitIds) ref.candidateTargets.insert(id);
-            } else if (newState == OntState::Merged) {
-                ref.integrityStatus = RefIntegrityStatus::IdentityMerged;
-            } else if (newState == OntState::ObserverRelative) {
-                ref.integrityStatus = RefIntegrityStatus::ObserverRelative;
-            } else if (newState == OntState::Collapsed) {
-                ref.integrityStatus = RefIntegrityStatus::Invalidated;
-            } else if (newState != ref.targetStateAtCreation) {
-                ref.integrityStatus = RefIntegrityStatus::IdentityChanged;
-            } else {
-                ref.integrityStatus = RefIntegrityStatus::Valid;
             }
             ref.lastValidatedLayer = newLayer;
         }
@@ -0,0 +1,596 @@
+// Paradox Engine
+// Recursive identity loops as strongly connected components of the reference graph:
+// parallel bulk detection, incremental maintenance as references are added
+// Author: 1proprogrammerchant
+// C++17+ required
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "oesm_highperf.hpp"
+#include "thread_pool.hpp"
+
+// Nodes are entities and edges are live references (source -> target). A paradox is
+// a component with more than one entity, or a single entity that refers to itself.
+//
+// rebuild() finds every component at once: a parallel trim peels off entities that
+// cannot be on a cycle, forward-backward (FW-BW) splitting carves up what is left, and
+// the resulting partitions are finished by Tarjan, all partitions in parallel.
+// add_reference() then keeps the components up to date one edge at a time by
+// maintaining a topological order of the component graph (Pearce-Kelly): an edge that
+// agrees with the order costs O(1); otherwise only the components ranked between its
+// endpoints are searched, and a cycle merges exactly the ones on it.
+//
+// Destroyed references and entities are only forgotten on the next rebuild().
+// All operations are serialized by an internal mutex.
+class ParadoxEngine {
+public:
+    struct Stats {
+        size_t entities = 0;
+        size_t references = 0;
+        size_t trimmed = 0;       // entities settled by the trim phase
+        size_t components = 0;
+        size_t cycles = 0;
+        size_t cyclic_entities = 0;
+    };
+
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+    static constexpr uint32_t SETTLED = UINT32_MAX; // partition color of finished nodes
+    static constexpr uint8_t FW = 1, BW = 2;
+    static constexpr size_t PARALLEL_FRONTIER = 1024;
+    static constexpr size_t FWBW_MIN = 4096;   // smaller partitions go straight to Tarjan
+    static constexpr uint32_t FWBW_ROUNDS = 3;
+
+    MemoryPool& pool;
+    ReferentialIntegrityEngine* rie;
+    WorkStealingPool* workers;
+    std::mutex mutex;
+
+    // Per entity slot index
+    std::vector<size_t> handle;                  // entity id the slot was indexed as, 0 if none
+    std::vector<uint32_t> out_begin, in_begin;   // CSR edges as of the last rebuild
+    std::vector<uint32_t> out_csr, in_csr;
+    std::vector<uint32_t> parent;                // union-find over components
+    std::vector<std::vector<uint32_t>> members;  // for representatives of merged components
+    std::vector<uint64_t> ord;                   // topological rank, representatives only
+    // Per representative: far ends of the component's edges not in the CSR. A singleton
+    // keeps only edges added since the rebuild; a merged component owns all of its edges,
+    // and entries that later merges make internal are dropped lazily as it is searched.
+    std::vector<std::vector<uint32_t>> comp_out, comp_in;
+    std::vector<uint8_t> cyclic;
+    std::vector<uint32_t> stamp;                 // search marks
+    uint32_t search = 0;
+    uint64_t next_ord = 0;
+    std::vector<size_t> seen_ref;                // reference id by slot index, once indexed
+
+    size_t nodes() const { return handle.size(); }
+
+    template <typename F>
+    void for_out(uint32_t v, F&& fn) const {
+        if (v + 1 < out_begin.size())
+            for (uint32_t i = out_begin[v]; i < out_begin[v + 1]; ++i) fn(out_csr[i]);
+    }
+    template <typename F>
+    void for_in(uint32_t v, F&& fn) const {
+        if (v + 1 < in_begin.size())
+            for (uint32_t i = in_begin[v]; i < in_begin[v + 1]; ++i) fn(in_csr[i]);
+    }
+
+    uint32_t find(uint32_t v) {
+        while (parent[v] != v) {
+            parent[v] = parent[parent[v]];
+            v = parent[v];
+        }
+        return v;
+    }
+    template <typename F>
+    void for_members(uint32_t rep, F&& fn) const {
+        if (members[rep].empty()) fn(rep);
+        else for (uint32_t v : members[rep]) fn(v);
+    }
+
+    void grow(size_t n) {
+        if (n <= nodes()) return;
+        size_t old = nodes();
+        handle.resize(n, 0);
+        comp_out.resize(n);
+        comp_in.resize(n);
+        parent.resize(n);
+        members.resize(n);
+        ord.resize(n);
+        cyclic.resize(n, 0);
+        stamp.resize(n, 0);
+        for (size_t v = old; v < n; ++v) {
+            parent[v] = static_cast<uint32_t>(v);
+            ord[v] = next_ord++;
+        }
+    }
+    // Slot of an entity id, indexing it as a fresh singleton if it is new here.
+    // Returns NONE if the slot was indexed for a different (destroyed) entity.
+    uint32_t node(size_t eid) {
+        uint32_t v = handle_index(eid);
+        grow(size_t(v) + 1);
+        if (handle[v] == 0) handle[v] = eid;
+        return handle[v] == eid ? v : NONE;
+    }
+
+    std::vector<size_t> entity_ids(uint32_t rep) const {
+        std::vector<size_t> out;
+        for_members(rep, [&](uint32_t v) { out.push_back(handle[v]); });
+        std::sort(out.begin(), out.end());
+        return out;
+    }
+    // Marks the component's entities Contradicted at layer (those not already so).
+    void report(const std::vector<size_t>& eids, size_t layer) {
+        if (!rie) return;
+        std::vector<StateChange> batch;
+        for (size_t eid : eids) {
+            Entity* e = pool.get_entity(eid);
+            if (e && e->state != OntState::Contradicted) batch.push_back({eid, OntState::Contradicted, layer, {}});
+        }
+        if (!batch.empty()) rie->apply_state_changes(batch);
+    }
+
+    // ---- bulk detection ----
+
+    // Nodes of color c reachable from start (or reaching it, for the in-edges) get bit set.
+    template <bool Forward>
+    void reach(uint32_t start, uint32_t c, uint8_t bit, const std::vector<std::atomic<uint32_t>>& color,
+               std::vector<std::atomic<uint8_t>>& mark) {
+        auto visit = [&](uint32_t v, auto&& push) {
+            auto step = [&](uint32_t w) {
+                if (color[w].load(std::memory_order_relaxed) != c) return;
+                if (mark[w].fetch_or(bit, std::memory_order_relaxed) & bit) return;
+                push(w);
+            };
+            if (Forward) for_out(v, step);
+            else for_in(v, step);
+        };
+        mark[start].fetch_or(bit, std::memory_order_relaxed);
+        std::vector<uint32_t> frontier{start}, next;
+        std::mutex merge_mutex;
+        while (!frontier.empty()) {
+            next.clear();
+            if (frontier.size() < PARALLEL_FRONTIER || !workers) {
+                for (uint32_t v : frontier) visit(v, [&](uint32_t w) { next.push_back(w); });
+            } else {
+                parallel_for(workers, frontier.size(), 256, [&](size_t b, size_t e) {
+                    std::vector<uint32_t> local;
+                    for (size_t i = b; i < e; ++i) visit(frontier[i], [&](uint32_t w) { local.push_back(w); });
+                    std::lock_guard lock(merge_mutex);
+                    next.insert(next.end(), local.begin(), local.end());
+                });
+            }
+            frontier.swap(next);
+        }
+    }
+
+    // Rebuilds the CSR from the pool; returns the number of edges indexed.
+    size_t index_pool() {
+        handle.clear();
+        seen_ref.clear();
+        next_ord = 0;
+        size_t n = pool.entity_capacity();
+        comp_out.assign(n, {});
+        comp_in.assign(n, {});
+        members.assign(n, {});
+        handle.assign(n, 0);
+        parent.resize(n);
+        ord.assign(n, 0);
+        cyclic.assign(n, 0);
+        stamp.assign(n, 0);
+        search = 0;
+        for (Entity* e : pool.all_entities())
+            if (handle_index(e->id) < n) handle[handle_index(e->id)] = e->id;
+        std::vector<std::pair<uint32_t, uint32_t>> edges;
+        std::vector<ReferenceObject*> refs = pool.all_references();
+        seen_ref.assign(pool.reference_capacity(), 0);
+        for (ReferenceObject* r : refs) {
+            uint32_t s = handle_index(r->sourceEntityId), t = handle_index(r->targetEntityId);
+            if (s >= n || t >= n || handle[s] != r->sourceEntityId || handle[t] != r->targetEntityId) continue;
+            if (handle_index(r->id) < seen_ref.size()) seen_ref[handle_index(r->id)] = r->id;
+            edges.push_back({s, t});
+        }
+        out_begin.assign(n + 1, 0);
+        in_begin.assign(n + 1, 0);
+        for (auto& [s, t] : edges) {
+            ++out_begin[s + 1];
+            ++in_begin[t + 1];
+        }
+        for (size_t v = 0; v < n; ++v) {
+            out_begin[v + 1] += out_begin[v];
+            in_begin[v + 1] += in_begin[v];
+        }
+        out_csr.resize(edges.size());
+        in_csr.resize(edges.size());
+        std::vector<uint32_t> oc(out_begin.begin(), out_begin.end() - 1), ic(in_begin.begin(), in_begin.end() - 1);
+        for (auto& [s, t] : edges) {
+            out_csr[oc[s]++] = t;
+            in_csr[ic[t]++] = s;
+            if (s == t) cyclic[s] = 1;
+        }
+        return edges.size();
+    }
+
+    // Peels nodes with no remaining in- or out-edges, level by level; they are singletons.
+    size_t trim(std::vector<std::atomic<uint32_t>>& color) {
+        size_t n = nodes();
+        std::vector<std::atomic<uint32_t>> indeg(n), outdeg(n);
+        std::vector<uint32_t> frontier;
+        for (uint32_t v = 0; v < n; ++v) {
+            if (!handle[v]) { color[v].store(SETTLED, std::memory_order_relaxed); continue; }
+            indeg[v].store(in_begin[v + 1] - in_begin[v], std::memory_order_relaxed);
+            outdeg[v].store(out_begin[v + 1] - out_begin[v], std::memory_order_relaxed);
+            if (indeg[v].load(std::memory_order_relaxed) == 0 || outdeg[v].load(std::memory_order_relaxed) == 0) {
+                color[v].store(SETTLED, std::memory_order_relaxed);
+                frontier.push_back(v);
+            }
+        }
+        size_t trimmed = 0;
+        std::mutex merge_mutex;
+        while (!frontier.empty()) {
+            trimmed += frontier.size();
+            std::vector<uint32_t> next;
+            parallel_for(workers, frontier.size(), 1024, [&](size_t b, size_t e) {
+                std::vector<uint32_t> local;
+                auto drop = [&](uint32_t w, std::atomic<uint32_t>& deg) {
+                    if (deg.fetch_sub(1, std::memory_order_relaxed) != 1) return;
+                    uint32_t c = 0;
+                    if (color[w].compare_exchange_strong(c, SETTLED, std::memory_order_relaxed)) local.push_back(w);
+                };
+                for (size_t i = b; i < e; ++i) {
+                    uint32_t v = frontier[i];
+                    for (uint32_t k = out_begin[v]; k < out_begin[v + 1]; ++k) drop(out_csr[k], indeg[out_csr[k]]);
+                    for (uint32_t k = in_begin[v]; k < in_begin[v + 1]; ++k) drop(in_csr[k], outdeg[in_csr[k]]);
+                }
+                std::lock_guard lock(merge_mutex);
+                next.insert(next.end(), local.begin(), local.end());
+            });
+            frontier.swap(next);
+        }
+        return trimmed;
+    }
+
+    // Settles one component of the bulk phase under representative rep.
+    void settle(std::vector<uint32_t>& scc, uint32_t rep, std::vector<std::atomic<uint32_t>>& color) {
+        for (uint32_t v : scc) {
+            color[v].store(SETTLED, std::memory_order_relaxed);
+            parent[v] = rep;
+        }
+        if (scc.size() > 1) {
+            cyclic[rep] = 1;
+            members[rep] = std::move(scc);
+        }
+    }
+
+    // Iterative Tarjan over the nodes of one partition (those of color c).
+    void tarjan(const std::vector<uint32_t>& part, uint32_t c, std::vector<std::atomic<uint32_t>>& color,
+                std::vector<uint32_t>& index, std::vector<uint32_t>& low) {
+        struct Frame { uint32_t v, edge; };
+        std::vector<Frame> calls;
+        std::vector<uint32_t> stack, out;
+        uint32_t counter = 0;
+        auto edges = [&](uint32_t v) { return out_begin[v + 1] - out_begin[v]; };
+        for (uint32_t root : part) {
+            if (index[root] != NONE) continue;
+            calls.push_back({root, 0});
+            index[root] = low[root] = counter++;
+            stack.push_back(root);
+            while (!calls.empty()) {
+                Frame& f = calls.back();
+                if (f.edge < edges(f.v)) {
+                    uint32_t w = out_csr[out_begin[f.v] + f.edge++];
+                    if (color[w].load(std::memory_order_relaxed) != c) continue; // settled, or another partition
+                    if (index[w] == NONE) {
+                        index[w] = low[w] = counter++;
+                        stack.push_back(w);
+                        calls.push_back({w, 0});
+                    } else {
+                        low[f.v] = std::min(low[f.v], index[w]);
+                    }
+                    continue;
+                }
+                uint32_t v = f.v;
+                calls.pop_back();
+                if (!calls.empty()) low[calls.back().v] = std::min(low[calls.back().v], low[v]);
+                if (low[v] != index[v]) continue;
+                out.clear();
+                uint32_t w;
+                do {
+                    w = stack.back();
+                    stack.pop_back();
+                    out.push_back(w);
+                } while (w != v);
+                settle(out, v, color); // settled nodes leave color c, so they drop out of later low updates
+                out = std::vector<uint32_t>();
+            }
+        }
+    }
+
+    // Large partitions are split with FW-BW: the component of a pivot is its forward set
+    // intersected with its backward set, and the three remainders cannot share a
+    // component. The pivot is the partition's busiest node, which is likely to sit in
+    // its giant component. Small or repeatedly split partitions, where FW-BW degrades
+    // to peeling one component per pass, go to Tarjan instead.
+    void split_components(std::vector<std::atomic<uint32_t>>& color) {
+        size_t n = nodes();
+        std::vector<std::atomic<uint8_t>> mark(n);
+        std::vector<uint32_t> index(n, NONE), low(n, 0);
+        std::atomic<uint32_t> next_color{1};
+        struct Part { std::vector<uint32_t> nodes; uint32_t rounds; };
+        std::vector<Part> parts(1);
+        for (uint32_t v = 0; v < n; ++v)
+            if (color[v].load(std::memory_order_relaxed) == 0) parts[0].nodes.push_back(v);
+        if (parts[0].nodes.empty()) return;
+        parts[0].rounds = 0;
+        std::mutex merge_mutex;
+        while (!parts.empty()) {
+            std::vector<Part> next;
+            parallel_for(workers, parts.size(), 1, [&](size_t b, size_t e) {
+                for (size_t p = b; p < e; ++p) {
+                    std::vector<uint32_t>& part = parts[p].nodes;
+                    uint32_t c = color[part[0]].load(std::memory_order_relaxed);
+                    if (part.size() < FWBW_MIN || parts[p].rounds >= FWBW_ROUNDS) {
+                        tarjan(part, c, color, index, low);
+                        continue;
+                    }
+                    uint32_t pivot = part[0];
+                    uint64_t best = 0;
+                    for (uint32_t v : part) {
+                        uint64_t d = uint64_t(out_begin[v + 1] - out_begin[v]) * (in_begin[v + 1] - in_begin[v]);
+                        if (d > best) best = d, pivot = v;
+                    }
+                    reach<true>(pivot, c, FW, color, mark);
+                    reach<false>(pivot, c, BW, color, mark);
+                    std::vector<uint32_t> rest[3], scc;
+                    for (uint32_t v : part) {
+                        uint8_t m = mark[v].exchange(0, std::memory_order_relaxed);
+                        if (m == (FW | BW)) scc.push_back(v);
+                        else rest[m].push_back(v); // 0: neither, FW: forward only, BW: backward only
+                    }
+                    settle(scc, pivot, color);
+                    std::lock_guard lock(merge_mutex);
+                    for (auto& r : rest) {
+                        if (r.empty()) continue;
+                        uint32_t nc = next_color.fetch_add(1, std::memory_order_relaxed) + 1;
+                        for (uint32_t v : r) color[v].store(nc, std::memory_order_relaxed);
+                        next.push_back({std::move(r), parts[p].rounds + 1});
+                    }
+                }
+            });
+            parts.swap(next);
+        }
+    }
+
+    // Edge lists of the merged components, and topological ranks of the component graph (Kahn).
+    void order_components() {
+        size_t n = nodes();
+        std::vector<uint32_t> indeg(n, 0), queue;
+        for (uint32_t v = 0; v < n; ++v)
+            for (uint32_t i = out_begin[v]; i < out_begin[v + 1]; ++i)
+                if (parent[out_csr[i]] != parent[v]) ++indeg[parent[out_csr[i]]];
+        for (uint32_t v = 0; v < n; ++v) {
+            if (parent[v] != v) continue;
+            if (!members[v].empty()) materialize(v);
+            if (indeg[v] == 0) queue.push_back(v);
+        }
+        for (size_t q = 0; q < queue.size(); ++q) {
+            uint32_t c = queue[q];
+            ord[c] = next_ord++;
+            for_members(c, [&](uint32_t v) {
+                for (uint32_t i = out_begin[v]; i < out_begin[v + 1]; ++i) {
+                    uint32_t d = parent[out_csr[i]];
+                    if (d != c && --indeg[d] == 0) queue.push_back(d);
+                }
+            });
+        }
+    }
+    // Moves a component's CSR edges leaving it into its own lists.
+    void materialize(uint32_t rep) {
+        for_members(rep, [&](uint32_t v) {
+            for_out(v, [&](uint32_t w) { if (find(w) != rep) comp_out[rep].push_back(w); });
+            for_in(v, [&](uint32_t w) { if (find(w) != rep) comp_in[rep].push_back(w); });
+        });
+    }
+
+    // ---- incremental maintenance ----
+
+    // Components reachable from (Forward) or reaching (!Forward) rep, within [lo, hi] ranks.
+    template <bool Forward>
+    std::vector<uint32_t> bounded(uint32_t rep, uint64_t lo, uint64_t hi) {
+        std::vector<uint32_t> found{rep}, stack{rep};
+        stamp[rep] = search;
+        while (!stack.empty()) {
+            uint32_t c = stack.back();
+            stack.pop_back();
+            auto step = [&](uint32_t w) {
+                uint32_t d = find(w);
+                if (d == c || stamp[d] == search || ord[d] < lo || ord[d] > hi) return;
+                stamp[d] = search;
+                found.push_back(d);
+                stack.push_back(d);
+            };
+            if (members[c].empty()) {
+                if (Forward) for_out(c, step);
+                else for_in(c, step);
+            }
+            std::vector<uint32_t>& edges = Forward ? comp_out[c] : comp_in[c];
+            for (size_t i = 0; i < edges.size();) {
+                uint32_t d = find(edges[i]);
+                if (d == c) { // made internal by a merge
+                    edges[i] = edges.back();
+                    edges.pop_back();
+                    continue;
+                }
+                edges[i++] = d;
+                step(d);
+            }
+        }
+        return found;
+    }
+
+    // Records edge s -> t; returns the representative of a newly formed or grown cycle, or NONE.
+    uint32_t insert_edge(uint32_t s, uint32_t t) {
+        uint32_t cs = find(s), ct = find(t);
+        if (cs == ct) {
+            if (s != t || cyclic[cs]) return NONE;
+            cyclic[cs] = 1;
+            return cs;
+        }
+        comp_out[cs].push_back(ct);
+        comp_in[ct].push_back(cs);
+        if (ord[cs] < ord[ct]) return NONE;
+        uint64_t lo = ord[ct], hi = ord[cs];
+        ++search;
+        std::vector<uint32_t> fwd = bounded<true>(ct, lo, hi);
+        ++search;
+        std::vector<uint32_t> bwd = bounded<false>(cs, lo, hi);
+        // cs is forward-reachable iff the edge closed a cycle; the cycle is then fwd & bwd.
+        ++search;
+        for (uint32_t c : bwd) stamp[c] = search;
+        std::vector<uint32_t> both, fonly, bonly;
+        for (uint32_t c : fwd) (stamp[c] == search ? both : fonly).push_back(c);
+        ++search;
+        for (uint32_t c : both) stamp[c] = search;
+        for (uint32_t c : bwd)
+            if (stamp[c] != search) bonly.push_back(c);
+        // Reuse the affected ranks: backward-only first, then the merged cycle, then forward-only.
+        std::vector<uint64_t> slots;
+        for (uint32_t c : fwd) slots.push_back(ord[c]);
+        for (uint32_t c : bonly) slots.push_back(ord[c]);
+        std::sort(slots.begin(), slots.end());
+        auto by_rank = [&](uint32_t a, uint32_t b) { return ord[a] < ord[b]; };
+        std::sort(bonly.begin(), bonly.end(), by_rank);
+        std::sort(fonly.begin(), fonly.end(), by_rank);
+        size_t k = 0;
+        for (uint32_t c : bonly) ord[c] = slots[k++];
+        uint32_t merged = NONE;
+        if (!both.empty()) {
+            merged = merge(both);
+            ord[merged] = slots[k];
+        }
+        k = slots.size() - fonly.size();
+        for (uint32_t c : fonly) ord[c] = slots[k++];
+        return merged;
+    }
+    uint32_t merge(const std::vector<uint32_t>& reps) {
+        uint32_t root = reps[0];
+        for (uint32_t c : reps)
+            if (members[c].size() > members[root].size()) root = c;
+        auto absorb = [](std::vector<uint32_t>& into, std::vector<uint32_t>& from) {
+            into.insert(into.end(), from.begin(), from.end());
+            std::vector<uint32_t>().swap(from);
+        };
+        auto own_csr = [&](uint32_t c) { // a singleton's CSR edges become list entries
+            for_out(c, [&](uint32_t w) { comp_out[root].push_back(w); });
+            for_in(c, [&](uint32_t w) { comp_in[root].push_back(w); });
+        };
+        if (members[root].empty()) {
+            members[root].push_back(root);
+            own_csr(root);
+        }
+        for (uint32_t c : reps) {
+            if (c == root) continue;
+            parent[c] = root;
+            if (members[c].empty()) {
+                own_csr(c);
+                members[root].push_back(c);
+            } else {
+                absorb(members[root], members[c]);
+            }
+            absorb(comp_out[root], comp_out[c]);
+            absorb(comp_in[root], comp_in[c]);
+        }
+        cyclic[root] = 1;
+        return root;
+    }
+
+    Stats rebuild_locked(size_t layer) {
+        Stats st;
+        st.references = index_pool();
+        size_t n = nodes();
+        for (uint32_t v = 0; v < n; ++v) parent[v] = v;
+        std::vector<std::atomic<uint32_t>> color(n);
+        st.trimmed = trim(color);
+        split_components(color);
+        order_components();
+        std::vector<uint32_t> found;
+        for (uint32_t v = 0; v < n; ++v) {
+            if (!handle[v]) continue;
+            ++st.entities;
+            if (parent[v] != v) continue;
+            ++st.components;
+            if (cyclic[v]) found.push_back(v);
+        }
+        st.cycles = found.size();
+        for (uint32_t c : found) {
+            std::vector<size_t> eids = entity_ids(c);
+            st.cyclic_entities += eids.size();
+            report(eids, layer);
+        }
+        return st;
+    }
+
+public:
+    // With rie set, entities found on a cycle are marked Contradicted through it.
+    explicit ParadoxEngine(MemoryPool& p, ReferentialIntegrityEngine* r = nullptr, WorkStealingPool* w = nullptr)
+        : pool(p), rie(r), workers(w) {}
+
+    // Recomputes every component from the pool; cycles are reported at layer.
+    Stats rebuild(size_t layer) {
+        std::lock_guard guard(mutex);
+        return rebuild_locked(layer);
+    }
+
+    // Indexes one new reference. Returns the entities of the cycle it closed (the whole
+    // component, sorted), or nothing if it closed none. They are reported at the
+    // reference's creation layer. Already indexed references are ignored.
+    std::vector<size_t> add_reference(size_t rid) {
+        std::lock_guard guard(mutex);
+        ReferenceObject* r = pool.get_reference(rid);
+        if (!r) return {};
+        uint32_t ri = handle_index(rid);
+        if (ri >= seen_ref.size()) seen_ref.resize(size_t(ri) + 1, 0);
+        if (seen_ref[ri] == rid) return {};
+        seen_ref[ri] = rid;
+        if (!pool.get_entity(r->sourceEntityId) || !pool.get_entity(r->targetEntityId)) return {};
+        uint32_t s = node(r->sourceEntityId), t = node(r->targetEntityId);
+        if (s == NONE || t == NONE) {
+            // An entity slot was reused since the last rebuild; its old edges are stale.
+            rebuild_locked(r->creationLayer);
+            uint32_t c = find(handle_index(r->sourceEntityId));
+            return cyclic[c] && c == find(handle_index(r->targetEntityId)) ? entity_ids(c) : std::vector<size_t>{};
+        }
+        uint32_t c = insert_edge(s, t);
+        if (c == NONE) return {};
+        std::vector<size_t> eids = entity_ids(c);
+        report(eids, r->creationLayer);
+        return eids;
+    }
+
+    // True if the entity is on a recursive identity loop.
+    bool is_paradox(size_t eid) {
+        std::lock_guard guard(mutex);
+        uint32_t v = handle_index(eid);
+        return v < nodes() && handle[v] == eid && cyclic[find(v)];
+    }
+    // The entities sharing eid's component (just eid if it is on no cycle).
+    std::vector<size_t> component_of(size_t eid) {
+        std::lock_guard guard(mutex);
+        uint32_t v = handle_index(eid);
+        if (v >= nodes() || handle[v] != eid) return {eid};
+        return entity_ids(find(v));
+    }
+    // Every current cycle, each as a sorted list of entity ids.
+    std::vector<std::vector<size_t>> cycles() {
+        std::lock_guard guard(mutex);
+        std::vector<std::vector<size_t>> out;
+        for (uint32_t v = 0; v < nodes(); ++v)
+            if (handle[v] && parent[v] == v && cyclic[v]) out.push_back(entity_ids(v));
+        return out;
+    }
+};
@@ -0,0 +1,78 @@
+// Pool Compactor
+// Background history trimming, dead-object reclamation and slab defragmentation
+// Author: 1proprogrammerchant
+// C++17+ required
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "oesm_highperf.hpp"
+
+struct CompactorOptions {
+    std::chrono::milliseconds interval{1000};
+    size_t keep_layers = 0; // newest committed layers whose history and dead objects are kept
+};
+
+struct CompactorStats {
+    uint64_t passes = 0, versions = 0;
+    uint64_t entities = 0, references = 0, adjacency = 0, freed = 0, chunks = 0;
+};
+
+// Runs MemoryPool::compact_history and MemoryPool::reclaim every interval, so a
+// long-running pool stays bounded by its live objects. Open LayerSnapshots hold the
+// horizon back; as-of reads older than committed - keep_layers stop being served.
+class PoolCompactor {
+    MemoryPool& pool;
+    CompactorOptions opts;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stopping = false;
+    CompactorStats totals;
+    std::thread thread;
+
+    void run() {
+        std::unique_lock lock(mutex);
+        while (!cv.wait_for(lock, opts.interval, [&] { return stopping; })) {
+            lock.unlock();
+            pass();
+            lock.lock();
+        }
+    }
+
+public:
+    explicit PoolCompactor(MemoryPool& p, CompactorOptions o = {})
+        : pool(p), opts(o), thread(&PoolCompactor::run, this) {}
+    PoolCompactor(const PoolCompactor&) = delete;
+    PoolCompactor& operator=(const PoolCompactor&) = delete;
+    ~PoolCompactor() {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        cv.notify_one();
+        thread.join();
+    }
+
+    // One pass now, on the calling thread (the background one runs the same).
+    ReclaimStats pass() {
+        size_t top = pool.committed_layer();
+        size_t horizon = top > opts.keep_layers ? top - opts.keep_layers : 0;
+        size_t versions = pool.compact_history(horizon);
+        ReclaimStats r = pool.reclaim(horizon);
+        std::lock_guard lock(mutex);
+        ++totals.passes;
+        totals.versions += versions;
+        totals.entities += r.entities;
+        totals.references += r.references;
+        totals.adjacency += r.adjacency;
+        totals.freed += r.freed;
+        totals.chunks += r.chunks;
+        return r;
+    }
+
+    CompactorStats stats() {
+        std::lock_guard lock(mutex);
+        return totals;
+    }
+};
@@ -0,0 +1,462 @@
+// RIE Proposal Ingestion
+// Streams newline-delimited proposal JSON from the NLP core into the pool and engine
+// Author: 1proprogrammerchant
+// C++17+ required (POSIX read)
+#pragma once
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include "oesm_highperf.hpp"
+
+// One proposal per line, as emitted by NLPCore and the Triton backend:
+//   {"identity_key": "...", "from": "...", "to": "...", "type": "mutation", "layer": 1}
+// Three stages, each on its own thread, pass fixed chunks of input around a ring (each
+// Stats counter is owned by one stage):
+//   parse   — read a chunk, parse its lines in place into string views (no allocation)
+//   resolve — identity key -> entity id, creating entities for keys seen the first time
+//   apply   — coalesce per layer and entity, then apply_state_changes in batches once
+//             the layer ends (so a split never depends on where a batch was cut)
+namespace ingest {
+
+struct ProposalView {
+    std::string_view identity_key, from, to, type;
+    uint64_t layer = 0;
+};
+
+namespace detail {
+
+inline char* skip_ws(char* p, char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) ++p;
+    return p;
+}
+inline int hex(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+inline bool hex4(const char* p, const char* end, uint32_t& v) {
+    if (end - p < 4) return false;
+    v = 0;
+    for (int i = 0; i < 4; ++i) {
+        int h = hex(p[i]);
+        if (h < 0) return false;
+        v = v << 4 | uint32_t(h);
+    }
+    return true;
+}
+inline char* put_utf8(char* w, uint32_t cp) {
+    if (cp < 0x80) *w++ = char(cp);
+    else if (cp < 0x800) { *w++ = char(0xC0 | cp >> 6); *w++ = char(0x80 | (cp & 0x3F)); }
+    else if (cp < 0x10000) { *w++ = char(0xE0 | cp >> 12); *w++ = char(0x80 | (cp >> 6 & 0x3F)); *w++ = char(0x80 | (cp & 0x3F)); }
+    else { *w++ = char(0xF0 | cp >> 18); *w++ = char(0x80 | (cp >> 12 & 0x3F)); *w++ = char(0x80 | (cp >> 6 & 0x3F)); *w++ = char(0x80 | (cp & 0x3F)); }
+    return w;
+}
+
+// String starting at the opening quote; escapes are decoded in place (the result is
+// never longer than its source). Returns the position after the closing quote.
+inline char* parse_string(char* p, char* end, std::string_view& out) {
+    char* r = ++p;
+    while (r < end && *r != '"' && *r != '\\') ++r; // fast path: no escapes
+    char* w = r;
+    while (r < end && *r != '"') {
+        if (*r != '\\') { *w++ = *r++; continue; }
+        if (++r == end) return nullptr;
+        switch (*r++) {
+        case '"': *w++ = '"'; break;
+        case '\\': *w++ = '\\'; break;
+        case '/': *w++ = '/'; break;
+        case 'b': *w++ = '\b'; break;
+        case 'f': *w++ = '\f'; break;
+        case 'n': *w++ = '\n'; break;
+        case 'r': *w++ = '\r'; break;
+        case 't': *w++ = '\t'; break;
+        case 'u': {
+            uint32_t cp;
+            if (!hex4(r, end, cp)) return nullptr;
+            r += 4;
+            if (cp >= 0xD800 && cp < 0xDC00) { // surrogate pair
+                uint32_t lo;
+                if (end - r < 6 || r[0] != '\\' || r[1] != 'u' || !hex4(r + 2, end, lo) || lo < 0xDC00 || lo > 0xDFFF) return nullptr;
+                r += 6;
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+            }
+            w = put_utf8(w, cp);
+            break;
+        }
+        default: return nullptr;
+        }
+    }
+    if (r == end) return nullptr;
+    out = std::string_view(p, size_t(w - p));
+    return r + 1;
+}
+
+// Skips any JSON value (nested objects and arrays included).
+inline char* skip_value(char* p, char* end) {
+    if (p == end) return nullptr;
+    if (*p == '"') {
+        std::string_view ignored;
+        return parse_string(p, end, ignored);
+    }
+    if (*p == '{' || *p == '[') {
+        int depth = 0;
+        while (p < end) {
+            if (*p == '"') {
+                std::string_view ignored;
+                if (!(p = parse_string(p, end, ignored))) return nullptr;
+                continue;
+            }
+            if (*p == '{' || *p == '[') ++depth;
+            else if ((*p == '}' || *p == ']') && --depth == 0) return p + 1;
+            ++p;
+        }
+        return nullptr;
+    }
+    while (p < end && *p != ',' && *p != '}' && *p != ']' && *p != ' ' && *p != '\t' && *p != '\r') ++p;
+    return p;
+}
+
+} // namespace detail
+
+// Parses one line in place. False for malformed JSON or a missing identity_key,
+// type or layer ("from" and "to" may be absent).
+inline bool parse_proposal(char* p, char* end, ProposalView& out) {
+    using namespace detail;
+    out = ProposalView();
+    bool has_key = false, has_type = false, has_layer = false;
+    p = skip_ws(p, end);
+    if (p == end || *p != '{') return false;
+    p = skip_ws(p + 1, end);
+    if (p < end && *p == '}') return false;
+    while (p < end) {
+        std::string_view field;
+        if (*p != '"' || !(p = parse_string(p, end, field))) return false;
+        p = skip_ws(p, end);
+        if (p == end || *p != ':') return false;
+        p = skip_ws(p + 1, end);
+        if (p == end) return false;
+        std::string_view* target = field == "identity_key" ? &out.identity_key
+                                 : field == "from" ? &out.from
+                                 : field == "to" ? &out.to
+                                 : field == "type" ? &out.type : nullptr;
+        if (target) {
+            if (*p != '"' || !(p = parse_string(p, end, *target))) return false;
+            has_key |= target == &out.identity_key;
+            has_type |= target == &out.type;
+        } else if (field == "layer") {
+            if (*p < '0' || *p > '9') return false;
+            uint64_t v = 0;
+            while (p < end && *p >= '0' && *p <= '9') v = v * 10 + uint64_t(*p++ - '0');
+            out.layer = v;
+            has_layer = true;
+        } else if (!(p = skip_value(p, end))) {
+            return false;
+        }
+        p = skip_ws(p, end);
+        if (p == end) return false;
+        if (*p == '}') return has_key && has_type && has_layer;
+        if (*p != ',') return false;
+        p = skip_ws(p + 1, end);
+    }
+    return false;
+}
+
+// Proposal type -> the state the identity moves to. "mutation" is a reinterpretation,
+// or a split when one layer proposes several distinct surfaces for the same identity.
+inline bool proposal_state(std::string_view type, OntState& out) {
+    static constexpr std::pair<std::string_view, OntState> table[] = {
+        {"mutation", OntState::Reinterpreted},     {"reinterpretation", OntState::Reinterpreted},
+        {"split", OntState::Split},                {"merge", OntState::Merged},
+        {"contradiction", OntState::Contradicted}, {"abstraction", OntState::Abstracted},
+        {"observer", OntState::ObserverRelative},  {"collapse", OntState::Collapsed},
+        {"definition", OntState::Defined},
+    };
+    for (auto& [name, state] : table)
+        if (name == type) {
+            out = state;
+            return true;
+        }
+    return false;
+}
+
+// Bounded hand-off between two stages
+template <typename T>
+class BoundedQueue {
+    std::mutex mutex;
+    std::condition_variable not_empty, not_full;
+    std::deque<T> items;
+    size_t capacity;
+public:
+    explicit BoundedQueue(size_t cap) : capacity(cap) {}
+    void push(T v) {
+        std::unique_lock lock(mutex);
+        not_full.wait(lock, [&] { return items.size() < capacity; });
+        items.push_back(std::move(v));
+        not_empty.notify_one();
+    }
+    T pop() {
+        std::unique_lock lock(mutex);
+        not_empty.wait(lock, [&] { return !items.empty(); });
+        T v = std::move(items.front());
+        items.pop_front();
+        not_full.notify_one();
+        return v;
+    }
+};
+
+struct Options {
+    size_t chunk_bytes = 1 << 20;   // read size; a chunk is the unit passed between stages
+    size_t chunks = 8;              // in flight across the three stages
+    size_t max_batch = 1 << 16;     // entities per apply_state_changes call (at most)
+};
+
+struct Stats {
+    uint64_t lines = 0;
+    uint64_t bytes = 0;
+    uint64_t malformed = 0;         // not a proposal object
+    uint64_t rejected = 0;          // unknown type, or an identity that no longer exists
+    uint64_t proposals = 0;         // resolved and handed to the apply stage
+    uint64_t entities_created = 0;  // first sightings of identity keys
+    uint64_t aspects_created = 0;   // entities split off by competing reinterpretations
+    uint64_t changes = 0;           // state changes applied after coalescing
+    uint64_t batches = 0;
+};
+
+class ProposalPipeline {
+    struct Resolved {
+        size_t entity;
+        OntState state;
+        uint64_t layer;
+        Symbol to;
+    };
+    // Travels parse -> resolve -> apply -> back to parse. Views point into data.
+    struct Chunk {
+        std::unique_ptr<char[]> data;
+        size_t capacity = 0, size = 0;
+        std::vector<ProposalView> views;
+        std::vector<Resolved> resolved;
+        bool last = false;
+    };
+    // Coalesced changes for one entity in the open layer
+    struct Pending {
+        size_t entity;
+        OntState state;
+        std::vector<Symbol> surfaces; // distinct "to" surfaces of mutations
+    };
+
+    MemoryPool& pool;
+    ReferentialIntegrityEngine& rie;
+    Options opts;
+    Stats stats;
+    std::string error;
+    std::vector<size_t> key_entity; // by interned identity key
+
+    // apply-stage state
+    std::vector<Pending> pending;
+    size_t pending_count = 0;
+    std::unordered_map<size_t, size_t> pending_index;
+    uint64_t open_layer = 0;
+    std::vector<StateChange> changes;
+
+    void parse_stage(int fd, BoundedQueue<Chunk*>& free_chunks, BoundedQueue<Chunk*>& parsed) {
+        std::string carry; // a line cut off at the end of the previous chunk
+        bool eof = false;
+        while (!eof) {
+            Chunk* c = free_chunks.pop();
+            if (c->capacity < carry.size() * 2 || c->capacity < opts.chunk_bytes) {
+                c->capacity = std::max(opts.chunk_bytes, carry.size() * 2);
+                c->data.reset(new char[c->capacity]);
+            }
+            std::memcpy(c->data.get(), carry.data(), carry.size());
+            c->size = carry.size();
+            while (c->size < c->capacity) {
+                ssize_t n = ::read(fd, c->data.get() + c->size, c->capacity - c->size);
+                if (n < 0 && errno == EINTR) continue;
+                if (n < 0) error = std::string("read: ") + std::strerror(errno);
+                if (n <= 0) {
+                    eof = true;
+                    break;
+                }
+                stats.bytes += size_t(n);
+                c->size += size_t(n);
+            }
+            char* begin = c->data.get();
+            char* stop = begin + c->size;
+            if (!eof) { // keep the partial last line for the next chunk
+                char* cut = stop;
+                while (cut > begin && cut[-1] != '\n') --cut;
+                carry.assign(cut, stop);
+                stop = cut;
+            }
+            c->views.clear();
+            for (char* line = begin; line < stop;) {
+                char* nl = static_cast<char*>(std::memchr(line, '\n', size_t(stop - line)));
+                char* le = nl ? nl : stop;
+                if (detail::skip_ws(line, le) != le) {
+                    ++stats.lines;
+                    ProposalView v;
+                    if (parse_proposal(line, le, v)) c->views.push_back(v);
+                    else ++stats.malformed;
+                }
+                line = le + 1;
+            }
+            c->last = eof;
+            parsed.push(c);
+        }
+    }
+
+    void resolve_stage(BoundedQueue<Chunk*>& parsed, BoundedQueue<Chunk*>& resolved) {
+        SymbolTable& symbols = SymbolTable::global();
+        while (true) {
+            Chunk* c = parsed.pop();
+            c->resolved.clear();
+            for (const ProposalView& v : c->views) {
+                OntState state;
+                if (!proposal_state(v.type, state)) {
+                    ++stats.rejected;
+                    continue;
+                }
+                Symbol key = symbols.intern(v.identity_key);
+                if (key >= key_entity.size()) key_entity.resize(std::max<size_t>(key + 1, key_entity.size() * 2), 0);
+                size_t& eid = key_entity[key];
+                if (!eid) {
+                    eid = pool.create_entity(symbols.intern(v.from), AttributeSet(), OntState::Defined, v.layer)->id;
+                    ++stats.entities_created;
+                } else if (!pool.get_entity(eid)) {
+                    ++stats.rejected;
+                    continue;
+                }
+                c->resolved.push_back({eid, state, v.layer, v.to.empty() ? Symbol(0) : symbols.intern(v.to)});
+            }
+            bool last = c->last;
+            resolved.push(c);
+            if (last) return;
+        }
+    }
+
+    void apply_stage(BoundedQueue<Chunk*>& resolved, BoundedQueue<Chunk*>& free_chunks) {
+        while (true) {
+            Chunk* c = resolved.pop();
+            for (const Resolved& r : c->resolved) {
+                if (r.layer != open_layer) {
+                    flush();
+                    pool.commit_layer(open_layer); // its last batch is in
+                    open_layer = r.layer;
+                }
+                add(r);
+            }
+            stats.proposals += c->resolved.size();
+            bool last = c->last;
+            free_chunks.push(c);
+            if (last) break;
+        }
+        flush();
+        pool.commit_layer(open_layer);
+    }
+
+    void add(const Resolved& r) {
+        auto [it, fresh] = pending_index.try_emplace(r.entity, pending_count);
+        if (fresh) {
+            if (pending_count == pending.size()) pending.emplace_back();
+            Pending& p = pending[pending_count++];
+            p.entity = r.entity;
+            p.surfaces.clear();
+        }
+        Pending& p = pending[it->second];
+        p.state = r.state; // the last proposal for an identity in a layer wins
+        if (r.state == OntState::Reinterpreted && r.to &&
+            std::find(p.surfaces.begin(), p.surfaces.end(), r.to) == p.surfaces.end())
+            p.surfaces.push_back(r.to);
+    }
+
+    // Applies the open layer in batches of max_batch. Competing reinterpretations become a
+    // split into one aspect entity per surface.
+    void flush() {
+        changes.clear();
+        for (size_t i = 0; i < pending_count; ++i) {
+            Pending& p = pending[i];
+            StateChange sc{p.entity, p.state, open_layer, {}};
+            if (p.state == OntState::Reinterpreted && p.surfaces.size() > 1) {
+                Entity* e = pool.get_entity(p.entity);
+                if (!e) continue;
+                sc.newState = OntState::Split;
+                for (Symbol s : p.surfaces)
+                    sc.splitIds.push_back(pool.create_entity(s, e->attributes, OntState::Split, open_layer)->id);
+                stats.aspects_created += p.surfaces.size();
+            }
+            changes.push_back(std::move(sc));
+            if (changes.size() == opts.max_batch) apply_batch();
+        }
+        apply_batch();
+        pending_index.clear();
+        pending_count = 0;
+    }
+
+    void apply_batch() {
+        if (changes.empty()) return;
+        rie.apply_state_changes(changes);
+        stats.changes += changes.size();
+        ++stats.batches;
+        changes.clear();
+    }
+
+public:
+    ProposalPipeline(MemoryPool& p, ReferentialIntegrityEngine& r, Options o = {}) : pool(p), rie(r), opts(o) {
+        opts.chunks = std::max<size_t>(opts.chunks, 3);
+        opts.max_batch = std::max<size_t>(opts.max_batch, 1);
+    }
+
+    // Ingests fd to EOF; returns once everything read has been applied. Malformed and
+    // rejected lines are counted and skipped. False only if reading failed (what was
+    // read before the failure is still applied).
+    bool run(int fd, std::string* err = nullptr) {
+        error.clear();
+        BoundedQueue<Chunk*> free_chunks(opts.chunks), parsed(opts.chunks), resolved(opts.chunks);
+        std::vector<std::unique_ptr<Chunk>> ring;
+        for (size_t i = 0; i < opts.chunks; ++i) {
+            ring.push_back(std::make_unique<Chunk>());
+            free_chunks.push(ring.back().get());
+        }
+        std::thread resolver([&] { resolve_stage(parsed, resolved); });
+        std::thread applier([&] { apply_stage(resolved, free_chunks); });
+        parse_stage(fd, free_chunks, parsed);
+        resolver.join();
+        applier.join();
+        if (!error.empty() && err) *err = error;
+        return error.empty();
+    }
+    // "-" reads standard input.
+    bool run_file(const std::string& path, std::string* err = nullptr) {
+        if (path == "-") return run(STDIN_FILENO, err);
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            if (err) *err = "open " + path + ": " + std::strerror(errno);
+            return false;
+        }
+        bool ok = run(fd, err);
+        ::close(fd);
+        return ok;
+    }
+
+    // Entity for an identity key ingested so far, or 0.
+    size_t entity_for(std::string_view identity_key) const {
+        Symbol key = SymbolTable::global().find(identity_key);
+        return key && key < key_entity.size() ? key_entity[key] : 0;
+    }
+    const Stats& statistics() const { return stats; }
+};
+
+} // namespace ingest
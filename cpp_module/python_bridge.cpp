@@ -0,0 +1,318 @@
+// Embedded Python Bridge
+// CPython embedding behind the C API in python_bridge.h
+// Author: 1proprogrammerchant
+// C++17+ required
+// Build: g++ -std=c++17 -O2 -pthread -c python_bridge.cpp $(python3-config --includes)
+//        link with $(python3-config --ldflags --embed)
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "python_bridge.h"
+
+// Proposal buffer: u32 count, count * 8 u32 spans, count * u32 layers, string blob
+// (encode_proposals in nlp_core.py).
+struct NlpBatch {
+    std::unique_ptr<char[]> data;
+    size_t bytes = 0;
+    uint32_t count = 0;
+    const uint32_t* spans = nullptr;
+    const uint32_t* layers = nullptr;
+    const char* blob = nullptr;
+    size_t blob_bytes = 0;
+};
+
+namespace {
+
+constexpr char RECORD_SEP = '\x1e', FIELD_SEP = '\x1f';
+
+thread_local std::string last_error;
+
+bool fail(const std::string& msg) {
+    last_error = msg;
+    return false;
+}
+
+// Python exception text, clearing the error indicator. Needs the GIL.
+std::string python_error(const char* what) {
+    PyObject *type, *value, *trace;
+    PyErr_Fetch(&type, &value, &trace);
+    std::string msg = what;
+    if (value) {
+        if (PyObject* s = PyObject_Str(value)) {
+            if (const char* c = PyUnicode_AsUTF8(s)) msg += std::string(": ") + c;
+            Py_DECREF(s);
+        }
+    }
+    Py_XDECREF(type);
+    Py_XDECREF(value);
+    Py_XDECREF(trace);
+    PyErr_Clear();
+    return msg;
+}
+
+bool parse_batch(NlpBatch& b) {
+    auto need = [&](size_t n) { return n <= b.bytes; };
+    if (!need(4)) return fail("proposal buffer truncated");
+    std::memcpy(&b.count, b.data.get(), 4);
+    size_t table = 4 + size_t(b.count) * 9 * 4;
+    if (!need(table)) return fail("proposal buffer truncated");
+    b.spans = reinterpret_cast<const uint32_t*>(b.data.get() + 4);
+    b.layers = b.spans + size_t(b.count) * 8;
+    b.blob = b.data.get() + table;
+    b.blob_bytes = b.bytes - table;
+    for (size_t i = 0; i < size_t(b.count) * 8; i += 2)
+        if (size_t(b.spans[i]) + b.spans[i + 1] > b.blob_bytes) return fail("proposal span out of range");
+    return true;
+}
+
+// The interpreter lives on one thread. Jobs queue up while it runs Python; each wakeup
+// takes the GIL once and runs everything queued.
+class Bridge {
+    struct Job {
+        std::string packed;
+        std::promise<std::pair<NlpBatch*, std::string>> done;
+    };
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::unique_ptr<Job>> queue;
+    bool stopping = false;
+    PyObject* core = nullptr;       // NLPCore()
+    PyObject* method = nullptr;     // core.propose_mutations_batch
+
+    void run(std::string module_dir, std::promise<std::string> started) {
+        PyConfig config;
+        PyConfig_InitIsolatedConfig(&config);
+        config.install_signal_handlers = 0;
+        PyStatus st = Py_InitializeFromConfig(&config);
+        PyConfig_Clear(&config);
+        if (PyStatus_Exception(st)) {
+            started.set_value(std::string("Py_InitializeFromConfig: ") + (st.err_msg ? st.err_msg : "failed"));
+            return;
+        }
+        std::string err = import(module_dir);
+        PyThreadState* ts = PyEval_SaveThread();
+        started.set_value(err);
+        if (err.empty()) serve();
+        PyEval_RestoreThread(ts);
+        Py_CLEAR(method);
+        Py_CLEAR(core);
+        Py_FinalizeEx();
+    }
+
+    std::string import(const std::string& module_dir) {
+        PyObject* path = PySys_GetObject("path"); // borrowed
+        PyObject* dir = PyUnicode_FromString(module_dir.c_str());
+        if (!path || !dir || PyList_Insert(path, 0, dir) != 0) {
+            Py_XDECREF(dir);
+            return python_error("sys.path");
+        }
+        Py_DECREF(dir);
+        PyObject* mod = PyImport_ImportModule("nlp_core");
+        if (!mod) return python_error("import nlp_core");
+        core = PyObject_CallMethod(mod, "NLPCore", nullptr);
+        Py_DECREF(mod);
+        if (!core) return python_error("NLPCore()");
+        method = PyObject_GetAttrString(core, "propose_mutations_batch");
+        if (!method) return python_error("NLPCore.propose_mutations_batch");
+        return {};
+    }
+
+    void serve() {
+        while (true) {
+            std::deque<std::unique_ptr<Job>> jobs;
+            {
+                std::unique_lock lock(mutex);
+                cv.wait(lock, [&] { return stopping || !queue.empty(); });
+                if (stopping && queue.empty()) return;
+                jobs.swap(queue);
+            }
+            PyGILState_STATE gil = PyGILState_Ensure();
+            for (auto& job : jobs) job->done.set_value(call(job->packed));
+            PyGILState_Release(gil);
+        }
+    }
+
+    // One Python call; the result is copied out before the bytes object is released.
+    std::pair<NlpBatch*, std::string> call(const std::string& packed) {
+        PyObject* arg = PyBytes_FromStringAndSize(packed.data(), static_cast<Py_ssize_t>(packed.size()));
+        PyObject* res = arg ? PyObject_CallOneArg(method, arg) : nullptr;
+        Py_XDECREF(arg);
+        if (!res) return {nullptr, python_error("propose_mutations_batch")};
+        char* data;
+        Py_ssize_t len;
+        if (PyBytes_AsStringAndSize(res, &data, &len) != 0) {
+            Py_DECREF(res);
+            return {nullptr, python_error("propose_mutations_batch result")};
+        }
+        auto* b = new NlpBatch;
+        b->bytes = static_cast<size_t>(len);
+        b->data.reset(new char[b->bytes ? b->bytes : 1]);
+        std::memcpy(b->data.get(), data, b->bytes);
+        Py_DECREF(res);
+        if (!parse_batch(*b)) {
+            delete b;
+            return {nullptr, last_error};
+        }
+        return {b, {}};
+    }
+
+public:
+    bool start(const std::string& module_dir) {
+        std::promise<std::string> started;
+        auto ready = started.get_future();
+        worker = std::thread(&Bridge::run, this, module_dir, std::move(started));
+        std::string err = ready.get();
+        if (err.empty()) return true;
+        stop();
+        return fail(err);
+    }
+    void stop() {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+            for (auto& job : queue) job->done.set_value({nullptr, "bridge stopped"});
+            queue.clear();
+        }
+        cv.notify_one();
+        if (worker.joinable()) worker.join();
+    }
+    NlpBatch* submit(std::string packed) {
+        auto job = std::make_unique<Job>();
+        job->packed = std::move(packed);
+        auto result = job->done.get_future();
+        {
+            std::lock_guard lock(mutex);
+            if (stopping) {
+                fail("bridge stopped");
+                return nullptr;
+            }
+            queue.push_back(std::move(job));
+        }
+        cv.notify_one();
+        auto [batch, err] = result.get();
+        if (!batch) fail(err);
+        return batch;
+    }
+};
+
+std::mutex bridge_mutex;
+std::shared_ptr<Bridge> bridge; // callers hold a reference across a call, so stop cannot free it
+
+std::shared_ptr<Bridge> running() {
+    std::lock_guard lock(bridge_mutex);
+    return bridge;
+}
+
+bool append_field(std::string& out, const char* s) {
+    if (!s) return fail("null string in request");
+    for (const char* p = s; *p; ++p)
+        if (*p == RECORD_SEP || *p == FIELD_SEP) return fail("request string contains a separator byte");
+    out += s;
+    out += FIELD_SEP;
+    return true;
+}
+
+} // namespace
+
+extern "C" {
+
+int nlp_bridge_start(const char* module_dir) {
+    std::lock_guard lock(bridge_mutex);
+    if (bridge) return 0;
+    std::string dir = module_dir ? module_dir : "";
+    if (dir.empty()) {
+        const char* env = std::getenv("NLP_PYTHON_PATH");
+        dir = env && *env ? env : "../python_nlp";
+    }
+    auto b = std::make_shared<Bridge>();
+    if (!b->start(dir)) return -1;
+    bridge = std::move(b);
+    return 0;
+}
+
+void nlp_bridge_stop(void) {
+    std::shared_ptr<Bridge> b;
+    {
+        std::lock_guard lock(bridge_mutex);
+        b = std::move(bridge);
+    }
+    if (b) b->stop();
+}
+
+const char* nlp_bridge_error(void) { return last_error.c_str(); }
+
+int nlp_propose_batch(const NlpRequest* requests, size_t n, NlpBatch** out) {
+    *out = nullptr;
+    std::shared_ptr<Bridge> b = running();
+    if (!b) {
+        fail("bridge not started");
+        return -1;
+    }
+    // key US from US layer (US to)* RS, per request
+    std::string packed;
+    packed.reserve(n * 64);
+    for (size_t i = 0; i < n; ++i) {
+        const NlpRequest& r = requests[i];
+        if (!append_field(packed, r.identity_key) || !append_field(packed, r.from_surface)) return -1;
+        packed += std::to_string(r.layer);
+        packed += FIELD_SEP;
+        for (size_t k = 0; k < r.to_count; ++k)
+            if (!append_field(packed, r.to_surfaces[k])) return -1;
+        packed.back() = RECORD_SEP;
+    }
+    *out = b->submit(std::move(packed));
+    return *out ? 0 : -1;
+}
+
+size_t nlp_batch_size(const NlpBatch* batch) { return batch ? batch->count : 0; }
+
+int nlp_batch_get(const NlpBatch* batch, size_t i, NlpProposalView* view) {
+    if (!batch || i >= batch->count) return -1;
+    const uint32_t* s = batch->spans + i * 8;
+    view->identity_key = batch->blob + s[0];
+    view->identity_key_len = s[1];
+    view->from_surface = batch->blob + s[2];
+    view->from_len = s[3];
+    view->to_surface = batch->blob + s[4];
+    view->to_len = s[5];
+    view->proposal_type = batch->blob + s[6];
+    view->type_len = s[7];
+    view->layer = batch->layers[i];
+    return 0;
+}
+
+void nlp_batch_free(NlpBatch* batch) { delete batch; }
+
+void call_python_nlp(void) {
+    if (nlp_bridge_start(nullptr) != 0) {
+        std::fprintf(stderr, "python bridge: %s\n", nlp_bridge_error());
+        return;
+    }
+    const char* to[] = {"the voice", "the silence"};
+    NlpRequest req = {"e1b2c3d4e5f6a7b8c9d0e1f2a3b4c5d6", "the man", to, 2, 1};
+    NlpBatch* batch;
+    if (nlp_propose_batch(&req, 1, &batch) != 0) {
+        std::fprintf(stderr, "python bridge: %s\n", nlp_bridge_error());
+    } else {
+        NlpProposalView p;
+        for (size_t i = 0; nlp_batch_get(batch, i, &p) == 0; ++i)
+            std::printf("Propose: %.*s -> %.*s [%.*s] (layer %u) for %.*s\n", (int)p.from_len, p.from_surface,
+                        (int)p.to_len, p.to_surface, (int)p.type_len, p.proposal_type, p.layer,
+                        (int)p.identity_key_len, p.identity_key);
+        nlp_batch_free(batch);
+    }
+    nlp_bridge_stop();
+}
+
+} // extern "C"
@@ -0,0 +1,61 @@
+// Embedded Python Bridge
+// In-process calls into python_nlp/nlp_core.py from C and C++, batched per GIL acquisition
+// Author: 1proprogrammerchant
+// C99 / C++17
+//
+// One worker thread owns the interpreter. Callers hand it whole batches of identity keys;
+// it takes the GIL once per drain of its queue, calls NLPCore.propose_mutations_batch, and
+// copies the packed result into a single buffer. Proposals are read from that buffer as
+// views: no PyObject ever crosses to the caller.
+#ifndef PYTHON_BRIDGE_H
+#define PYTHON_BRIDGE_H
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct NlpRequest {
+    const char* identity_key;
+    const char* from_surface;
+    const char* const* to_surfaces;
+    size_t to_count;
+    uint32_t layer;
+} NlpRequest;
+
+// Strings are not NUL-terminated; they live as long as the batch.
+typedef struct NlpProposalView {
+    const char* identity_key;
+    const char* from_surface;
+    const char* to_surface;
+    const char* proposal_type;
+    uint32_t identity_key_len, from_len, to_len, type_len;
+    uint32_t layer;
+} NlpProposalView;
+
+typedef struct NlpBatch NlpBatch;
+
+// Starts the worker and imports nlp_core from module_dir (NULL: $NLP_PYTHON_PATH, else
+// ../python_nlp). Returns 0 on success, -1 with nlp_bridge_error() set. Idempotent.
+int nlp_bridge_start(const char* module_dir);
+// Finalizes the interpreter and joins the worker. Pending calls fail.
+void nlp_bridge_stop(void);
+// Last error on the calling thread, or "".
+const char* nlp_bridge_error(void);
+
+// Proposes mutations for n requests in one interpreter call (one batch may hold
+// thousands of keys). Blocks until done. Returns 0 and a batch to free, or -1.
+int nlp_propose_batch(const NlpRequest* requests, size_t n, NlpBatch** out);
+size_t nlp_batch_size(const NlpBatch* batch);
+// Fills *view with proposal i; returns 0, or -1 if i is out of range.
+int nlp_batch_get(const NlpBatch* batch, size_t i, NlpProposalView* view);
+void nlp_batch_free(NlpBatch* batch);
+
+// Runs the nlp_core example through the bridge and prints the proposals.
+void call_python_nlp(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
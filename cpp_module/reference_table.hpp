@@ -0,0 +1,274 @@
+// Struct-of-Arrays Reference Table
+// Hot reference columns + vectorized OntState -> RefIntegrityStatus classification through an IntegrityPolicy
+// Author: 1proprogrammerchant
+// C++17+ required
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+#include "integrity_policy.hpp"
+#include "slab_storage.hpp"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define RIE_X86 1
+#endif
+
+namespace refkernel {
+
+// Scalar kernel: status[i] = table[created[i]][state[i]], one load per reference
+inline void classify_scalar(const uint8_t* state, const uint8_t* created, uint8_t* status, size_t n,
+                            const IntegrityPolicy& p = default_policy()) {
+    const uint8_t* table = p.table.data();
+    for (size_t i = 0; i < n; ++i) status[i] = table[created[i] * ONT_STATE_COUNT + state[i]];
+}
+
+#ifdef RIE_X86
+// Uniform policies only (status depends on the new state and on created == new):
+// two pshufb lookups by new state, blended on the equality mask. 16 references per step.
+__attribute__((target("ssse3")))
+inline void classify_ssse3(const uint8_t* state, const uint8_t* created, uint8_t* status, size_t n,
+                           const IntegrityPolicy& p) {
+    const __m128i changed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p.changed_lut.data()));
+    const __m128i same = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p.same_lut.data()));
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state + i));
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(created + i));
+        __m128i eq = _mm_cmpeq_epi8(s, c);
+        __m128i r = _mm_or_si128(_mm_and_si128(eq, _mm_shuffle_epi8(same, s)), _mm_andnot_si128(eq, _mm_shuffle_epi8(changed, s)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(status + i), r);
+    }
+    classify_scalar(state + i, created + i, status + i, n - i, p);
+}
+
+// AVX2: 32 references per step; compiled for AVX2 regardless of -march, picked at runtime
+__attribute__((target("avx2")))
+inline void classify_avx2(const uint8_t* state, const uint8_t* created, uint8_t* status, size_t n,
+                          const IntegrityPolicy& p) {
+    const __m256i changed = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p.changed_lut.data())));
+    const __m256i same = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p.same_lut.data())));
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state + i));
+        __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(created + i));
+        __m256i r = _mm256_blendv_epi8(_mm256_shuffle_epi8(changed, s), _mm256_shuffle_epi8(same, s), _mm256_cmpeq_epi8(s, c));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(status + i), r);
+    }
+    classify_ssse3(state + i, created + i, status + i, n - i, p);
+}
+#endif
+
+inline bool has_avx2() {
+#ifdef RIE_X86
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    return avx2;
+#else
+    return false;
+#endif
+}
+inline bool has_ssse3() {
+#ifdef RIE_X86
+    static const bool ssse3 = __builtin_cpu_supports("ssse3");
+    return ssse3;
+#else
+    return false;
+#endif
+}
+
+// State bytes must be valid OntState values. Non-uniform policies take the scalar table.
+inline void classify(const uint8_t* state, const uint8_t* created, uint8_t* status, size_t n,
+                     const IntegrityPolicy& p = default_policy()) {
+#ifdef RIE_X86
+    if (p.uniform && has_avx2()) return classify_avx2(state, created, status, n, p);
+    if (p.uniform && has_ssse3()) return classify_ssse3(state, created, status, n, p);
+#endif
+    classify_scalar(state, created, status, n, p);
+}
+
+} // namespace refkernel
+
+// Hot reference fields as packed columns, one row per reference slab slot: row i holds
+// the reference whose handle_index is i (id 0: none). MemoryPool keeps one, written on
+// create and by every status change; the engine validates and revalidates on the
+// columns and writes a ReferenceObject back only when its status changes. Candidate
+// sets and history stay in the objects.
+//
+// Rows live in chunks allocated on first use, so a creator never moves another row.
+// A row's columns are written before its id is published (release) and readers skip
+// rows whose id they do not see. status and last_layer change only under the engine's
+// status lock, or while nothing else runs (journal replay, snapshot load).
+class ReferenceTable {
+    static constexpr unsigned CHUNK_BITS = 10; // as the reference slab
+    static constexpr size_t CHUNK_SIZE = size_t(1) << CHUNK_BITS;
+    static constexpr size_t MAX_CHUNKS = size_t(1) << 16;
+
+    struct Chunk {
+        std::atomic<size_t> ids[CHUNK_SIZE];
+        size_t targets[CHUNK_SIZE];
+        uint8_t created_state[CHUNK_SIZE];
+        uint8_t status[CHUNK_SIZE];
+        uint64_t last_layer[CHUNK_SIZE];
+    };
+
+    std::unique_ptr<std::atomic<Chunk*>[]> dir;
+    std::atomic<size_t> used{0}; // chunks below this may be allocated
+
+    Chunk* chunk(size_t c) const { return c < MAX_CHUNKS ? dir[c].load(std::memory_order_acquire) : nullptr; }
+    Chunk* make(size_t c) {
+        if (c >= MAX_CHUNKS) throw std::bad_alloc();
+        Chunk* k = dir[c].load(std::memory_order_acquire);
+        if (!k) {
+            Chunk* fresh = new Chunk(); // zeroed: no ids
+            if (dir[c].compare_exchange_strong(k, fresh, std::memory_order_acq_rel)) k = fresh;
+            else delete fresh;
+        }
+        size_t u = used.load(std::memory_order_relaxed);
+        while (u <= c && !used.compare_exchange_weak(u, c + 1, std::memory_order_release)) {}
+        return k;
+    }
+    // The chunk holding rid's row and the row's offset in it; nullptr unless the row is rid's.
+    Chunk* row(size_t rid, size_t& i) const {
+        Chunk* k = chunk(handle_index(rid) >> CHUNK_BITS);
+        i = handle_index(rid) & (CHUNK_SIZE - 1);
+        return k && k->ids[i].load(std::memory_order_acquire) == rid ? k : nullptr;
+    }
+
+public:
+    ReferenceTable() : dir(new std::atomic<Chunk*>[MAX_CHUNKS]) {
+        for (size_t c = 0; c < MAX_CHUNKS; ++c) dir[c].store(nullptr, std::memory_order_relaxed);
+    }
+    ~ReferenceTable() {
+        for (size_t c = 0; c < MAX_CHUNKS; ++c) delete dir[c].load(std::memory_order_relaxed);
+    }
+    ReferenceTable(const ReferenceTable&) = delete;
+    ReferenceTable& operator=(const ReferenceTable&) = delete;
+
+    // Writes rid's row and publishes it.
+    void put(size_t rid, size_t target, OntState created, RefIntegrityStatus st, size_t layer) {
+        Chunk* k = make(handle_index(rid) >> CHUNK_BITS);
+        const size_t i = handle_index(rid) & (CHUNK_SIZE - 1);
+        k->targets[i] = target;
+        k->created_state[i] = static_cast<uint8_t>(created);
+        k->status[i] = static_cast<uint8_t>(st);
+        k->last_layer[i] = layer;
+        k->ids[i].store(rid, std::memory_order_release);
+    }
+    void erase(size_t rid) {
+        size_t i;
+        if (Chunk* k = row(rid, i)) k->ids[i].store(0, std::memory_order_release);
+    }
+    void set(size_t rid, RefIntegrityStatus st, size_t layer) {
+        size_t i;
+        if (Chunk* k = row(rid, i)) {
+            k->status[i] = static_cast<uint8_t>(st);
+            k->last_layer[i] = layer;
+        }
+    }
+    // Layer of rid's latest validation; 0 if it has no row.
+    size_t last_layer(size_t rid) const {
+        size_t i;
+        Chunk* k = row(rid, i);
+        return k ? k->last_layer[i] : 0;
+    }
+    // Rows with an id; bytes: the chunks behind them.
+    size_t size() const {
+        size_t n = 0;
+        for (size_t c = 0, u = used.load(std::memory_order_acquire); c < u; ++c)
+            if (Chunk* k = chunk(c))
+                for (size_t i = 0; i < CHUNK_SIZE; ++i) n += k->ids[i].load(std::memory_order_relaxed) != 0;
+        return n;
+    }
+    size_t bytes() const {
+        size_t n = MAX_CHUNKS * sizeof(void*);
+        for (size_t c = 0, u = used.load(std::memory_order_acquire); c < u; ++c) n += chunk(c) ? sizeof(Chunk) : 0;
+        return n;
+    }
+
+    // Reclassifies the rows of rids (the references into one entity) for its new state;
+    // ids without a row are skipped. Large fan-ins go through the kernel in one batch.
+    // touched(rid, old, now) sees every row, after its columns are written. Returns rows.
+    template <typename F>
+    size_t validate(const std::vector<size_t>& rids, OntState newState, size_t layer, const IntegrityPolicy& p, F&& touched) {
+        thread_local std::vector<Chunk*> chunks;
+        thread_local std::vector<uint32_t> offsets;
+        thread_local std::vector<uint8_t> created, state, status;
+        chunks.clear();
+        offsets.clear();
+        created.clear();
+        for (size_t rid : rids) {
+            size_t i;
+            if (Chunk* k = row(rid, i)) {
+                chunks.push_back(k);
+                offsets.push_back(static_cast<uint32_t>(i));
+                created.push_back(k->created_state[i]);
+            }
+        }
+        const size_t n = chunks.size();
+        status.resize(n);
+        if (n >= 32) {
+            state.assign(n, static_cast<uint8_t>(newState));
+            refkernel::classify(state.data(), created.data(), status.data(), n, p);
+        } else {
+            const uint8_t* column = p.table.data() + static_cast<size_t>(newState);
+            for (size_t j = 0; j < n; ++j) status[j] = column[created[j] * ONT_STATE_COUNT];
+        }
+        for (size_t j = 0; j < n; ++j) {
+            Chunk* k = chunks[j];
+            const uint32_t i = offsets[j];
+            const uint8_t old = k->status[i];
+            k->status[i] = status[j];
+            k->last_layer[i] = layer;
+            touched(k->ids[i].load(std::memory_order_relaxed), static_cast<RefIntegrityStatus>(old),
+                    static_cast<RefIntegrityStatus>(status[j]));
+        }
+        return n;
+    }
+
+    // One sweep over every row, a chunk at a time: gather the stale rows' target states,
+    // classify in bulk, write back. states, ids and layers (the layer of each entity's
+    // current state) are indexed by entity slot. A row is stale when it was last
+    // validated before its target's current state, or its target's slot holds another
+    // id (gone, or reused: classifies as Collapsed). Other rows keep what validation,
+    // cascades or resolution wrote. Rows targeting external entities, and rows whose
+    // target is Split (its candidates come only with the state change), are left alone.
+    // changed(rid, now) is called for each row whose status changed. Returns rows swept.
+    template <typename F>
+    size_t revalidate_all(const std::vector<uint8_t>& states, const std::vector<size_t>& ids,
+                          const std::vector<size_t>& layers, size_t layer, const IntegrityPolicy& p, F&& changed) {
+        const uint8_t gone = static_cast<uint8_t>(OntState::Collapsed);
+        const uint8_t split = static_cast<uint8_t>(OntState::Split);
+        uint8_t state[CHUNK_SIZE], created[CHUNK_SIZE], status[CHUNK_SIZE];
+        uint32_t rows[CHUNK_SIZE];
+        size_t swept = 0;
+        for (size_t c = 0, u = used.load(std::memory_order_acquire); c < u; ++c) {
+            Chunk* k = chunk(c);
+            if (!k) continue;
+            size_t n = 0;
+            for (uint32_t i = 0; i < CHUNK_SIZE; ++i) {
+                if (!k->ids[i].load(std::memory_order_acquire)) continue;
+                const size_t t = k->targets[i];
+                if (is_external(t)) continue;
+                const uint32_t slot = handle_index(t);
+                const bool live = slot < ids.size() && ids[slot] == t;
+                if (live && (k->last_layer[i] >= layers[slot] || states[slot] == split)) continue;
+                rows[n] = i;
+                state[n] = live ? states[slot] : gone;
+                created[n++] = k->created_state[i];
+            }
+            refkernel::classify(state, created, status, n, p);
+            for (size_t j = 0; j < n; ++j) {
+                const uint32_t i = rows[j];
+                k->last_layer[i] = layer;
+                if (k->status[i] == status[j]) continue;
+                k->status[i] = status[j];
+                changed(k->ids[i].load(std::memory_order_relaxed), static_cast<RefIntegrityStatus>(status[j]));
+            }
+            swept += n;
+        }
+        return swept;
+    }
+};
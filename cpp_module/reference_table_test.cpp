@@ -0,0 +1,80 @@
+// Reference Table Revalidation Test
+// revalidate_all must reclassify only references left stale by their target, and keep
+// what propagation and split resolution wrote
+// Author: 1proprogrammerchant
+// C++17+ required
+// Build: g++ -std=c++17 -O2 -pthread reference_table_test.cpp -o reference_table_test && ./reference_table_test
+// Output: one line per check; exit status 1 if any failed.
+#include <cstdio>
+#include "split_resolver.hpp"
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    std::printf("%s %s\n", ok ? "PASS" : "FAIL", what);
+    failures += !ok;
+}
+
+static bool status_is(MemoryPool& pool, size_t rid, RefIntegrityStatus s) {
+    ReferenceObject* r = pool.get_reference(rid);
+    return r && r->integrityStatus == s;
+}
+
+// Layer 2: a collapse cascades, a split is resolved; layer 3: states set outside the
+// engine, then one sweep.
+static void propagate_resolve_revalidate() {
+    MemoryPool pool;
+    ReferentialIntegrityEngine rie(pool);
+    size_t room = pool.create_entity("the room", {"place"}, OntState::Defined, 1)->id;
+    size_t man = pool.create_entity("the man", {"human", "male"}, OntState::Defined, 1)->id;
+    size_t voice = pool.create_entity("the voice", {"voice"}, OntState::Defined, 1)->id;
+    size_t figure = pool.create_entity("the figure", {"human"}, OntState::Defined, 1)->id;
+    size_t cup = pool.create_entity("the cup", {"object"}, OntState::Defined, 1)->id;
+    size_t lamp = pool.create_entity("the lamp", {"object"}, OntState::Defined, 1)->id;
+    size_t in_room = pool.create_reference(man, room, OntState::Defined, 1)->id;
+    size_t says = pool.create_reference(voice, man, OntState::Defined, 1)->id;
+    size_t seen = pool.create_reference(man, figure, OntState::Defined, 1)->id;
+    size_t holds = pool.create_reference(voice, cup, OntState::Defined, 1)->id;
+    size_t lit = pool.create_reference(voice, lamp, OntState::Defined, 1)->id;
+
+    size_t person = pool.create_entity("the figure (person)", {"human", "male"}, OntState::Split, 2)->id;
+    size_t statue = pool.create_entity("the figure (statue)", {"object"}, OntState::Split, 2)->id;
+    size_t mug = pool.create_entity("the cup (mug)", {"object"}, OntState::Split, 2)->id;
+    size_t bowl = pool.create_entity("the cup (bowl)", {"object"}, OntState::Split, 2)->id;
+    rie.apply_state_changes({{room, OntState::Collapsed, 2, {}},
+                             {figure, OntState::Split, 2, {person, statue}},
+                             {cup, OntState::Split, 2, {mug, bowl}}});
+    rie.propagate_integrity(room, OntState::Collapsed, 2);
+    check(status_is(pool, says, RefIntegrityStatus::Invalidated), "propagate: cascade invalidates the source's references");
+    SplitResolver resolver(rie);
+    check(resolver.run({seen}, 2).resolved == 1, "resolve: split reference resolved");
+    check(status_is(pool, seen, RefIntegrityStatus::IdentitySplit), "resolve: IdentitySplit");
+    check(status_is(pool, holds, RefIntegrityStatus::Unresolved) && pool.get_reference(holds)->candidateTargets.size() == 2,
+          "split: unresolved with both aspects");
+    pool.commit_layer(2);
+
+    // Not through the engine: the cup is whole again, the lamp is gone
+    for (auto [eid, s] : {std::pair{cup, OntState::Defined}, std::pair{lamp, OntState::Collapsed}}) {
+        Entity* e = pool.get_entity(eid);
+        e->state = s;
+        e->temporal_layer = 3;
+        e->record_version();
+    }
+    size_t changed = rie.revalidate_all(3);
+    pool.commit_layer(3);
+    check(changed == 2, "revalidate: only the stale references change");
+    check(status_is(pool, in_room, RefIntegrityStatus::Invalidated), "revalidate: direct status kept");
+    check(status_is(pool, says, RefIntegrityStatus::Invalidated), "revalidate: cascade kept");
+    check(status_is(pool, seen, RefIntegrityStatus::IdentitySplit) && pool.get_reference(seen)->candidateTargets.size() == 1,
+          "revalidate: resolution kept");
+    check(status_is(pool, holds, RefIntegrityStatus::Valid) && pool.get_reference(holds)->candidateTargets.empty(),
+          "revalidate: stale split reference valid, candidates cleared");
+    check(status_is(pool, lit, RefIntegrityStatus::Invalidated), "revalidate: stale reference invalidated");
+    check(rie.revalidate_all(4) == 0, "revalidate: second sweep changes nothing");
+}
+
+int main() {
+    propagate_resolve_revalidate();
+    std::printf("%s\n", failures ? "FAILED" : "all checks passed");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,610 @@
+// RIE Benchmarks
+// Synthetic graphs for the pool and engine hot paths; AoS vs SoA revalidation kernels
+// Author: 1proprogrammerchant
+// C++17+ required
+// Build: g++ -std=c++17 -O2 -pthread rie_bench.cpp -o rie_bench
+// Usage: ./rie_bench [--suite all|graph|kernels|observers|identities|resolver|shards|reclaim] [--entities N] [--refs N | --fanin F]
+//                    [--skew S] [--split-rate R] [--merge-rate R] [--threads T] [--ops N] [--observers N] [--shards N] [--seed N]
+//                    [--policy standard|reinterpretation_valid|terminal_only]
+// Output: one JSON object per line; every line carries the graph shape so runs can be diffed.
+//         The graph suite ends with the hot-path counters it accumulated (rie_metrics.hpp).
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <unistd.h>
+#include "identity_union_find.hpp"
+#include "observer_overlay.hpp"
+#include "oesm_highperf.hpp"
+#include "pool_compactor.hpp"
+#include "reference_table.hpp"
+#include "sharded_rie.hpp"
+#include "split_resolver.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchConfig {
+    std::string suite = "all";
+    size_t entities = 100000;
+    size_t refs = 0;      // 0: entities * fanin
+    double fanin = 8;     // mean incoming references per entity
+    double skew = 1;      // target = floor(n * u^skew); 1 is uniform, larger concentrates fan-in
+    double split_rate = 0.05;
+    double merge_rate = 0.05;
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t ops = 10000;   // state changes per latency benchmark
+    size_t observers = 4096;
+    size_t shards = 4;    // largest shard count for the shards suite
+    const IntegrityPolicy* policy = &default_policy(); // classification rules for the kernel suite
+    uint64_t seed = 42;
+};
+
+static BenchConfig cfg;
+
+template <typename F>
+static double time_ns(F&& fn, int reps = 5) {
+    double best = 1e300;
+    for (int r = 0; r < reps; ++r) {
+        auto t0 = Clock::now();
+        fn();
+        best = std::min(best, std::chrono::duration<double, std::nano>(Clock::now() - t0).count());
+    }
+    return best;
+}
+
+static double ns_since(Clock::time_point t0) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+}
+
+static size_t rss_bytes() {
+    long pages = 0, resident = 0;
+    if (FILE* f = std::fopen("/proc/self/statm", "r")) {
+        if (std::fscanf(f, "%ld %ld", &pages, &resident) != 2) resident = 0;
+        std::fclose(f);
+    }
+    return static_cast<size_t>(resident) * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+static void begin_line(const char* bench, const char* impl) {
+    std::printf("{\"bench\":\"%s\",\"impl\":\"%s\",\"entities\":%zu,\"refs\":%zu,\"threads\":%zu", bench, impl,
+                cfg.entities, cfg.refs, cfg.threads);
+}
+
+static void report(const char* bench, const char* impl, size_t refs, double ns) {
+    begin_line(bench, impl);
+    std::printf(",\"ns_per_ref\":%.3f}\n", ns / refs);
+}
+
+static void report_throughput(const char* bench, size_t threads, size_t ops, double ns) {
+    begin_line(bench, "pool");
+    std::printf(",\"op_threads\":%zu,\"ops\":%zu,\"ops_per_sec\":%.0f}\n", threads, ops, ops / (ns * 1e-9));
+}
+
+static void report_latency(const char* bench, const char* impl, std::vector<double>& ns, size_t touched) {
+    if (ns.empty()) return;
+    std::sort(ns.begin(), ns.end());
+    auto pct = [&](double p) { return ns[std::min(ns.size() - 1, static_cast<size_t>(p * ns.size()))]; };
+    double sum = 0;
+    for (double v : ns) sum += v;
+    begin_line(bench, impl);
+    std::printf(",\"calls\":%zu,\"refs_touched\":%zu,\"mean_ns\":%.0f,\"p50_ns\":%.0f,\"p90_ns\":%.0f,\"p99_ns\":%.0f,"
+                "\"max_ns\":%.0f}\n", ns.size(), touched, sum / ns.size(), pct(0.5), pct(0.9), pct(0.99), ns.back());
+}
+
+// Runs fn(thread, begin, end) over [0, n) split across t threads.
+template <typename F>
+static void run_threads(size_t t, size_t n, F&& fn) {
+    std::vector<std::thread> ts;
+    for (size_t i = 0; i < t; ++i) ts.emplace_back([&, i] { fn(i, n * i / t, n * (i + 1) / t); });
+    for (auto& th : ts) th.join();
+}
+
+// Synthetic graph: create/lookup throughput, memory per object, and per-call latency of
+// validate_references / propagate_integrity under a split/merge state-change mix.
+static void run_graph_suite() {
+    const metrics::Snapshot start = metrics::snapshot();
+    MemoryPool pool;
+    const size_t nents = cfg.entities, nrefs = cfg.refs;
+    std::vector<size_t> ids(nents);
+    std::vector<std::string> names(nents);
+    for (size_t i = 0; i < nents; ++i) names[i] = "entity" + std::to_string(i);
+    static const std::vector<std::string> vocab[] = {{"male", "human"}, {"female", "human"}, {"voice"}, {"object"}, {"place", "abstract"}};
+
+    size_t rss0 = rss_bytes();
+    auto t0 = Clock::now();
+    run_threads(cfg.threads, nents, [&](size_t, size_t b, size_t e) {
+        for (size_t i = b; i < e; ++i) ids[i] = pool.create_entity(names[i], vocab[i % 5], OntState::Defined, 0)->id;
+    });
+    report_throughput("create_entity", cfg.threads, nents, ns_since(t0));
+    size_t rss1 = rss_bytes();
+
+    // Targets are drawn up front so the timed loop measures only create_reference.
+    std::vector<std::pair<size_t, size_t>> edges(nrefs);
+    std::mt19937_64 rng(cfg.seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    for (auto& [s, t] : edges) {
+        s = ids[rng() % nents];
+        t = ids[std::min(nents - 1, static_cast<size_t>(nents * std::pow(unit(rng), cfg.skew)))];
+    }
+    t0 = Clock::now();
+    run_threads(cfg.threads, nrefs, [&](size_t, size_t b, size_t e) {
+        for (size_t i = b; i < e; ++i) pool.create_reference(edges[i].first, edges[i].second, OntState::Defined, 0);
+    });
+    report_throughput("create_reference", cfg.threads, nrefs, ns_since(t0));
+    size_t rss2 = rss_bytes();
+    edges = {};
+
+    begin_line("memory", "pool");
+    std::printf(",\"bytes_per_entity\":%.1f,\"bytes_per_reference\":%.1f,\"entity_object_bytes\":%zu,\"reference_object_bytes\":%zu}\n",
+                nents ? double(rss1 - rss0) / nents : 0.0, nrefs ? double(rss2 - rss1) / nrefs : 0.0,
+                sizeof(Entity), sizeof(ReferenceObject));
+
+    for (size_t threads : {size_t(1), cfg.threads}) {
+        const size_t lookups = std::max<size_t>(nents, 1000000);
+        std::atomic<size_t> found{0};
+        t0 = Clock::now();
+        run_threads(threads, lookups, [&](size_t ti, size_t b, size_t e) {
+            std::mt19937_64 local(cfg.seed + ti);
+            size_t hits = 0;
+            for (size_t i = b; i < e; ++i) hits += pool.get_entity(ids[local() % nents]) != nullptr;
+            found += hits;
+        });
+        report_throughput("lookup_entity", threads, lookups, ns_since(t0));
+        if (found != lookups) std::fprintf(stderr, "lookup mismatch\n");
+    }
+
+    // State-change mix: Split with two fresh candidates, Merged, or a reinterpretation.
+    auto make_changes = [&](size_t layer0) {
+        std::vector<StateChange> changes;
+        changes.reserve(cfg.ops);
+        for (size_t i = 0; i < cfg.ops; ++i) {
+            size_t eid = ids[rng() % nents];
+            double u = unit(rng);
+            if (u < cfg.split_rate) {
+                size_t a = pool.create_entity(names[rng() % nents], {"aspectA"}, OntState::Split, layer0 + i)->id;
+                size_t b = pool.create_entity(names[rng() % nents], {"aspectB"}, OntState::Split, layer0 + i)->id;
+                changes.push_back({eid, OntState::Split, layer0 + i, {a, b}});
+            } else if (u < cfg.split_rate + cfg.merge_rate) {
+                changes.push_back({eid, OntState::Merged, layer0 + i, {}});
+            } else {
+                changes.push_back({eid, (i & 1) ? OntState::Reinterpreted : OntState::Defined, layer0 + i, {}});
+            }
+        }
+        return changes;
+    };
+
+    ReferentialIntegrityEngine serial(pool);
+    std::vector<double> lat;
+    size_t touched = 0;
+    for (const auto& c : make_changes(1)) {
+        touched += pool.get_entity(c.entityId)->incomingReferences.size();
+        auto t = Clock::now();
+        serial.validate_references(c.entityId, c.newState, c.layer, c.splitIds);
+        lat.push_back(ns_since(t));
+    }
+    report_latency("validate_references", "serial", lat, touched);
+
+    // Both engines replay the same changes from the same all-Valid starting point.
+    WorkStealingPool workers(cfg.threads);
+    ReferentialIntegrityEngine parallel(pool, &workers);
+    auto all_refs = pool.all_references();
+    auto changes = make_changes(1 + cfg.ops);
+    for (auto* engine : {&serial, &parallel}) {
+        for (auto* r : all_refs) {
+            r->integrityStatus = RefIntegrityStatus::Valid;
+            r->lastValidatedLayer = 0;
+            pool.sync_status(*r);
+        }
+        lat.clear();
+        touched = 0;
+        for (const auto& c : changes) {
+            auto t = Clock::now();
+            touched += engine->propagate_integrity(c.entityId, c.newState, c.layer, c.splitIds).references_touched;
+            lat.push_back(ns_since(t));
+        }
+        report_latency("propagate_integrity", engine == &serial ? "serial" : "work_stealing", lat, touched);
+    }
+
+    auto batch = make_changes(1 + 3 * cfg.ops);
+    t0 = Clock::now();
+    serial.apply_state_changes(batch);
+    report_throughput("apply_state_changes", 1, batch.size(), ns_since(t0));
+    std::printf("%s\n", metrics::snapshot().since(start).json().c_str());
+}
+
+// Observer overlays: each observer reinterprets ops / observers entities of its own
+// (a batch per observer), then readers resolve random (observer, reference) pairs.
+static void run_observer_suite() {
+    MemoryPool pool;
+    const size_t nents = cfg.entities, nrefs = cfg.refs;
+    std::vector<size_t> ids(nents), rids(nrefs);
+    for (size_t i = 0; i < nents; ++i) ids[i] = pool.create_entity("entity" + std::to_string(i), {"human"}, OntState::Defined, 0)->id;
+    std::mt19937_64 rng(cfg.seed);
+    for (size_t i = 0; i < nrefs; ++i) rids[i] = pool.create_reference(ids[rng() % nents], ids[rng() % nents], OntState::Defined, 0)->id;
+
+    ObserverRegistry registry(pool);
+    std::vector<ObserverOverlay*> overlays(cfg.observers);
+    for (size_t o = 0; o < cfg.observers; ++o) overlays[o] = &registry.observer("observer" + std::to_string(o));
+    const size_t per = std::max<size_t>(1, cfg.ops / cfg.observers);
+    auto t0 = Clock::now();
+    run_threads(cfg.threads, cfg.observers, [&](size_t t, size_t b, size_t e) {
+        std::mt19937_64 local(cfg.seed + t);
+        std::vector<StateChange> changes;
+        for (size_t o = b; o < e; ++o) {
+            changes.clear();
+            for (size_t i = 0; i < per; ++i)
+                changes.push_back({ids[local() % nents], (i & 1) ? OntState::Collapsed : OntState::Reinterpreted, 1, {}});
+            overlays[o]->apply_state_changes(changes);
+        }
+    });
+    report_throughput("overlay_apply", cfg.threads, cfg.observers * per, ns_since(t0));
+
+    size_t entity_ov = 0, ref_ov = 0;
+    for (auto* o : overlays) entity_ov += o->entity_overrides(), ref_ov += o->reference_overrides();
+    size_t bytes = registry.bytes();
+    begin_line("memory", "overlay");
+    std::printf(",\"observers\":%zu,\"entity_overrides\":%zu,\"reference_overrides\":%zu,\"bytes_per_observer\":%.1f,"
+                "\"bytes_per_override\":%.1f,\"empty_overlay_bytes\":%zu}\n", cfg.observers, entity_ov, ref_ov,
+                double(bytes) / cfg.observers, entity_ov + ref_ov ? double(bytes) / (entity_ov + ref_ov) : 0.0,
+                ObserverOverlay(pool, "empty").bytes());
+
+    for (size_t threads : {size_t(1), cfg.threads}) {
+        const size_t reads = std::max<size_t>(nrefs, 1000000);
+        std::atomic<size_t> found{0};
+        t0 = Clock::now();
+        run_threads(threads, reads, [&](size_t ti, size_t b, size_t e) {
+            std::mt19937_64 local(cfg.seed + ti);
+            size_t hits = 0;
+            RefIntegrityStatus s;
+            for (size_t i = b; i < e; ++i) hits += overlays[local() % cfg.observers]->reference_status(rids[local() % nrefs], s);
+            found += hits;
+        });
+        report_throughput("overlay_read", threads, reads, ns_since(t0));
+        if (found != reads) std::fprintf(stderr, "overlay read mismatch\n");
+    }
+}
+
+// Coreference-style merging: mentions collapse into clusters of a few entities each,
+// layer by layer, then references are resolved to their canonical entity.
+static void run_identity_suite() {
+    MemoryPool pool;
+    const size_t nents = cfg.entities, nrefs = cfg.refs;
+    std::vector<size_t> ids(nents), rids(nrefs);
+    for (size_t i = 0; i < nents; ++i) ids[i] = pool.create_entity("entity" + std::to_string(i), {"human"}, OntState::Defined, 0)->id;
+    std::mt19937_64 rng(cfg.seed);
+    for (size_t i = 0; i < nrefs; ++i) rids[i] = pool.create_reference(ids[rng() % nents], ids[rng() % nents], OntState::Defined, 0)->id;
+
+    IdentityUnionFind uf(pool);
+    const size_t merges = static_cast<size_t>(nents * cfg.merge_rate * 10), layers = 100;
+    auto t0 = Clock::now();
+    for (size_t i = 0; i < merges; ++i) {
+        size_t a = rng() % nents, cluster = a / 16 * 16; // clusters of 16 mentions
+        uf.merge(ids[a], ids[std::min(nents - 1, cluster + rng() % 16)], 1 + i * layers / std::max<size_t>(merges, 1));
+    }
+    report_throughput("identity_merge", 1, merges, ns_since(t0));
+
+    for (size_t threads : {size_t(1), cfg.threads}) {
+        const size_t reads = std::max<size_t>(nrefs, 1000000);
+        std::atomic<size_t> found{0};
+        t0 = Clock::now();
+        run_threads(threads, reads, [&](size_t ti, size_t b, size_t e) {
+            std::mt19937_64 local(cfg.seed + ti);
+            size_t hits = 0;
+            for (size_t i = b; i < e; ++i) hits += uf.resolve_reference(rids[local() % nrefs]) != 0;
+            found += hits;
+        });
+        report_throughput("identity_resolve", threads, reads, ns_since(t0));
+        if (found != reads) std::fprintf(stderr, "identity resolve mismatch\n");
+    }
+
+    size_t records = uf.undo_records(), bytes = uf.bytes();
+    t0 = Clock::now();
+    size_t reverted = uf.rollback_to(layers / 2);
+    double rollback_ns = ns_since(t0);
+    begin_line("identity_rollback", "union_find");
+    std::printf(",\"undo_records\":%zu,\"reverted\":%zu,\"rollback_ns\":%.0f,\"merges_left\":%zu,\"bytes\":%zu}\n",
+                records, reverted, rollback_ns, uf.merges(), bytes);
+}
+
+// Split resolution: every target splits into 2-4 aspects that keep most of its attributes
+// and add their own; sources share attributes with one aspect or none. Ranks all the
+// Unresolved references, then times the bitset kernels alone.
+static void run_resolver_suite() {
+    MemoryPool pool;
+    ReferentialIntegrityEngine rie(pool);
+    const size_t nents = cfg.entities, nrefs = cfg.refs, vocab = 200;
+    std::mt19937_64 rng(cfg.seed);
+    auto attrs = [&](size_t n, size_t base) {
+        std::vector<std::string> a;
+        for (size_t k = 0; k < n; ++k) a.push_back("attr" + std::to_string((base + rng() % 24) % vocab));
+        return a;
+    };
+    const size_t ntargets = std::max<size_t>(1, nents / 16);
+    std::vector<size_t> targets(ntargets), sources(nents);
+    std::vector<std::vector<size_t>> aspects(ntargets);
+    for (size_t t = 0; t < ntargets; ++t) {
+        size_t base = rng() % vocab;
+        targets[t] = pool.create_entity("target" + std::to_string(t), attrs(6, base), OntState::Defined, 0)->id;
+        for (size_t k = 2 + rng() % 3; k; --k)
+            aspects[t].push_back(pool.create_entity("aspect", attrs(8, base), OntState::Split, 2)->id);
+    }
+    for (size_t i = 0; i < nents; ++i)
+        sources[i] = pool.create_entity("entity" + std::to_string(i), attrs(5, rng() % vocab), OntState::Defined, 0)->id;
+    for (size_t i = 0; i < nrefs; ++i)
+        pool.create_reference(sources[rng() % nents], targets[rng() % ntargets], OntState::Defined, 1);
+    std::vector<StateChange> splits;
+    for (size_t t = 0; t < ntargets; ++t) splits.push_back({targets[t], OntState::Split, 2, aspects[t]});
+    rie.apply_state_changes(splits);
+
+    ResolverOptions ranking_only;
+    ranking_only.auto_resolve = false;
+    for (size_t threads : {size_t(1), cfg.threads}) {
+        WorkStealingPool workers(threads);
+        SplitResolver resolver(rie, threads > 1 ? &workers : nullptr, ranking_only);
+        auto t0 = Clock::now();
+        ResolveReport r = resolver.run(3);
+        report_throughput("split_rank", threads, r.references.size(), ns_since(t0));
+    }
+    {
+        WorkStealingPool workers(cfg.threads);
+        SplitResolver resolver(rie, cfg.threads > 1 ? &workers : nullptr);
+        auto t0 = Clock::now();
+        ResolveReport r = resolver.run(3);
+        double ns = ns_since(t0);
+        begin_line("split_resolve", "resolver");
+        std::printf(",\"unresolved\":%zu,\"candidates\":%zu,\"resolved\":%zu,\"ns_per_ref\":%.1f}\n",
+                    r.references.size(), r.candidates.size(), r.resolved, r.references.empty() ? 0.0 : ns / r.references.size());
+    }
+
+    const size_t pairs = 1 << 16;
+    std::vector<simkernel::Bits> a(pairs), b(pairs);
+    for (size_t i = 0; i < pairs; ++i) {
+        a[i] = simkernel::Bits{{rng() & rng(), rng() & rng(), rng() & rng(), rng() & rng()}};
+        b[i] = simkernel::Bits{{rng() & rng(), rng() & rng(), rng() & rng(), rng() & rng()}};
+    }
+    std::vector<uint32_t> inter(pairs), uni(pairs);
+    report("jaccard_kernel", "scalar", pairs, time_ns([&] { simkernel::overlap_scalar(a.data(), b.data(), inter.data(), uni.data(), pairs); }));
+#ifdef RIE_X86
+    if (refkernel::has_avx2())
+        report("jaccard_kernel", "avx2", pairs, time_ns([&] { simkernel::overlap_avx2(a.data(), b.data(), inter.data(), uni.data(), pairs); }));
+#endif
+}
+
+// Sharded engine, 1, 2, 4 ... --shards worker processes: ingest of the graph, then --ops
+// state changes (collapses at --split-rate, the rest reinterpretations) in layers of
+// 1000, each closed by a global barrier. Cross-shard messages are the Ungrounded
+// cascades that left one shard for another.
+static void run_shard_suite() {
+    const size_t nents = cfg.entities, nrefs = cfg.refs, per_layer = 1000;
+    for (size_t shards = 1;; shards = std::min(shards * 2, cfg.shards)) {
+        ShardedRIE sh;
+        shard::Options o;
+        o.shards = shards;
+        std::string err;
+        if (!sh.start(o, &err)) {
+            std::fprintf(stderr, "shards: %s\n", err.c_str());
+            return;
+        }
+        std::mt19937_64 rng(cfg.seed);
+        auto t0 = Clock::now();
+        for (size_t i = 0; i < nents; ++i) sh.create_entity(i, OntState::Defined, 0);
+        sh.barrier(0);
+        for (size_t i = 0; i < nrefs; ++i) sh.create_reference(rng() % nents, rng() % nents, OntState::Defined, 0);
+        bool ok = sh.barrier(0, &err);
+        double ingest_ns = ns_since(t0);
+        t0 = Clock::now();
+        for (size_t i = 0; i < cfg.ops && ok; ++i) {
+            double u = std::uniform_real_distribution<double>(0, 1)(rng);
+            size_t layer = 1 + i / per_layer;
+            sh.apply_state_change(rng() % nents, u < cfg.split_rate ? OntState::Collapsed : OntState::Reinterpreted, layer);
+            if ((i + 1) % per_layer == 0 || i + 1 == cfg.ops) ok = sh.barrier(layer, &err);
+        }
+        double change_ns = ns_since(t0);
+        std::vector<shard::ShardStats> st;
+        ok = ok && sh.stats(st, &err);
+        size_t layers = sh.committed_layer();
+        if (!ok || !sh.stop(&err)) {
+            std::fprintf(stderr, "shards: %s\n", err.c_str());
+            return;
+        }
+        uint64_t cross = 0, invalidated = 0;
+        for (const shard::ShardStats& s : st) {
+            cross += s.sent;
+            invalidated += s.status[static_cast<size_t>(RefIntegrityStatus::Invalidated)];
+            if (s.committed_layer != layers) std::fprintf(stderr, "shard committed layer mismatch\n");
+        }
+        begin_line("sharded", "processes");
+        std::printf(",\"shards\":%zu,\"ingest_ops_per_sec\":%.0f,\"changes\":%zu,\"change_ops_per_sec\":%.0f,"
+                    "\"layers\":%zu,\"cross_shard_msgs\":%llu,\"invalidated\":%llu}\n",
+                    shards, (nents + nrefs) / (ingest_ns * 1e-9), cfg.ops, cfg.ops / (change_ns * 1e-9),
+                    layers, static_cast<unsigned long long>(cross), static_cast<unsigned long long>(invalidated));
+        if (shards == cfg.shards) break;
+    }
+}
+
+// A long session: generations of entities and references are created and the previous
+// generation collapses, with and without reclamation between generations. Each
+// generation's layer is committed before reclaiming; a reclaiming run that retires
+// nothing measured a no-op and fails the suite.
+static int run_reclaim_suite() {
+    const size_t generations = 10, nents = std::max<size_t>(cfg.entities / generations, 1), nrefs = cfg.refs / generations;
+    for (bool reclaim : {false, true}) {
+        MemoryPool pool;
+        WorkStealingPool workers(cfg.threads);
+        ReferentialIntegrityEngine rie(pool, &workers);
+        std::mt19937_64 rng(cfg.seed);
+        std::vector<size_t> prev, cur;
+        double work_ns = 0, reclaim_ns = 0;
+        size_t layer = 0, peak_kib = 0;
+        ReclaimStats total;
+        for (size_t g = 0; g < generations; ++g) {
+            auto t0 = Clock::now();
+            ++layer;
+            cur.clear();
+            for (size_t i = 0; i < nents; ++i) cur.push_back(pool.create_entity("g", {}, OntState::Defined, layer)->id);
+            for (size_t i = 0; i < nrefs; ++i) pool.create_reference(cur[rng() % nents], cur[rng() % nents], OntState::Defined, layer);
+            std::vector<StateChange> changes;
+            for (size_t id : prev) changes.push_back({id, OntState::Collapsed, layer, {}});
+            rie.apply_state_changes(changes);
+            pool.commit_layer(layer);
+            prev.swap(cur);
+            work_ns += ns_since(t0);
+            if (reclaim) {
+                t0 = Clock::now();
+                pool.compact_history(layer);
+                ReclaimStats r = pool.reclaim(layer);
+                reclaim_ns += ns_since(t0);
+                total.entities += r.entities, total.references += r.references, total.freed += r.freed, total.chunks += r.chunks;
+            }
+            SlabUsage e = pool.entity_usage(), rs = pool.reference_usage();
+            peak_kib = std::max(peak_kib, (e.bytes + rs.bytes) / 1024);
+        }
+        SlabUsage e = pool.entity_usage(), rs = pool.reference_usage();
+        begin_line("session", reclaim ? "reclaim" : "none");
+        std::printf(",\"generations\":%zu,\"ops_per_sec\":%.0f,\"reclaim_ms_per_generation\":%.3f,\"live_entities\":%zu,"
+                    "\"live_references\":%zu,\"retired\":%zu,\"freed\":%zu,\"chunks_released\":%zu,\"slab_kib\":%zu,\"peak_slab_kib\":%zu}\n",
+                    generations, generations * (2 * nents + nrefs) / (work_ns * 1e-9), reclaim_ns * 1e-6 / generations, e.live,
+                    rs.live, total.entities + total.references, total.freed, total.chunks, (e.bytes + rs.bytes) / 1024, peak_kib);
+        if (reclaim && generations > 1 && !(total.entities + total.references)) {
+            std::fprintf(stderr, "reclaim retired nothing\n");
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Bulk revalidation: an AoS sweep over the reference objects vs the engine on the
+// pool's SoA columns, and the classification kernels alone
+static int run_kernel_suite() {
+    const size_t nrefs = cfg.refs, nents = cfg.entities;
+    MemoryPool pool;
+    ReferentialIntegrityEngine rie(pool);
+    std::mt19937_64 rng(cfg.seed);
+    std::vector<Entity*> ents;
+    ents.reserve(nents);
+    for (size_t i = 0; i < nents; ++i)
+        ents.push_back(pool.create_entity("e", {}, OntState::Defined, 0));
+    for (size_t i = 0; i < nrefs; ++i) {
+        Entity* s = ents[rng() % nents];
+        Entity* t = ents[rng() % nents];
+        pool.create_reference(s->id, t->id, static_cast<OntState>(rng() % 10), 0);
+    }
+    // New states at layer 1, set behind the engine's back: every reference is stale.
+    // No Split: the sweep leaves references into a split alone.
+    for (auto* e : ents) {
+        do e->state = static_cast<OntState>(rng() % 10);
+        while (e->state == OntState::Split);
+        e->temporal_layer = 1;
+    }
+
+    const IntegrityPolicy& rules = *cfg.policy;
+    rie.set_integrity_policy(rules);
+    // AoS: one pass over the reference objects, chasing target pointers
+    auto all = pool.all_references();
+    double aos_sweep = time_ns([&] {
+        for (auto* r : all) {
+            r->integrityStatus = classify_status(r->targetStateAtCreation, pool.get_entity(r->targetEntityId)->state, rules);
+            r->lastValidatedLayer = 1;
+        }
+    });
+    report("revalidate_all", "aos_sweep", nrefs, aos_sweep);
+    std::vector<uint8_t> expected;
+    for (auto* r : all) expected.push_back(static_cast<uint8_t>(r->integrityStatus));
+    auto matches = [&](const char* what) {
+        for (size_t i = 0; i < all.size(); ++i)
+            if (static_cast<uint8_t>(all[i]->integrityStatus) != expected[i]) {
+                std::fprintf(stderr, "%s result mismatch\n", what);
+                return false;
+            }
+        return true;
+    };
+
+    // The engine on the columns: from all Valid and stale (changed statuses are written
+    // back), then again with nothing left stale
+    auto scramble = [&] {
+        for (auto* r : all) {
+            r->integrityStatus = RefIntegrityStatus::Valid;
+            r->lastValidatedLayer = 0;
+            pool.sync_status(*r);
+        }
+    };
+    double soa_engine = 1e300;
+    for (int rep = 0; rep < 5; ++rep) {
+        scramble();
+        soa_engine = std::min(soa_engine, time_ns([&] { rie.revalidate_all(1); }, 1));
+    }
+    report("revalidate_all", "soa_engine", nrefs, soa_engine);
+    if (!matches("SoA engine")) return 1;
+    report("revalidate_all", !rules.uniform ? "soa_engine_unchanged" : refkernel::has_avx2() ? "soa_engine_unchanged_avx2" : "soa_engine_unchanged_ssse3",
+           nrefs, time_ns([&] { rie.revalidate_all(1); }));
+    // Per entity, through each incoming list
+    report("revalidate_all", "soa_per_entity", nrefs, time_ns([&] {
+        for (auto* e : ents) rie.validate_references(e->id, e->state, 1);
+    }));
+    if (!matches("SoA per-entity")) return 1;
+
+    // Classification kernel alone, on pre-gathered states
+    std::vector<uint8_t> gathered(nrefs), created(nrefs), out(nrefs);
+    for (size_t i = 0; i < nrefs; ++i) {
+        gathered[i] = static_cast<uint8_t>(pool.get_entity(all[i]->targetEntityId)->state);
+        created[i] = static_cast<uint8_t>(all[i]->targetStateAtCreation);
+    }
+    report("classify_kernel", "scalar", nrefs,
+           time_ns([&] { refkernel::classify_scalar(gathered.data(), created.data(), out.data(), nrefs, rules); }));
+#ifdef RIE_X86
+    if (rules.uniform && refkernel::has_ssse3())
+        report("classify_kernel", "ssse3", nrefs,
+               time_ns([&] { refkernel::classify_ssse3(gathered.data(), created.data(), out.data(), nrefs, rules); }));
+    if (rules.uniform && refkernel::has_avx2())
+        report("classify_kernel", "avx2", nrefs,
+               time_ns([&] { refkernel::classify_avx2(gathered.data(), created.data(), out.data(), nrefs, rules); }));
+#endif
+    if (out != expected) { std::fprintf(stderr, "kernel result mismatch\n"); return 1; }
+
+    // Single-target validation through the incoming list, per reference into the target
+    Entity* hot = ents[0];
+    size_t fanin = 0;
+    pool.visit_incoming_ids({hot->id}, [&](size_t, Entity*, const std::vector<size_t>& rids) { fanin = rids.size(); });
+    if (fanin)
+        report("validate_target", "soa_engine", fanin,
+               time_ns([&] { rie.validate_references(hot->id, OntState::Reinterpreted, 2); }));
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string opt = argv[i];
+        const char* v = argv[i + 1];
+        if (opt == "--suite") cfg.suite = v;
+        else if (opt == "--entities") cfg.entities = std::strtoull(v, nullptr, 10);
+        else if (opt == "--refs") cfg.refs = std::strtoull(v, nullptr, 10);
+        else if (opt == "--fanin") cfg.fanin = std::strtod(v, nullptr);
+        else if (opt == "--skew") cfg.skew = std::strtod(v, nullptr);
+        else if (opt == "--split-rate") cfg.split_rate = std::strtod(v, nullptr);
+        else if (opt == "--merge-rate") cfg.merge_rate = std::strtod(v, nullptr);
+        else if (opt == "--threads") cfg.threads = std::max<size_t>(1, std::strtoull(v, nullptr, 10));
+        else if (opt == "--ops") cfg.ops = std::strtoull(v, nullptr, 10);
+        else if (opt == "--observers") cfg.observers = std::max<size_t>(1, std::strtoull(v, nullptr, 10));
+        else if (opt == "--shards") cfg.shards = std::max<size_t>(1, std::min<size_t>(shard::MAX_SHARDS, std::strtoull(v, nullptr, 10)));
+        else if (opt == "--seed") cfg.seed = std::strtoull(v, nullptr, 10);
+        else if (opt == "--policy") {
+            cfg.policy = policy::by_name(v);
+            if (!cfg.policy) { std::fprintf(stderr, "unknown policy %s\n", v); return 2; }
+        }
+        else { std::fprintf(stderr, "unknown option %s\n", opt.c_str()); return 2; }
+    }
+    cfg.entities = std::max<size_t>(cfg.entities, 1);
+    if (!cfg.refs) cfg.refs = static_cast<size_t>(cfg.entities * cfg.fanin);
+
+    if (cfg.suite == "all" || cfg.suite == "graph") run_graph_suite();
+    if (cfg.suite == "all" || cfg.suite == "observers") run_observer_suite();
+    if (cfg.suite == "all" || cfg.suite == "identities") run_identity_suite();
+    if (cfg.suite == "all" || cfg.suite == "resolver") run_resolver_suite();
+    if (cfg.suite == "all" || cfg.suite == "shards") run_shard_suite();
+    if ((cfg.suite == "all" || cfg.suite == "reclaim") && run_reclaim_suite()) return 1;
+    if (cfg.suite == "all" || cfg.suite == "kernels") return run_kernel_suite();
+    return 0;
+}
@@ -0,0 +1,267 @@
+// RIE Load Generator
+// Pipelined client load against rie_server: requests per second and latency percentiles
+// Author: 1proprogrammerchant
+// C++17+ required (POSIX sockets)
+// Build: g++ -std=c++17 -O2 -pthread rie_loadgen.cpp -o rie_loadgen
+// Usage: ./rie_loadgen [--unix PATH | --tcp HOST:PORT] [--connections C] [--depth D] [--requests N]
+//                      [--batch B] [--entities E] [--refs R] [--mix E,R,C,Q] [--propagate 0|1] [--seed N]
+//        Each connection first builds E entities and R references of its own (untimed), then
+//        sends N/C frames of B records with at most D frames in flight. --mix weights the ops:
+//        create entity, create reference, state change, query reference (default 5,5,10,80).
+// Output: one JSON object; latency is per frame, from queueing the request to its response.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <random>
+#include <thread>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "rie_protocol.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+struct LoadConfig {
+    std::string unix_path = "/tmp/rie.sock";
+    std::string tcp; // host:port; overrides unix_path
+    size_t connections = 4, depth = 32, requests = 200000, batch = 1;
+    size_t entities = 1000, refs = 4000;
+    unsigned mix[4] = {5, 5, 10, 80};
+    bool propagate = false;
+    uint64_t seed = 42;
+};
+
+static LoadConfig cfg;
+static std::atomic<size_t> layer_clock{0}; // every state change opens the next layer
+
+static int connect_server(std::string* err) {
+    int fd = -1;
+    if (cfg.tcp.empty()) {
+        sockaddr_un a{};
+        a.sun_family = AF_UNIX;
+        std::strncpy(a.sun_path, cfg.unix_path.c_str(), sizeof a.sun_path - 1);
+        fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0 && ::connect(fd, reinterpret_cast<sockaddr*>(&a), sizeof a) == 0) return fd;
+    } else {
+        size_t colon = cfg.tcp.rfind(':');
+        addrinfo hints{}, *res = nullptr;
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        if (colon != std::string::npos &&
+            ::getaddrinfo(cfg.tcp.substr(0, colon).c_str(), cfg.tcp.substr(colon + 1).c_str(), &hints, &res) == 0) {
+            fd = ::socket(AF_INET, SOCK_STREAM, 0);
+            int one = 1;
+            if (fd >= 0) ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+            bool ok = fd >= 0 && ::connect(fd, res->ai_addr, res->ai_addrlen) == 0;
+            ::freeaddrinfo(res);
+            if (ok) return fd;
+        }
+    }
+    if (err) *err = std::string("connect: ") + std::strerror(errno);
+    if (fd >= 0) ::close(fd);
+    return -1;
+}
+
+// One connection: a blocking socket with a window of in-flight frames.
+class Client {
+    int fd;
+    std::vector<char> out, in;
+    size_t in_pos = 0;
+    uint32_t next_tag = 0;
+    std::deque<Clock::time_point> sent; // responses arrive in request order
+
+public:
+    std::vector<double> latency_us;
+    uint64_t frames = 0, records = 0, errors = 0;
+    uint64_t not_found = 0; // ids the server has reclaimed (rie_server --compact-ms)
+    Clock::time_point start, end; // of the timed phase
+    bool failed = false;
+
+    explicit Client(int f) : fd(f) {}
+    ~Client() { if (fd >= 0) ::close(fd); }
+
+    size_t in_flight() const { return sent.size(); }
+    rpc::FrameWriter frame(uint8_t op, uint8_t flags) {
+        rpc::FrameWriter w(out);
+        w.begin(op, flags, next_tag++);
+        sent.push_back(Clock::now());
+        return w;
+    }
+    bool flush() {
+        for (size_t done = 0; done < out.size();) {
+            ssize_t n = ::send(fd, out.data() + done, out.size() - done, MSG_NOSIGNAL);
+            if (n <= 0) return !(failed = true);
+            done += static_cast<size_t>(n);
+        }
+        out.clear();
+        return true;
+    }
+    // Blocks for at least one response; fn(frame) for each complete one.
+    template <typename F>
+    bool receive(F&& fn) {
+        rpc::Frame f;
+        std::string err;
+        for (;;) {
+            size_t got = 0;
+            while (rpc::next_frame(in.data() + in_pos, in.size() - in_pos, f, &err)) {
+                auto t = sent.front();
+                sent.pop_front();
+                latency_us.push_back(std::chrono::duration<double, std::micro>(Clock::now() - t).count());
+                ++frames;
+                records += f.head.count;
+                fn(f);
+                in_pos += f.size;
+                ++got;
+            }
+            if (!err.empty()) return !(failed = true);
+            if (got) break;
+            if (in_pos) in.erase(in.begin(), in.begin() + static_cast<ptrdiff_t>(in_pos)), in_pos = 0;
+            char buf[64 * 1024];
+            ssize_t n = ::recv(fd, buf, sizeof buf, 0);
+            if (n <= 0) return !(failed = true);
+            in.insert(in.end(), buf, buf + n);
+        }
+        return true;
+    }
+    // Sends one frame and waits for its response (setup phase).
+    template <typename F>
+    bool call(F&& fn) {
+        return flush() && receive(fn);
+    }
+};
+
+// Record statuses of a response; ids of created objects go to ids (if given).
+static void collect(const rpc::Frame& f, Client& c, std::vector<uint64_t>* ids) {
+    rpc::Decoder d(f);
+    for (uint16_t i = 0; i < f.head.count; ++i) {
+        rpc::StatusRecord q;
+        rpc::Status st = f.head.op == rpc::QueryReference ? (read(d, q), q.status) : d.get<rpc::Status>();
+        if (f.head.op == rpc::CreateEntity || f.head.op == rpc::CreateReference) {
+            uint64_t id = d.get<uint64_t>();
+            if (ids && st == rpc::Status::Ok) ids->push_back(id);
+        }
+        if (d.ok && st == rpc::Status::NotFound) ++c.not_found;
+        else if (!d.ok || st != rpc::Status::Ok) ++c.errors;
+    }
+}
+
+static void run_connection(size_t index, Client& c) {
+    std::mt19937_64 rng(cfg.seed + index);
+    const uint8_t batched = cfg.batch > 1 ? rpc::Batch : 0;
+    std::vector<uint64_t> ents, refs;
+    for (size_t i = 0; i < cfg.entities && !c.failed;) {
+        rpc::FrameWriter w = c.frame(rpc::CreateEntity, rpc::Batch);
+        for (size_t k = 0; k < 256 && i < cfg.entities; ++k, ++i) w.entity(OntState::Defined, 0, "load" + std::to_string(i));
+        w.end();
+        c.call([&](const rpc::Frame& f) { collect(f, c, &ents); });
+    }
+    for (size_t i = 0; i < cfg.refs && !ents.empty() && !c.failed;) {
+        rpc::FrameWriter w = c.frame(rpc::CreateReference, rpc::Batch);
+        for (size_t k = 0; k < 256 && i < cfg.refs; ++k, ++i) w.reference(ents[rng() % ents.size()], ents[rng() % ents.size()], 0);
+        w.end();
+        c.call([&](const rpc::Frame& f) { collect(f, c, &refs); });
+    }
+    if (ents.empty() || refs.empty()) { c.failed = true; return; }
+    c.latency_us.clear();
+    c.frames = c.records = c.errors = c.not_found = 0;
+    c.start = Clock::now();
+
+    static const OntState changes[] = {OntState::Reinterpreted, OntState::Contradicted, OntState::Split, OntState::Collapsed};
+    const unsigned total = cfg.mix[0] + cfg.mix[1] + cfg.mix[2] + cfg.mix[3];
+    const size_t frames = cfg.requests / cfg.connections + (index < cfg.requests % cfg.connections);
+    for (size_t i = 0; i < frames && !c.failed;) {
+        for (; i < frames && c.in_flight() < cfg.depth; ++i) {
+            unsigned pick = static_cast<unsigned>(rng() % total);
+            uint8_t op = pick < cfg.mix[0] ? rpc::CreateEntity
+                       : pick < cfg.mix[0] + cfg.mix[1] ? rpc::CreateReference
+                       : pick < cfg.mix[0] + cfg.mix[1] + cfg.mix[2] ? rpc::StateChange : rpc::QueryReference;
+            rpc::FrameWriter w = c.frame(op, batched | (op == rpc::StateChange && cfg.propagate ? rpc::Propagate : 0));
+            for (size_t k = 0; k < cfg.batch; ++k) {
+                size_t layer = layer_clock.load(std::memory_order_relaxed);
+                switch (op) {
+                case rpc::CreateEntity: w.entity(OntState::Defined, layer, "extra"); break;
+                case rpc::CreateReference: w.reference(ents[rng() % ents.size()], ents[rng() % ents.size()], layer); break;
+                case rpc::StateChange: w.change(ents[rng() % ents.size()], changes[rng() % 4], layer_clock.fetch_add(1) + 1); break;
+                default: w.query(refs[rng() % refs.size()]);
+                }
+            }
+            w.end();
+        }
+        if (!c.flush()) break;
+        c.receive([&](const rpc::Frame& f) { collect(f, c, nullptr); });
+    }
+    while (c.in_flight() && !c.failed) c.receive([&](const rpc::Frame& f) { collect(f, c, nullptr); });
+    c.end = Clock::now();
+}
+
+static bool parse_mix(const char* v) {
+    unsigned m[4];
+    if (std::sscanf(v, "%u,%u,%u,%u", &m[0], &m[1], &m[2], &m[3]) != 4 || m[0] + m[1] + m[2] + m[3] == 0) return false;
+    std::copy(m, m + 4, cfg.mix);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string opt = argv[i];
+        const char* v = argv[i + 1];
+        if (opt == "--unix") cfg.unix_path = v;
+        else if (opt == "--tcp") cfg.tcp = v;
+        else if (opt == "--connections") cfg.connections = std::max<size_t>(1, std::strtoull(v, nullptr, 10));
+        else if (opt == "--depth") cfg.depth = std::max<size_t>(1, std::strtoull(v, nullptr, 10));
+        else if (opt == "--requests") cfg.requests = std::strtoull(v, nullptr, 10);
+        else if (opt == "--batch") cfg.batch = std::max<size_t>(1, std::min<size_t>(UINT16_MAX, std::strtoull(v, nullptr, 10)));
+        else if (opt == "--entities") cfg.entities = std::max<size_t>(1, std::strtoull(v, nullptr, 10));
+        else if (opt == "--refs") cfg.refs = std::max<size_t>(1, std::strtoull(v, nullptr, 10));
+        else if (opt == "--mix") {
+            if (!parse_mix(v)) { std::fprintf(stderr, "--mix wants four weights, e.g. 5,5,10,80\n"); return 2; }
+        }
+        else if (opt == "--propagate") cfg.propagate = std::atoi(v) != 0;
+        else if (opt == "--seed") cfg.seed = std::strtoull(v, nullptr, 10);
+        else { std::fprintf(stderr, "unknown option %s\n", opt.c_str()); return 2; }
+    }
+    // Every frame the mix sends, and its response, must fit in MAX_FRAME.
+    static const size_t request_record[] = {15, 24, 17, 8}; // as run_connection writes them
+    for (uint8_t k = 0; k < 4; ++k)
+        if (cfg.mix[k])
+            cfg.batch = std::min({cfg.batch, rpc::max_records(rpc::CreateEntity + k), (rpc::MAX_FRAME - 8) / request_record[k]});
+
+    std::vector<std::unique_ptr<Client>> clients;
+    for (size_t i = 0; i < cfg.connections; ++i) {
+        std::string err;
+        int fd = connect_server(&err);
+        if (fd < 0) { std::fprintf(stderr, "rie_loadgen: %s\n", err.c_str()); return 1; }
+        clients.push_back(std::make_unique<Client>(fd));
+    }
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < cfg.connections; ++i) threads.emplace_back(run_connection, i, std::ref(*clients[i]));
+    for (auto& t : threads) t.join();
+
+    std::vector<double> lat;
+    uint64_t frames = 0, records = 0, errors = 0, not_found = 0;
+    Clock::time_point first = Clock::time_point::max(), last = Clock::time_point::min();
+    for (auto& c : clients) {
+        if (c->failed) { std::fprintf(stderr, "rie_loadgen: connection failed\n"); return 1; }
+        lat.insert(lat.end(), c->latency_us.begin(), c->latency_us.end());
+        frames += c->frames, records += c->records, errors += c->errors, not_found += c->not_found;
+        first = std::min(first, c->start), last = std::max(last, c->end);
+    }
+    double secs = std::max(1e-9, std::chrono::duration<double>(last - first).count());
+    std::sort(lat.begin(), lat.end());
+    auto pct = [&](double p) { return lat.empty() ? 0.0 : lat[std::min(lat.size() - 1, static_cast<size_t>(p * lat.size()))]; };
+    std::printf("{\"bench\":\"loadgen\",\"transport\":\"%s\",\"connections\":%zu,\"depth\":%zu,\"batch\":%zu,\"frames\":%llu,"
+                "\"records\":%llu,\"errors\":%llu,\"not_found\":%llu,\"seconds\":%.3f,\"requests_per_sec\":%.0f,\"records_per_sec\":%.0f,"
+                "\"p50_us\":%.1f,\"p99_us\":%.1f,\"max_us\":%.1f}\n",
+                cfg.tcp.empty() ? "unix" : "tcp", cfg.connections, cfg.depth, cfg.batch, static_cast<unsigned long long>(frames),
+                static_cast<unsigned long long>(records), static_cast<unsigned long long>(errors),
+                static_cast<unsigned long long>(not_found), secs, frames / secs,
+                records / secs, pct(0.5), pct(0.99), lat.empty() ? 0.0 : lat.back());
+    return 0;
+}
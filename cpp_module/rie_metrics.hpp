@@ -0,0 +1,400 @@
+// Hot-Path Metrics
+// Always-on operation counts, latency histograms and lock contention for the pool and the RIE
+// Author: 1proprogrammerchant
+// C++17+ required
+// Build flag: -DRIE_NO_METRICS compiles every probe to nothing.
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace metrics {
+
+enum class Op : uint8_t {
+    CreateEntity, CreateReference, GetEntity, GetReference, ValidateReferences, PropagateIntegrity,
+    ApplyStateChanges, Count
+};
+enum class Lock : uint8_t { EntityFreeList, ReferenceFreeList, SlabFreeList, Propagation, Compaction, Count };
+
+constexpr size_t OP_COUNT = static_cast<size_t>(Op::Count);
+constexpr size_t LOCK_COUNT = static_cast<size_t>(Lock::Count);
+constexpr size_t BUCKETS = 48; // bucket b holds values in [2^(b-1), 2^b)
+
+inline const char* name(Op op) {
+    static const char* names[] = {"create_entity", "create_reference", "get_entity", "get_reference",
+                                  "validate_references", "propagate_integrity", "apply_state_changes"};
+    return names[static_cast<size_t>(op)];
+}
+inline const char* name(Lock l) {
+    static const char* names[] = {"entity_free_list", "reference_free_list", "slab_free_list", "propagation", "compaction"};
+    return names[static_cast<size_t>(l)];
+}
+
+// Every call is counted; one call in 2^shift is timed, so the clock stays off the
+// nanosecond paths. Sampled latencies feed the histograms.
+inline unsigned sample_shift(Op op) {
+    switch (op) {
+    case Op::GetEntity: case Op::GetReference: return 6;
+    case Op::CreateEntity: case Op::CreateReference: return 3;
+    default: return 0;
+    }
+}
+
+inline size_t bucket(uint64_t v) {
+    size_t b = v ? 64 - static_cast<size_t>(__builtin_clzll(v)) : 0;
+    return b < BUCKETS ? b : BUCKETS - 1;
+}
+inline uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+// Wall-clock time, ns since the Unix epoch; for timestamps, not for intervals.
+inline uint64_t unix_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+// Plain-value histogram, as aggregated into a Snapshot.
+struct Histogram {
+    uint64_t count = 0, sum = 0, max = 0;
+    uint64_t buckets[BUCKETS] = {};
+
+    // Upper bound of the bucket holding the p-th value (0 when empty).
+    uint64_t percentile(double p) const {
+        if (!count) return 0;
+        uint64_t rank = static_cast<uint64_t>(p * count), seen = 0;
+        for (size_t b = 0; b < BUCKETS; ++b)
+            if ((seen += buckets[b]) > rank) return std::min(max, b ? (uint64_t(1) << b) - 1 : 0);
+        return max;
+    }
+    double mean() const { return count ? double(sum) / count : 0; }
+};
+
+struct OpStats {
+    uint64_t calls = 0;
+    Histogram latency_ns; // sampled calls only
+};
+struct LockStats {
+    uint64_t acquisitions = 0, contended = 0;
+    Histogram wait_ns; // contended acquisitions only
+};
+
+namespace detail {
+
+// One writer (its thread) per cell: increments are a relaxed load and store, no RMW.
+struct Cell {
+    std::atomic<uint64_t> v{0};
+    void add(uint64_t d) { v.store(v.load(std::memory_order_relaxed) + d, std::memory_order_relaxed); }
+    void raise(uint64_t x) {
+        if (x > v.load(std::memory_order_relaxed)) v.store(x, std::memory_order_relaxed);
+    }
+    uint64_t get() const { return v.load(std::memory_order_relaxed); }
+};
+struct HistogramCells {
+    Cell count, sum, max, buckets[BUCKETS];
+    void record(uint64_t x) {
+        count.add(1);
+        sum.add(x);
+        max.raise(x);
+        buckets[bucket(x)].add(1);
+    }
+    void read_into(Histogram& h) const {
+        h.count += count.get();
+        h.sum += sum.get();
+        h.max = std::max(h.max, max.get());
+        for (size_t b = 0; b < BUCKETS; ++b) h.buckets[b] += buckets[b].get();
+    }
+};
+
+// Per-thread counters. Blocks are never freed: when a thread exits its block goes back
+// to the registry with its totals intact and the next new thread continues it.
+struct alignas(64) ThreadBlock {
+    std::atomic<bool> claimed{true};
+    uint64_t tick = 0;
+    Cell op_calls[OP_COUNT];
+    HistogramCells op_latency[OP_COUNT];
+    Cell lock_acquisitions[LOCK_COUNT], lock_contended[LOCK_COUNT];
+    HistogramCells lock_wait[LOCK_COUNT];
+    HistogramCells refs_touched, propagation_depth;
+    ThreadBlock* next = nullptr;
+};
+
+class Registry {
+    std::mutex mutex;
+    std::atomic<ThreadBlock*> head{nullptr};
+
+public:
+    static Registry& global() {
+        static Registry* instance = new Registry; // outlives thread-local destructors
+        return *instance;
+    }
+    ThreadBlock* claim() {
+        std::lock_guard lock(mutex);
+        for (ThreadBlock* b = head.load(std::memory_order_relaxed); b; b = b->next) {
+            bool expected = false;
+            if (b->claimed.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) return b;
+        }
+        auto* b = new ThreadBlock;
+        b->next = head.load(std::memory_order_relaxed);
+        head.store(b, std::memory_order_release);
+        return b;
+    }
+    template <typename F>
+    void for_each(F&& fn) const {
+        for (const ThreadBlock* b = head.load(std::memory_order_acquire); b; b = b->next) fn(*b);
+    }
+};
+
+struct ThreadHandle {
+    ThreadBlock* block = Registry::global().claim();
+    ~ThreadHandle() { block->claimed.store(false, std::memory_order_release); }
+};
+inline ThreadBlock* attach() {
+    thread_local ThreadHandle handle;
+    return handle.block;
+}
+// The plain pointer is constant-initialized, so the fast path is a bare TLS load.
+inline ThreadBlock& local() {
+    thread_local ThreadBlock* block = nullptr;
+    if (__builtin_expect(!block, 0)) block = attach();
+    return *block;
+}
+
+} // namespace detail
+
+// Aggregated totals across all threads at one moment. Counters are read without
+// stopping writers, so a snapshot may be mid-update by a few events.
+struct Snapshot {
+    uint64_t taken_unix_ns = 0; // wall clock when taken
+    uint64_t taken_ns = 0;      // steady clock when taken; only differences mean anything
+    uint64_t interval_ns = 0;   // a delta from since(): the time it covers (0: totals since start)
+    size_t threads = 0;
+    OpStats ops[OP_COUNT];
+    LockStats locks[LOCK_COUNT];
+    Histogram refs_touched;      // per propagate_integrity / validate_references / apply_state_changes call
+    Histogram propagation_depth; // cascade levels per propagate_integrity
+
+    const OpStats& op(Op o) const { return ops[static_cast<size_t>(o)]; }
+    const LockStats& lock(Lock l) const { return locks[static_cast<size_t>(l)]; }
+
+    // Events between earlier and this snapshot. Maxima cover the whole run.
+    Snapshot since(const Snapshot& earlier) const {
+        Snapshot d = *this;
+        d.interval_ns = taken_ns - earlier.taken_ns;
+        auto sub = [](Histogram& h, const Histogram& e) {
+            h.count -= e.count;
+            h.sum -= e.sum;
+            for (size_t b = 0; b < BUCKETS; ++b) h.buckets[b] -= e.buckets[b];
+        };
+        for (size_t i = 0; i < OP_COUNT; ++i) {
+            d.ops[i].calls -= earlier.ops[i].calls;
+            sub(d.ops[i].latency_ns, earlier.ops[i].latency_ns);
+        }
+        for (size_t i = 0; i < LOCK_COUNT; ++i) {
+            d.locks[i].acquisitions -= earlier.locks[i].acquisitions;
+            d.locks[i].contended -= earlier.locks[i].contended;
+            sub(d.locks[i].wait_ns, earlier.locks[i].wait_ns);
+        }
+        sub(d.refs_touched, earlier.refs_touched);
+        sub(d.propagation_depth, earlier.propagation_depth);
+        return d;
+    }
+
+    // One JSON object on one line, as the benchmarks print.
+    std::string json() const {
+        std::string out;
+        char buf[512];
+        std::snprintf(buf, sizeof buf, "{\"metrics\":\"rie\",\"taken_unix_ns\":%llu,\"interval_ns\":%llu,\"threads\":%zu,\"ops\":{",
+                      (unsigned long long)taken_unix_ns, (unsigned long long)interval_ns, threads);
+        out += buf;
+        for (size_t i = 0; i < OP_COUNT; ++i) {
+            const Histogram& h = ops[i].latency_ns;
+            std::snprintf(buf, sizeof buf, "%s\"%s\":{\"calls\":%llu,\"sampled\":%llu,\"mean_ns\":%.0f,\"p50_ns\":%llu,"
+                          "\"p99_ns\":%llu,\"max_ns\":%llu}", i ? "," : "", name(static_cast<Op>(i)),
+                          (unsigned long long)ops[i].calls, (unsigned long long)h.count, h.mean(),
+                          (unsigned long long)h.percentile(0.5), (unsigned long long)h.percentile(0.99),
+                          (unsigned long long)h.max);
+            out += buf;
+        }
+        out += "},\"locks\":{";
+        for (size_t i = 0; i < LOCK_COUNT; ++i) {
+            const Histogram& h = locks[i].wait_ns;
+            std::snprintf(buf, sizeof buf, "%s\"%s\":{\"acquisitions\":%llu,\"contended\":%llu,\"wait_ns\":%llu,"
+                          "\"p99_wait_ns\":%llu,\"max_wait_ns\":%llu}", i ? "," : "", name(static_cast<Lock>(i)),
+                          (unsigned long long)locks[i].acquisitions, (unsigned long long)locks[i].contended,
+                          (unsigned long long)h.sum, (unsigned long long)h.percentile(0.99), (unsigned long long)h.max);
+            out += buf;
+        }
+        std::snprintf(buf, sizeof buf, "},\"refs_touched\":{\"calls\":%llu,\"mean\":%.1f,\"p99\":%llu,\"max\":%llu},"
+                      "\"propagation_depth\":{\"mean\":%.2f,\"max\":%llu}}",
+                      (unsigned long long)refs_touched.count, refs_touched.mean(),
+                      (unsigned long long)refs_touched.percentile(0.99), (unsigned long long)refs_touched.max,
+                      propagation_depth.mean(), (unsigned long long)propagation_depth.max);
+        return out + buf;
+    }
+
+    // Human-readable table; idle operations and locks are left out.
+    std::string text() const {
+        std::string out;
+        char buf[256];
+        std::snprintf(buf, sizeof buf, "%-22s %12s %10s %10s %10s %12s\n", "operation", "calls", "mean_ns", "p50_ns",
+                      "p99_ns", "max_ns");
+        out += buf;
+        for (size_t i = 0; i < OP_COUNT; ++i) {
+            const Histogram& h = ops[i].latency_ns;
+            if (!ops[i].calls) continue;
+            std::snprintf(buf, sizeof buf, "%-22s %12llu %10.0f %10llu %10llu %12llu\n", name(static_cast<Op>(i)),
+                          (unsigned long long)ops[i].calls, h.mean(), (unsigned long long)h.percentile(0.5),
+                          (unsigned long long)h.percentile(0.99), (unsigned long long)h.max);
+            out += buf;
+        }
+        std::snprintf(buf, sizeof buf, "%-22s %12s %10s %12s %12s\n", "lock", "acquired", "contended", "wait_ns",
+                      "max_wait_ns");
+        out += buf;
+        for (size_t i = 0; i < LOCK_COUNT; ++i) {
+            if (!locks[i].acquisitions) continue;
+            std::snprintf(buf, sizeof buf, "%-22s %12llu %10llu %12llu %12llu\n", name(static_cast<Lock>(i)),
+                          (unsigned long long)locks[i].acquisitions, (unsigned long long)locks[i].contended,
+                          (unsigned long long)locks[i].wait_ns.sum, (unsigned long long)locks[i].wait_ns.max);
+            out += buf;
+        }
+        std::snprintf(buf, sizeof buf, "refs touched per call: mean %.1f, p99 %llu, max %llu; propagation depth max %llu\n",
+                      refs_touched.mean(), (unsigned long long)refs_touched.percentile(0.99),
+                      (unsigned long long)refs_touched.max, (unsigned long long)propagation_depth.max);
+        return out + buf;
+    }
+};
+
+inline Snapshot snapshot() {
+    Snapshot s;
+    s.taken_unix_ns = unix_ns();
+    s.taken_ns = now_ns();
+    detail::Registry::global().for_each([&](const detail::ThreadBlock& b) {
+        ++s.threads;
+        for (size_t i = 0; i < OP_COUNT; ++i) {
+            s.ops[i].calls += b.op_calls[i].get();
+            b.op_latency[i].read_into(s.ops[i].latency_ns);
+        }
+        for (size_t i = 0; i < LOCK_COUNT; ++i) {
+            s.locks[i].acquisitions += b.lock_acquisitions[i].get();
+            s.locks[i].contended += b.lock_contended[i].get();
+            b.lock_wait[i].read_into(s.locks[i].wait_ns);
+        }
+        b.refs_touched.read_into(s.refs_touched);
+        b.propagation_depth.read_into(s.propagation_depth);
+    });
+    return s;
+}
+
+#ifndef RIE_NO_METRICS
+
+// Counts the call and, when sampled, times it until the end of scope.
+class Scope {
+    detail::ThreadBlock& b;
+    Op op;
+    uint64_t t0 = 0;
+
+public:
+    explicit Scope(Op o) : b(detail::local()), op(o) {
+        b.op_calls[static_cast<size_t>(o)].add(1);
+        if ((++b.tick & ((uint64_t(1) << sample_shift(o)) - 1)) == 0) t0 = now_ns();
+    }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+    ~Scope() {
+        if (t0) b.op_latency[static_cast<size_t>(op)].record(now_ns() - t0);
+    }
+};
+
+inline void count(Op op) { detail::local().op_calls[static_cast<size_t>(op)].add(1); }
+inline void refs_touched(uint64_t n) { detail::local().refs_touched.record(n); }
+inline void propagation_depth(uint64_t n) { detail::local().propagation_depth.record(n); }
+
+// lock_guard that tells an uncontended acquisition (try_lock succeeds) from a wait,
+// and times the wait.
+template <typename M>
+class TimedLock {
+    M& m;
+
+public:
+    TimedLock(M& mutex, Lock l) : m(mutex) {
+        detail::ThreadBlock& b = detail::local();
+        size_t i = static_cast<size_t>(l);
+        b.lock_acquisitions[i].add(1);
+        if (m.try_lock()) return;
+        uint64_t t0 = now_ns();
+        m.lock();
+        b.lock_contended[i].add(1);
+        b.lock_wait[i].record(now_ns() - t0);
+    }
+    TimedLock(const TimedLock&) = delete;
+    TimedLock& operator=(const TimedLock&) = delete;
+    ~TimedLock() { m.unlock(); }
+};
+
+#else
+
+class Scope {
+public:
+    explicit Scope(Op) {}
+};
+inline void count(Op) {}
+inline void refs_touched(uint64_t) {}
+inline void propagation_depth(uint64_t) {}
+template <typename M>
+class TimedLock {
+    std::lock_guard<M> guard;
+
+public:
+    TimedLock(M& mutex, Lock) : guard(mutex) {}
+};
+
+#endif
+
+enum class Format { Text, Json };
+
+// Writes the events of each interval (a Snapshot delta) to out until destroyed.
+class Reporter {
+    std::FILE* out;
+    Format format;
+    std::chrono::milliseconds interval;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stopping = false;
+    std::thread thread;
+
+    void run() {
+        Snapshot last = snapshot();
+        std::unique_lock lock(mutex);
+        while (!cv.wait_for(lock, interval, [&] { return stopping; })) {
+            Snapshot now = snapshot();
+            std::string s = format == Format::Json ? now.since(last).json() + "\n" : now.since(last).text();
+            std::fputs(s.c_str(), out);
+            std::fflush(out);
+            last = now;
+        }
+    }
+
+public:
+    Reporter(std::chrono::milliseconds every, std::FILE* to = stderr, Format f = Format::Json)
+        : out(to), format(f), interval(every), thread(&Reporter::run, this) {}
+    Reporter(const Reporter&) = delete;
+    Reporter& operator=(const Reporter&) = delete;
+    ~Reporter() {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        cv.notify_one();
+        thread.join();
+    }
+};
+
+} // namespace metrics
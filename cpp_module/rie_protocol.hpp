@@ -0,0 +1,205 @@
+// RIE Wire Protocol
+// Length-prefixed binary requests and responses for rie_server / rie_loadgen
+// Author: 1proprogrammerchant
+// C++17+ required (little-endian layout)
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "integrity_policy.hpp"
+
+// Frame: uint32 body bytes, then the body: FrameHeader followed by count records of
+// the header's op, packed. Without the Batch flag count is 1. Requests may be pipelined;
+// each gets exactly one response frame with the same op and tag, in request order
+// per connection. Every response record starts with a Status byte. A request with more
+// than max_records(op) records is answered with a single BadRequest record.
+namespace rpc {
+
+constexpr uint32_t MAX_FRAME = 1 << 20; // body bytes
+constexpr size_t MAX_NAME = 255;
+
+enum Op : uint8_t {
+    CreateEntity = 1, // req: state u8, layer u64, name (u8 len + bytes)   resp: status, id u64
+    CreateReference,  // req: source u64, target u64, layer u64           resp: status, id u64
+    StateChange,      // req: entity u64, state u8, layer u64             resp: status
+    QueryReference    // req: reference u64    resp: status, integrity u8, source u64, target u64, layer u64
+};
+
+enum Flags : uint8_t {
+    Batch = 1,     // count records instead of one
+    Propagate = 2  // StateChange: also cascade to transitively dependent references
+};
+
+enum class Status : uint8_t { Ok, NotFound, BadRequest };
+
+// Response record bytes per op (index = op)
+constexpr size_t RESPONSE_RECORD[] = {0, 9, 9, 1, 26};
+
+// Records one request frame may carry so that its response also fits in MAX_FRAME
+constexpr size_t max_records(uint8_t op) {
+    size_t n = (MAX_FRAME - 8) / RESPONSE_RECORD[op]; // 8: FrameHeader
+    return n < 0xFFFF ? n : 0xFFFF;
+}
+static_assert(max_records(QueryReference) == 40329);
+
+struct FrameHeader {
+    uint8_t op;
+    uint8_t flags;
+    uint16_t count;
+    uint32_t tag; // chosen by the client, echoed in the response
+};
+static_assert(sizeof(FrameHeader) == 8, "packed header");
+
+inline bool is_write(uint8_t op) { return op == CreateEntity || op == CreateReference || op == StateChange; }
+
+// One complete frame inside a receive buffer.
+struct Frame {
+    FrameHeader head;
+    const char* records;
+    size_t bytes; // of records
+    size_t size;  // whole frame, length prefix included
+};
+
+// Complete frame at p: true and out filled; false with out.size 0 if more bytes are
+// needed; false with err set if the frame can never be valid (the stream is lost).
+inline bool next_frame(const char* p, size_t avail, Frame& out, std::string* err) {
+    out.size = 0;
+    if (avail < 4) return false;
+    uint32_t n;
+    std::memcpy(&n, p, 4);
+    if (n < sizeof(FrameHeader) || n > MAX_FRAME) {
+        if (err) *err = "bad frame length " + std::to_string(n);
+        return false;
+    }
+    if (avail - 4 < n) return false;
+    std::memcpy(&out.head, p + 4, sizeof(FrameHeader));
+    if (!(out.head.flags & Batch)) out.head.count = 1;
+    out.records = p + 4 + sizeof(FrameHeader);
+    out.bytes = n - sizeof(FrameHeader);
+    out.size = 4 + n;
+    return true;
+}
+
+// Appends one frame to a buffer: begin(), records, end() patches length and count.
+// Several frames may go into one buffer; that is how responses are coalesced.
+class FrameWriter {
+    std::vector<char>& buf;
+    size_t start = 0;
+    uint16_t count = 0;
+
+public:
+    explicit FrameWriter(std::vector<char>& b) : buf(b) {}
+    FrameWriter& begin(uint8_t op, uint8_t flags, uint32_t tag) {
+        start = buf.size();
+        count = 0;
+        FrameHeader h{op, flags, 0, tag};
+        put(uint32_t(0));
+        buf.insert(buf.end(), reinterpret_cast<const char*>(&h), reinterpret_cast<const char*>(&h + 1));
+        return *this;
+    }
+    template <typename T>
+    FrameWriter& put(T v) {
+        const char* p = reinterpret_cast<const char*>(&v);
+        buf.insert(buf.end(), p, p + sizeof v);
+        return *this;
+    }
+    FrameWriter& name(std::string_view s) {
+        s = s.substr(0, MAX_NAME);
+        put(static_cast<uint8_t>(s.size()));
+        buf.insert(buf.end(), s.data(), s.data() + s.size());
+        return *this;
+    }
+    // Marks the end of one record.
+    FrameWriter& record() {
+        ++count;
+        return *this;
+    }
+    void end() {
+        uint32_t n = static_cast<uint32_t>(buf.size() - start - 4);
+        std::memcpy(buf.data() + start, &n, 4);
+        std::memcpy(buf.data() + start + 4 + offsetof(FrameHeader, count), &count, 2);
+    }
+
+    // Request records
+    FrameWriter& entity(OntState s, uint64_t layer, std::string_view n) {
+        return put(static_cast<uint8_t>(s)).put(layer).name(n).record();
+    }
+    FrameWriter& reference(uint64_t source, uint64_t target, uint64_t layer) {
+        return put(source).put(target).put(layer).record();
+    }
+    FrameWriter& change(uint64_t entity, OntState s, uint64_t layer) {
+        return put(entity).put(static_cast<uint8_t>(s)).put(layer).record();
+    }
+    FrameWriter& query(uint64_t reference) { return put(reference).record(); }
+
+    // Response records
+    FrameWriter& created(Status st, uint64_t id) { return put(st).put(id).record(); }
+    FrameWriter& changed(Status st) { return put(st).record(); }
+    FrameWriter& status(Status st, RefIntegrityStatus s, uint64_t source, uint64_t target, uint64_t layer) {
+        return put(st).put(static_cast<uint8_t>(s)).put(source).put(target).put(layer).record();
+    }
+};
+
+// Bounds-checked record decoder; ok turns false on the first short read.
+class Decoder {
+    const char* p;
+    const char* end;
+
+public:
+    Decoder(const char* b, size_t n) : p(b), end(b + n) {}
+    explicit Decoder(const Frame& f) : Decoder(f.records, f.bytes) {}
+    bool ok = true;
+    template <typename T>
+    T get() {
+        T v{};
+        if (end - p < static_cast<ptrdiff_t>(sizeof v)) { ok = false; return v; }
+        std::memcpy(&v, p, sizeof v);
+        p += sizeof v;
+        return v;
+    }
+    std::string_view name() {
+        uint8_t n = get<uint8_t>();
+        if (end - p < n) { ok = false; return {}; }
+        std::string_view s(p, n);
+        p += n;
+        return s;
+    }
+};
+
+struct EntityRecord { uint8_t state; uint64_t layer; std::string_view name; };
+struct ReferenceRecord { uint64_t source, target, layer; };
+struct ChangeRecord { uint64_t entity; uint8_t state; uint64_t layer; };
+struct StatusRecord { Status status; uint8_t integrity; uint64_t source, target, layer; };
+
+inline bool read(Decoder& d, EntityRecord& r) {
+    r.state = d.get<uint8_t>();
+    r.layer = d.get<uint64_t>();
+    r.name = d.name();
+    return d.ok;
+}
+inline bool read(Decoder& d, ReferenceRecord& r) {
+    r.source = d.get<uint64_t>();
+    r.target = d.get<uint64_t>();
+    r.layer = d.get<uint64_t>();
+    return d.ok;
+}
+inline bool read(Decoder& d, ChangeRecord& r) {
+    r.entity = d.get<uint64_t>();
+    r.state = d.get<uint8_t>();
+    r.layer = d.get<uint64_t>();
+    return d.ok;
+}
+inline bool read(Decoder& d, StatusRecord& r) {
+    r.status = d.get<Status>();
+    r.integrity = d.get<uint8_t>();
+    r.source = d.get<uint64_t>();
+    r.target = d.get<uint64_t>();
+    r.layer = d.get<uint64_t>();
+    return d.ok;
+}
+
+inline bool valid_state(uint8_t s) { return s < ONT_STATE_COUNT; }
+
+} // namespace rpc
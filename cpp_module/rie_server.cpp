@@ -0,0 +1,528 @@
+// RIE Server
+// Long-running integrity engine behind Unix-domain and TCP sockets (rie_protocol.hpp)
+// Author: 1proprogrammerchant
+// C++17+ required (Linux: epoll, eventfd, signalfd)
+// Build: g++ -std=c++17 -O2 -pthread rie_server.cpp -o rie_server
+// Usage: ./rie_server [--unix PATH] [--tcp PORT] [--readers N] [--max-pending BYTES]
+//                     [--compact-ms MS] [--keep-layers N]
+//        Defaults: --unix /tmp/rie.sock, no TCP, one reader per core, no compaction
+//        (--compact-ms runs pool_compactor.hpp in the background). SIGINT/SIGTERM stop it
+//        and print the totals as one JSON line. Load: rie_loadgen.cpp.
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "layer_snapshot.hpp"
+#include "pool_compactor.hpp"
+#include "rie_protocol.hpp"
+
+// One event-loop thread owns the sockets. Each read pass cuts a connection's complete
+// frames into jobs of consecutive writes or consecutive queries. Writes go to a single
+// writer thread (the commit path: creations, state changes, propagation, then
+// commit_layer); queries run on a reader pool against a LayerSnapshot of the committed
+// layer. A connection's jobs are ordered: a query waits for its earlier writes and a
+// write for its earlier queries, while runs of either still pipeline. Completed jobs
+// come back through an eventfd; their responses are appended in request order and each
+// connection gets at most one send per loop pass.
+struct ServerOptions {
+    std::string unix_path = "/tmp/rie.sock";
+    int tcp_port = -1;
+    size_t readers = std::max(1u, std::thread::hardware_concurrency());
+    size_t max_pending = size_t(8) << 20; // unsent response bytes before a connection stops being read
+    size_t compact_ms = 0;                // 0: never reclaim Collapsed entities and Invalidated references
+    size_t keep_layers = 0;
+};
+
+struct Job {
+    uint64_t conn, seq;
+    bool write;
+    std::vector<char> input;  // whole request frames
+    std::vector<char> output; // their response frames
+};
+
+struct ServerStats {
+    std::atomic<uint64_t> frames{0}, records{0}, writes{0}, queries{0}, errors{0};
+};
+
+// Executes jobs; every record gets a response record, failed ones with a non-Ok status.
+class Executor {
+    MemoryPool& pool;
+    ReferentialIntegrityEngine& rie;
+    ServerStats& stats;
+
+    void create_entities(const rpc::Frame& f, rpc::FrameWriter& w, size_t& top) {
+        rpc::Decoder d(f);
+        rpc::EntityRecord r;
+        for (uint16_t i = 0; i < f.head.count; ++i) {
+            if (!read(d, r) || !rpc::valid_state(r.state)) { w.created(rpc::Status::BadRequest, 0); continue; }
+            Entity* e = pool.create_entity(SymbolTable::global().intern(r.name), AttributeSet(), static_cast<OntState>(r.state), r.layer);
+            w.created(rpc::Status::Ok, e->id);
+            top = std::max<size_t>(top, r.layer);
+        }
+    }
+    void create_references(const rpc::Frame& f, rpc::FrameWriter& w, size_t& top) {
+        rpc::Decoder d(f);
+        rpc::ReferenceRecord r;
+        for (uint16_t i = 0; i < f.head.count; ++i) {
+            if (!read(d, r)) { w.created(rpc::Status::BadRequest, 0); continue; }
+            Entity* target = pool.get_entity(r.target);
+            if (!target || !pool.get_entity(r.source)) { w.created(rpc::Status::NotFound, 0); continue; }
+            w.created(rpc::Status::Ok, pool.create_reference(r.source, r.target, target->state, r.layer)->id);
+            top = std::max<size_t>(top, r.layer);
+        }
+    }
+    void change_states(const rpc::Frame& f, rpc::FrameWriter& w, size_t& top) {
+        rpc::Decoder d(f);
+        rpc::ChangeRecord r;
+        std::vector<StateChange> changes;
+        for (uint16_t i = 0; i < f.head.count; ++i) {
+            if (!read(d, r) || !rpc::valid_state(r.state)) { w.changed(rpc::Status::BadRequest); continue; }
+            if (!pool.get_entity(r.entity)) { w.changed(rpc::Status::NotFound); continue; }
+            changes.push_back({r.entity, static_cast<OntState>(r.state), r.layer, {}});
+            w.changed(rpc::Status::Ok);
+            top = std::max<size_t>(top, r.layer);
+        }
+        rie.apply_state_changes(changes);
+        if (f.head.flags & rpc::Propagate)
+            for (const StateChange& c : changes) rie.propagate_integrity(c.entityId, c.newState, c.layer);
+    }
+    void query_references(const rpc::Frame& f, rpc::FrameWriter& w, const LayerSnapshot& snap) {
+        rpc::Decoder d(f);
+        for (uint16_t i = 0; i < f.head.count; ++i) {
+            uint64_t rid = d.get<uint64_t>();
+            RefIntegrityStatus s;
+            ReferenceObject* r = d.ok ? pool.get_reference(rid) : nullptr;
+            if (!d.ok) w.status(rpc::Status::BadRequest, RefIntegrityStatus::Valid, 0, 0, 0);
+            else if (!r || !snap.reference_status(rid, s)) w.status(rpc::Status::NotFound, RefIntegrityStatus::Valid, 0, 0, 0);
+            else w.status(rpc::Status::Ok, s, r->sourceEntityId, r->targetEntityId, snap.layer());
+        }
+    }
+
+public:
+    Executor(MemoryPool& p, ReferentialIntegrityEngine& r, ServerStats& s) : pool(p), rie(r), stats(s) {}
+
+    // Input frames were validated by the event loop; ops it does not know were answered there.
+    void run(Job& job) {
+        rpc::FrameWriter w(job.output);
+        auto epoch = EpochManager::global().pin(); // the compactor may retire what this job holds
+        std::unique_ptr<LayerSnapshot> snap;
+        if (!job.write) snap = std::make_unique<LayerSnapshot>(pool);
+        size_t top = 0, records = 0;
+        rpc::Frame f;
+        for (size_t pos = 0; pos < job.input.size(); pos += f.size) {
+            rpc::next_frame(job.input.data() + pos, job.input.size() - pos, f, nullptr);
+            w.begin(f.head.op, f.head.flags & rpc::Batch, f.head.tag);
+            switch (f.head.op) {
+            case rpc::CreateEntity: create_entities(f, w, top); break;
+            case rpc::CreateReference: create_references(f, w, top); break;
+            case rpc::StateChange: change_states(f, w, top); break;
+            case rpc::QueryReference: query_references(f, w, *snap); break;
+            }
+            w.end();
+            records += f.head.count;
+            stats.frames.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (top) pool.commit_layer(top); // once per write job, after its last propagation
+        stats.records.fetch_add(records, std::memory_order_relaxed);
+        (job.write ? stats.writes : stats.queries).fetch_add(records, std::memory_order_relaxed);
+    }
+};
+
+// The single-writer commit path: jobs run one at a time, in submission order.
+class WriterThread {
+    Executor& exec;
+    std::function<void(std::unique_ptr<Job>)> done;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::unique_ptr<Job>> queue;
+    bool stopping = false;
+    std::thread thread;
+
+    void loop() {
+        std::deque<std::unique_ptr<Job>> batch;
+        for (;;) {
+            {
+                std::unique_lock lock(mutex);
+                cv.wait(lock, [&] { return stopping || !queue.empty(); });
+                if (queue.empty()) return;
+                batch.swap(queue);
+            }
+            for (auto& job : batch) {
+                exec.run(*job);
+                done(std::move(job));
+            }
+            batch.clear();
+        }
+    }
+
+public:
+    WriterThread(Executor& e, std::function<void(std::unique_ptr<Job>)> d) : exec(e), done(std::move(d)), thread(&WriterThread::loop, this) {}
+    ~WriterThread() {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        cv.notify_one();
+        thread.join();
+    }
+    void submit(std::unique_ptr<Job> job) {
+        {
+            std::lock_guard lock(mutex);
+            queue.push_back(std::move(job));
+        }
+        cv.notify_one();
+    }
+};
+
+class Server {
+    struct Connection {
+        int fd;
+        uint64_t id;
+        std::vector<char> in, out;
+        size_t out_pos = 0;
+        uint64_t next_seq = 0, sent_seq = 0;                // jobs created / responses appended
+        std::map<uint64_t, std::vector<char>> ready;         // completed out of order
+        std::deque<std::unique_ptr<Job>> held;               // waiting for the other kind to drain
+        size_t writes_in_flight = 0, queries_in_flight = 0;
+        uint32_t events = EPOLLIN | EPOLLRDHUP;
+        bool peer_closed = false;
+        size_t pending() const { return out.size() - out_pos; }
+    };
+
+    ServerOptions opts;
+    MemoryPool pool;
+    ReferentialIntegrityEngine rie{pool};
+    std::unique_ptr<PoolCompactor> compactor;
+    ServerStats stats;
+    Executor exec{pool, rie, stats};
+    int epfd = -1, wakefd = -1, sigfd = -1;
+    std::vector<int> listeners;
+    std::unordered_map<int, std::unique_ptr<Connection>> by_fd;
+    std::unordered_map<uint64_t, Connection*> by_id;
+    uint64_t next_conn = 1, accepted = 0;
+    size_t in_flight = 0;
+    std::mutex completed_mutex;
+    std::vector<std::unique_ptr<Job>> completed;
+    std::vector<uint64_t> dirty; // connections with responses to send
+    WorkStealingPool readers;    // last: stopped before anything a job touches
+    std::unique_ptr<WriterThread> writer;
+
+    static bool fail(std::string* err, const std::string& msg) {
+        if (err) *err = msg + ": " + std::strerror(errno);
+        return false;
+    }
+    void watch(int fd, uint32_t events, int op = EPOLL_CTL_ADD) {
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.fd = fd;
+        ::epoll_ctl(epfd, op, fd, &ev);
+    }
+    bool listen_on(int fd, const sockaddr* addr, socklen_t len, std::string* err) {
+        if (fd < 0) return fail(err, "socket");
+        listeners.push_back(fd);
+        if (::bind(fd, addr, len) < 0) return fail(err, "bind");
+        if (::listen(fd, 1024) < 0) return fail(err, "listen");
+        watch(fd, EPOLLIN);
+        return true;
+    }
+
+    // Called from the writer thread and reader workers.
+    void complete(std::unique_ptr<Job> job) {
+        {
+            std::lock_guard lock(completed_mutex);
+            completed.push_back(std::move(job));
+        }
+        uint64_t one = 1;
+        (void)!::write(wakefd, &one, sizeof one);
+    }
+    void start_job(Connection& c, std::unique_ptr<Job> job) {
+        (job->write ? c.writes_in_flight : c.queries_in_flight)++;
+        ++in_flight;
+        if (job->write) return writer->submit(std::move(job));
+        Job* raw = job.release();
+        readers.submit([this, raw] {
+            std::unique_ptr<Job> j(raw);
+            exec.run(*j);
+            complete(std::move(j));
+        });
+    }
+    void dispatch(Connection& c, std::unique_ptr<Job> job) {
+        bool blocked = !c.held.empty() || (job->write ? c.queries_in_flight : c.writes_in_flight) > 0;
+        if (blocked) c.held.push_back(std::move(job));
+        else start_job(c, std::move(job));
+    }
+    void release_held(Connection& c) {
+        while (!c.held.empty() && (c.held.front()->write ? c.queries_in_flight : c.writes_in_flight) == 0) {
+            std::unique_ptr<Job> job = std::move(c.held.front());
+            c.held.pop_front();
+            start_job(c, std::move(job));
+        }
+    }
+    void append(Connection& c, std::vector<char>& bytes) {
+        if (c.out_pos == c.out.size()) c.out.clear(), c.out_pos = 0;
+        c.out.insert(c.out.end(), bytes.begin(), bytes.end());
+        dirty.push_back(c.id);
+    }
+    // An error response for a frame the executors must not see.
+    void reject(Connection& c, const rpc::Frame& f) {
+        std::vector<char> bytes;
+        rpc::FrameWriter w(bytes);
+        w.begin(f.head.op, f.head.flags & rpc::Batch, f.head.tag).changed(rpc::Status::BadRequest).end();
+        stats.errors.fetch_add(1, std::memory_order_relaxed);
+        c.ready.emplace(c.next_seq++, std::move(bytes));
+    }
+
+    // Cuts complete frames into jobs; false if the stream is corrupt.
+    bool parse(Connection& c) {
+        size_t pos = 0;
+        std::unique_ptr<Job> job;
+        rpc::Frame f;
+        std::string err;
+        auto cut = [&] {
+            if (job) dispatch(c, std::move(job));
+        };
+        while (rpc::next_frame(c.in.data() + pos, c.in.size() - pos, f, &err)) {
+            if (f.head.op < rpc::CreateEntity || f.head.op > rpc::QueryReference || f.head.count == 0 ||
+                f.head.count > rpc::max_records(f.head.op)) {
+                cut();
+                reject(c, f);
+            } else {
+                bool write = rpc::is_write(f.head.op);
+                if (job && job->write != write) cut();
+                if (!job) job.reset(new Job{c.id, c.next_seq++, write, {}, {}});
+                job->input.insert(job->input.end(), c.in.data() + pos, c.in.data() + pos + f.size);
+            }
+            pos += f.size;
+        }
+        cut();
+        c.in.erase(c.in.begin(), c.in.begin() + static_cast<ptrdiff_t>(pos));
+        flush_ready(c);
+        return err.empty();
+    }
+    void flush_ready(Connection& c) {
+        for (auto it = c.ready.begin(); it != c.ready.end() && it->first == c.sent_seq; it = c.ready.erase(it), ++c.sent_seq)
+            append(c, it->second);
+    }
+    void on_completed() {
+        uint64_t n;
+        (void)!::read(wakefd, &n, sizeof n);
+        std::vector<std::unique_ptr<Job>> jobs;
+        {
+            std::lock_guard lock(completed_mutex);
+            jobs.swap(completed);
+        }
+        for (auto& job : jobs) {
+            --in_flight;
+            auto it = by_id.find(job->conn);
+            if (it == by_id.end()) continue; // closed meanwhile
+            Connection& c = *it->second;
+            (job->write ? c.writes_in_flight : c.queries_in_flight)--;
+            c.ready.emplace(job->seq, std::move(job->output));
+            flush_ready(c);
+            release_held(c);
+        }
+    }
+
+    void accept_all(int lfd) {
+        for (;;) {
+            int fd = ::accept4(lfd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) return;
+            int one = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one); // fails harmlessly on Unix sockets
+            auto c = std::make_unique<Connection>();
+            c->fd = fd;
+            c->id = next_conn++;
+            by_id[c->id] = c.get();
+            by_fd[fd] = std::move(c);
+            watch(fd, EPOLLIN | EPOLLRDHUP);
+            ++accepted;
+        }
+    }
+    void close_conn(Connection& c) {
+        ::epoll_ctl(epfd, EPOLL_CTL_DEL, c.fd, nullptr);
+        ::close(c.fd);
+        by_id.erase(c.id);
+        by_fd.erase(c.fd);
+    }
+    // Reads what is available; false once the connection should close.
+    bool on_readable(Connection& c) {
+        char buf[64 * 1024];
+        for (;;) {
+            ssize_t n = ::recv(c.fd, buf, sizeof buf, 0);
+            if (n > 0) {
+                c.in.insert(c.in.end(), buf, buf + n);
+                if (static_cast<size_t>(n) < sizeof buf) break;
+                continue;
+            }
+            if (n == 0) c.peer_closed = true;
+            else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) return false;
+            break;
+        }
+        return parse(c);
+    }
+    // Sends coalesced responses; adjusts interest for backpressure. False on a dead socket.
+    bool on_writable(Connection& c) {
+        while (c.pending()) {
+            ssize_t n = ::send(c.fd, c.out.data() + c.out_pos, c.pending(), MSG_NOSIGNAL);
+            if (n > 0) { c.out_pos += n; continue; }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            if (n < 0 && errno == EINTR) continue;
+            return false;
+        }
+        if (!c.pending()) c.out.clear(), c.out_pos = 0;
+        bool read_more = !c.peer_closed && c.pending() < opts.max_pending;
+        uint32_t events = (read_more ? uint32_t(EPOLLIN | EPOLLRDHUP) : 0u) | (c.pending() ? uint32_t(EPOLLOUT) : 0u);
+        if (events != c.events) watch(c.fd, events, EPOLL_CTL_MOD);
+        c.events = events;
+        return true;
+    }
+    bool idle(const Connection& c) const {
+        return !c.pending() && !c.writes_in_flight && !c.queries_in_flight && c.held.empty() && c.ready.empty();
+    }
+
+public:
+    // Block SIGINT and SIGTERM first (pthread_sigmask) so no worker thread takes them.
+    explicit Server(const ServerOptions& o) : opts(o), readers(o.readers) {
+        if (opts.compact_ms)
+            compactor = std::make_unique<PoolCompactor>(pool, CompactorOptions{std::chrono::milliseconds(opts.compact_ms), opts.keep_layers});
+        writer = std::make_unique<WriterThread>(exec, [this](std::unique_ptr<Job> j) { complete(std::move(j)); });
+    }
+    ~Server() {
+        writer.reset();
+        for (int fd : listeners) ::close(fd);
+        for (auto& [fd, c] : by_fd) ::close(fd);
+        for (int fd : {epfd, wakefd, sigfd}) if (fd >= 0) ::close(fd);
+        if (!opts.unix_path.empty()) ::unlink(opts.unix_path.c_str());
+    }
+
+    bool open(std::string* err) {
+        epfd = ::epoll_create1(EPOLL_CLOEXEC);
+        wakefd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        sigset_t mask;
+        sigemptyset(&mask);
+        sigaddset(&mask, SIGINT);
+        sigaddset(&mask, SIGTERM);
+        sigfd = ::signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+        if (epfd < 0 || wakefd < 0 || sigfd < 0) return fail(err, "epoll/eventfd/signalfd");
+        watch(wakefd, EPOLLIN);
+        watch(sigfd, EPOLLIN);
+        if (!opts.unix_path.empty()) {
+            sockaddr_un a{};
+            a.sun_family = AF_UNIX;
+            if (opts.unix_path.size() >= sizeof a.sun_path) { errno = ENAMETOOLONG; return fail(err, "unix path"); }
+            std::strcpy(a.sun_path, opts.unix_path.c_str());
+            ::unlink(a.sun_path);
+            int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if (!listen_on(fd, reinterpret_cast<sockaddr*>(&a), sizeof a, err)) return false;
+        }
+        if (opts.tcp_port >= 0) {
+            sockaddr_in a{};
+            a.sin_family = AF_INET;
+            a.sin_port = htons(static_cast<uint16_t>(opts.tcp_port));
+            a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0), one = 1;
+            if (fd >= 0) ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof one);
+            if (!listen_on(fd, reinterpret_cast<sockaddr*>(&a), sizeof a, err)) return false;
+        }
+        if (listeners.empty()) { errno = EINVAL; return fail(err, "no --unix or --tcp endpoint"); }
+        return true;
+    }
+
+    // Serves until SIGINT or SIGTERM.
+    void run() {
+        epoll_event events[256];
+        for (bool running = true; running;) {
+            int n = ::epoll_wait(epfd, events, 256, -1);
+            for (int i = 0; i < n; ++i) {
+                int fd = events[i].data.fd;
+                if (fd == sigfd) { running = false; continue; }
+                if (fd == wakefd) { on_completed(); continue; }
+                if (std::find(listeners.begin(), listeners.end(), fd) != listeners.end()) { accept_all(fd); continue; }
+                auto it = by_fd.find(fd);
+                if (it == by_fd.end()) continue;
+                Connection& c = *it->second;
+                bool ok = !(events[i].events & EPOLLERR);
+                if (ok && (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP))) ok = on_readable(c);
+                if (ok) dirty.push_back(c.id);
+                else close_conn(c);
+            }
+            // One send per connection per pass, however many responses completed.
+            std::sort(dirty.begin(), dirty.end());
+            dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+            std::vector<uint64_t> touched;
+            touched.swap(dirty);
+            for (uint64_t id : touched) {
+                auto it = by_id.find(id);
+                if (it == by_id.end()) continue;
+                Connection& c = *it->second;
+                if (!on_writable(c) || (c.peer_closed && idle(c))) close_conn(c);
+            }
+        }
+        // Jobs still running reference this server; let them finish.
+        while (in_flight) {
+            int n = ::epoll_wait(epfd, events, 256, -1);
+            for (int i = 0; i < n; ++i)
+                if (events[i].data.fd == wakefd) on_completed();
+        }
+    }
+
+    void print_stats() const {
+        CompactorStats c = compactor ? compactor->stats() : CompactorStats{};
+        std::printf("{\"server\":\"rie\",\"connections\":%llu,\"frames\":%llu,\"records\":%llu,\"writes\":%llu,"
+                    "\"queries\":%llu,\"errors\":%llu,\"committed_layer\":%zu,\"live_entities\":%zu,\"live_references\":%zu,"
+                    "\"retired_entities\":%llu,\"retired_references\":%llu,\"chunks_released\":%llu}\n",
+                    static_cast<unsigned long long>(accepted), static_cast<unsigned long long>(stats.frames.load()),
+                    static_cast<unsigned long long>(stats.records.load()), static_cast<unsigned long long>(stats.writes.load()),
+                    static_cast<unsigned long long>(stats.queries.load()), static_cast<unsigned long long>(stats.errors.load()),
+                    pool.committed_layer(), pool.entity_usage().live, pool.reference_usage().live,
+                    static_cast<unsigned long long>(c.entities), static_cast<unsigned long long>(c.references),
+                    static_cast<unsigned long long>(c.chunks));
+    }
+};
+
+int main(int argc, char** argv) {
+    ServerOptions opts;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string opt = argv[i];
+        const char* v = argv[i + 1];
+        if (opt == "--unix") opts.unix_path = v;
+        else if (opt == "--tcp") opts.tcp_port = std::atoi(v);
+        else if (opt == "--readers") opts.readers = std::max<size_t>(1, std::strtoull(v, nullptr, 10));
+        else if (opt == "--max-pending") opts.max_pending = std::strtoull(v, nullptr, 10);
+        else if (opt == "--compact-ms") opts.compact_ms = std::strtoull(v, nullptr, 10);
+        else if (opt == "--keep-layers") opts.keep_layers = std::strtoull(v, nullptr, 10);
+        else { std::fprintf(stderr, "unknown option %s\n", opt.c_str()); return 2; }
+    }
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    ::pthread_sigmask(SIG_BLOCK, &mask, nullptr); // inherited by the reader and writer threads
+    Server server(opts);
+    std::string err;
+    if (!server.open(&err)) {
+        std::fprintf(stderr, "rie_server: %s\n", err.c_str());
+        return 1;
+    }
+    std::fprintf(stderr, "rie_server: listening%s%s%s\n", opts.unix_path.empty() ? "" : " on ", opts.unix_path.c_str(),
+                 opts.tcp_port >= 0 ? (" and 127.0.0.1:" + std::to_string(opts.tcp_port)).c_str() : "");
+    server.run();
+    server.print_stats();
+    return 0;
+}
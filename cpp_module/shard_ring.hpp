@@ -0,0 +1,98 @@
+// Shared-Memory Rings
+// Lock-free single-producer single-consumer message rings between processes
+// Author: 1proprogrammerchant
+// C++17+ required (POSIX shared memory)
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <sys/mman.h>
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "ring indices must be address-free atomics");
+
+// Fixed-size trivially copyable messages in a power-of-two ring that lives in memory
+// mapped by both processes. head and tail only grow; each side caches the other's
+// index and rereads it only when the ring looks full (or empty). push and pop move
+// whole batches and publish them with one release store.
+template <typename T>
+class SpscRing {
+    static_assert(std::is_trivially_copyable<T>::value, "ring messages are copied between processes");
+
+public:
+    struct Header {
+        alignas(64) std::atomic<uint64_t> head; // next slot to read
+        alignas(64) std::atomic<uint64_t> tail; // next slot to write
+        alignas(64) uint64_t slots;
+    };
+
+    static size_t bytes(size_t slots) { return sizeof(Header) + slots * sizeof(T); }
+
+    SpscRing() = default;
+    // Attaches to a ring at mem; init() must have run once, before the processes split.
+    explicit SpscRing(void* mem) : h(static_cast<Header*>(mem)), data(reinterpret_cast<T*>(h + 1)), mask(h->slots - 1) {}
+
+    // slots must be a power of two.
+    static void init(void* mem, size_t slots) {
+        Header* h = new (mem) Header;
+        h->head.store(0, std::memory_order_relaxed);
+        h->tail.store(0, std::memory_order_relaxed);
+        h->slots = slots;
+    }
+
+    // Producer: copies up to n messages in; returns how many fit.
+    size_t push(const T* msgs, size_t n) {
+        uint64_t tail = h->tail.load(std::memory_order_relaxed);
+        if (tail - cached_head + n > h->slots) cached_head = h->head.load(std::memory_order_acquire);
+        n = std::min<size_t>(n, h->slots - (tail - cached_head));
+        for (size_t i = 0; i < n; ++i) data[(tail + i) & mask] = msgs[i];
+        if (n) h->tail.store(tail + n, std::memory_order_release);
+        return n;
+    }
+    // Consumer: copies up to max messages out; returns how many.
+    size_t pop(T* out, size_t max) {
+        uint64_t head = h->head.load(std::memory_order_relaxed);
+        if (cached_tail == head) cached_tail = h->tail.load(std::memory_order_acquire);
+        size_t n = std::min<size_t>(max, cached_tail - head);
+        for (size_t i = 0; i < n; ++i) out[i] = data[(head + i) & mask];
+        if (n) h->head.store(head + n, std::memory_order_release);
+        return n;
+    }
+    size_t size() const { return h->tail.load(std::memory_order_acquire) - h->head.load(std::memory_order_acquire); }
+
+private:
+    Header* h = nullptr;
+    T* data = nullptr;
+    uint64_t mask = 0;
+    uint64_t cached_head = 0; // producer side
+    uint64_t cached_tail = 0; // consumer side
+};
+
+// Anonymous shared mapping: inherited across fork(), freed with the last process.
+class SharedRegion {
+    void* base = MAP_FAILED;
+    size_t length = 0;
+
+public:
+    SharedRegion() = default;
+    SharedRegion(const SharedRegion&) = delete;
+    SharedRegion& operator=(const SharedRegion&) = delete;
+    ~SharedRegion() { release(); }
+
+    bool map(size_t n) {
+        release();
+        base = ::mmap(nullptr, n, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        length = base == MAP_FAILED ? 0 : n;
+        return base != MAP_FAILED;
+    }
+    void release() {
+        if (base != MAP_FAILED) ::munmap(base, length);
+        base = MAP_FAILED;
+        length = 0;
+    }
+    char* data() const { return base == MAP_FAILED ? nullptr : static_cast<char*>(base); }
+    size_t size() const { return length; }
+};
@@ -0,0 +1,446 @@
+// Sharded RIE
+// Entities partitioned across worker processes; cross-shard propagation over shared-memory rings
+// Author: 1proprogrammerchant
+// C++17+ required (POSIX: fork, shared memory)
+#pragma once
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <sched.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "oesm_highperf.hpp"
+#include "shard_ring.hpp"
+
+namespace shard {
+
+constexpr size_t MAX_SHARDS = 64;
+
+// EntityId: key % shards, for dense ids. IdentityKey: keys are hashes of OIMR identity
+// keys (identity_key()) or otherwise sparse; they are mixed before the modulo.
+enum class Partition { EntityId, IdentityKey };
+
+// The 64-bit entity key for an OIMR identity key (the registry keeps at most 31 bytes).
+inline uint64_t identity_key(std::string_view key) {
+    uint64_t h = 1469598103934665603ull;
+    for (size_t i = 0; i < key.size() && i < 31 && key[i]; ++i) h = (h ^ static_cast<uint8_t>(key[i])) * 1099511628211ull;
+    return h;
+}
+
+inline size_t shard_of(uint64_t key, size_t shards, Partition p) {
+    if (p == Partition::IdentityKey) {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdull;
+        key ^= key >> 33;
+    }
+    return static_cast<size_t>(key % shards);
+}
+
+struct Message {
+    enum Type : uint8_t { CreateEntity, CreateReference, StateChange, Ungrounded, Barrier, Stats, Stop, Commit };
+    uint8_t type;
+    uint8_t state; // OntState; RefIntegrityStatus for Ungrounded
+    uint8_t reserved[6];
+    uint64_t key;   // entity key (CreateReference: source); Barrier/Stats/Commit: epoch
+    uint64_t other; // CreateReference: target key
+    uint64_t layer;
+};
+static_assert(sizeof(Message) == 32, "two messages per cache line");
+
+struct Options {
+    size_t shards = 4;
+    Partition partition = Partition::EntityId;
+    size_t ring_slots = 4096; // messages per ring, power of two
+    size_t batch = 256;       // messages buffered per destination before a push
+};
+
+struct ShardStats {
+    uint64_t entities = 0, references = 0;
+    uint64_t status[7] = {};  // references per RefIntegrityStatus
+    uint64_t commands = 0, rejected = 0; // rejected: unknown entity keys, duplicate creations
+    uint64_t sent = 0, received = 0;     // cross-shard messages
+    uint64_t committed_layer = 0;        // of the shard's pool
+};
+
+// Per-shard counters in the shared region; only that shard writes them.
+struct alignas(64) Control {
+    std::atomic<uint64_t> sent, received; // counted when queued / after processing
+    std::atomic<uint64_t> commands, rejected;
+    std::atomic<uint64_t> barrier_epoch, stats_epoch, commit_epoch;
+    std::atomic<uint64_t> entities, references, status[7], committed_layer;
+};
+
+struct Shared {
+    std::atomic<uint64_t> committed_layer;
+    Control shards[MAX_SHARDS];
+};
+
+// Region layout: Shared, then one command ring per shard (coordinator -> shard), then
+// shards * shards peer rings (row = sender).
+struct Layout {
+    size_t shards, ring_bytes;
+    size_t commands(size_t s) const { return align(sizeof(Shared)) + s * ring_bytes; }
+    size_t peer(size_t from, size_t to) const { return commands(shards) + (from * shards + to) * ring_bytes; }
+    size_t total() const { return peer(shards, 0); }
+    static size_t align(size_t n) { return (n + 63) & ~size_t(63); }
+};
+
+// One shard: a private pool and engine, fed by the command ring and the peer rings.
+// References live on their target's shard; a source on another shard is an external
+// id there, and cascades that reach it leave as Ungrounded messages to its shard, which
+// continues them with propagate_ungrounded. Outgoing messages queue per destination
+// and never block, so shards cannot deadlock on full rings.
+class Worker {
+    const size_t self;
+    const Options opts;
+    Control& ctl;
+    SpscRing<Message> commands;
+    std::vector<SpscRing<Message>> inbox, outbox_ring;
+    std::vector<std::vector<Message>> outbox;
+    MemoryPool pool;
+    ReferentialIntegrityEngine rie{pool};
+    std::unordered_map<uint64_t, size_t> entities;   // key -> local id
+    std::unordered_map<uint64_t, size_t> remote_ids; // key -> external id
+    std::vector<uint64_t> remote_keys;               // external id -> key
+    std::vector<StateChange> changes;
+    std::vector<Message> buf;
+    bool cascades[ONT_STATE_COUNT] = {};
+    size_t layer = 0;
+    ExitFn exits;
+
+    size_t find(uint64_t key) {
+        auto it = entities.find(key);
+        if (it != entities.end()) return it->second;
+        ctl.rejected.fetch_add(1, std::memory_order_relaxed);
+        return 0;
+    }
+    size_t source_id(uint64_t key) {
+        if (shard_of(key, opts.shards, opts.partition) == self) return find(key);
+        auto [it, fresh] = remote_ids.try_emplace(key, EXTERNAL_ENTITY | remote_keys.size());
+        if (fresh) remote_keys.push_back(key);
+        return it->second;
+    }
+    void queue(size_t to, const Message& m) {
+        outbox[to].push_back(m);
+        ctl.sent.fetch_add(1, std::memory_order_relaxed);
+    }
+    // Consecutive state changes of one layer go through the engine as one batch; then
+    // each entity's last change is propagated if its new state can unground a reference.
+    void flush_changes() {
+        if (changes.empty()) return;
+        rie.apply_state_changes(changes);
+        std::unordered_map<size_t, size_t> last;
+        for (size_t i = 0; i < changes.size(); ++i) last[changes[i].entityId] = i;
+        for (size_t i = 0; i < changes.size(); ++i) {
+            const StateChange& c = changes[i];
+            if (last[c.entityId] != i || !cascades[static_cast<size_t>(c.newState)]) continue;
+            layer = c.layer;
+            rie.propagate_integrity(c.entityId, c.newState, c.layer, c.splitIds, {}, exits);
+        }
+        changes.clear();
+    }
+    void publish_stats() {
+        uint64_t refs = 0, status[7] = {};
+        for (ReferenceObject* r : pool.all_references()) ++refs, ++status[static_cast<size_t>(r->integrityStatus)];
+        ctl.entities.store(pool.all_entities().size(), std::memory_order_relaxed);
+        ctl.references.store(refs, std::memory_order_relaxed);
+        for (size_t i = 0; i < 7; ++i) ctl.status[i].store(status[i], std::memory_order_relaxed);
+        ctl.committed_layer.store(pool.committed_layer(), std::memory_order_relaxed);
+    }
+    bool handle_commands(size_t n) {
+        bool running = true;
+        for (size_t i = 0; i < n; ++i) {
+            const Message& m = buf[i];
+            if (m.type != Message::StateChange || (!changes.empty() && changes.back().layer != m.layer)) flush_changes();
+            switch (m.type) {
+            case Message::CreateEntity: {
+                auto [it, fresh] = entities.try_emplace(m.key, 0);
+                if (fresh) it->second = pool.create_entity(Symbol(0), AttributeSet(), static_cast<OntState>(m.state), m.layer)->id;
+                else ctl.rejected.fetch_add(1, std::memory_order_relaxed); // the key keeps its entity
+                break;
+            }
+            case Message::CreateReference:
+                if (size_t tgt = find(m.other))
+                    if (size_t src = source_id(m.key)) pool.create_reference(src, tgt, static_cast<OntState>(m.state), m.layer);
+                break;
+            case Message::StateChange:
+                if (size_t id = find(m.key)) changes.push_back({id, static_cast<OntState>(m.state), m.layer, {}});
+                break;
+            case Message::Barrier:
+                ctl.barrier_epoch.store(m.key, std::memory_order_release);
+                break;
+            case Message::Stats:
+                publish_stats();
+                ctl.stats_epoch.store(m.key, std::memory_order_release);
+                break;
+            case Message::Commit:
+                pool.commit_layer(m.layer);
+                ctl.commit_epoch.store(m.key, std::memory_order_release);
+                break;
+            case Message::Stop:
+                running = false;
+                break;
+            }
+        }
+        if (!commands.size()) flush_changes(); // else the batch continues with the next pop
+        ctl.commands.fetch_add(n, std::memory_order_relaxed);
+        return running;
+    }
+    // Runs of Ungrounded messages with one status and layer continue as one cascade.
+    void handle_peer(size_t n) {
+        std::vector<size_t> ids;
+        for (size_t i = 0; i < n;) {
+            size_t j = i;
+            ids.clear();
+            for (; j < n && buf[j].state == buf[i].state && buf[j].layer == buf[i].layer; ++j) {
+                auto it = entities.find(buf[j].key);
+                if (it != entities.end()) ids.push_back(it->second);
+            }
+            layer = buf[i].layer;
+            rie.propagate_ungrounded(ids, static_cast<RefIntegrityStatus>(buf[i].state), layer, {}, exits);
+            i = j;
+        }
+        ctl.received.fetch_add(n, std::memory_order_release);
+    }
+    size_t flush_outboxes() {
+        size_t moved = 0;
+        for (size_t to = 0; to < outbox.size(); ++to) {
+            std::vector<Message>& q = outbox[to];
+            if (q.empty()) continue;
+            size_t n = outbox_ring[to].push(q.data(), q.size());
+            q.erase(q.begin(), q.begin() + static_cast<ptrdiff_t>(n));
+            moved += n;
+        }
+        return moved;
+    }
+
+public:
+    Worker(size_t s, const Options& o, char* region, const Layout& l)
+        : self(s), opts(o), ctl(reinterpret_cast<Shared*>(region)->shards[s]), commands(region + l.commands(s)),
+          outbox(o.shards), buf(o.batch * 4) {
+        for (size_t p = 0; p < o.shards; ++p) {
+            inbox.emplace_back(region + l.peer(p, s));
+            outbox_ring.emplace_back(region + l.peer(s, p));
+        }
+        const IntegrityPolicy& rules = rie.integrity_policy();
+        for (size_t next = 0; next < ONT_STATE_COUNT; ++next)
+            for (size_t created = 0; created < ONT_STATE_COUNT; ++created) {
+                RefIntegrityStatus st = rules.classify(static_cast<OntState>(created), static_cast<OntState>(next));
+                cascades[next] |= st == RefIntegrityStatus::Unresolved || st == RefIntegrityStatus::Invalidated;
+            }
+        exits = [this](size_t eid, RefIntegrityStatus st) {
+            uint64_t key = remote_keys[eid & ~EXTERNAL_ENTITY];
+            queue(shard_of(key, opts.shards, opts.partition),
+                  {Message::Ungrounded, static_cast<uint8_t>(st), {}, key, 0, layer});
+        };
+    }
+
+    void run() {
+        size_t idle = 0;
+        for (bool running = true; running || flush_outboxes();) {
+            size_t work = 0;
+            if (size_t n = commands.pop(buf.data(), buf.size())) {
+                running = handle_commands(n);
+                work += n;
+            }
+            for (size_t p = 0; p < inbox.size(); ++p) {
+                if (p == self) continue;
+                if (size_t n = inbox[p].pop(buf.data(), buf.size())) {
+                    handle_peer(n);
+                    work += n;
+                }
+            }
+            work += flush_outboxes();
+            if (work) idle = 0;
+            else if (++idle > 4096) ::usleep(50);
+            else if (idle > 16) ::sched_yield();
+        }
+    }
+};
+
+} // namespace shard
+
+// Coordinator for a sharded engine: start() forks one worker process per shard and
+// routes entity and reference creation and state changes to them by entity key
+// (references go to their target's shard). Calls are buffered per shard and pushed in
+// batches. barrier(layer) returns once every shard has applied everything sent so far
+// and no cross-shard message is in flight; only then is the layer globally committed.
+// One coordinator thread; create the coordinator before starting other threads.
+class ShardedRIE {
+    shard::Options opts;
+    shard::Layout layout{0, 0};
+    SharedRegion region;
+    shard::Shared* shared = nullptr;
+    std::vector<SpscRing<shard::Message>> commands;
+    std::vector<std::vector<shard::Message>> pending;
+    std::vector<pid_t> pids;
+    uint64_t epoch = 0;
+
+    static bool fail(std::string* err, const std::string& msg) {
+        if (err) *err = msg;
+        return false;
+    }
+    bool alive(std::string* err) {
+        for (size_t s = 0; s < pids.size(); ++s) {
+            int st;
+            if (pids[s] > 0 && ::waitpid(pids[s], &st, WNOHANG) == pids[s]) {
+                pids[s] = -1;
+                return fail(err, "shard " + std::to_string(s) + " exited");
+            }
+        }
+        return true;
+    }
+    void send(size_t s, const shard::Message& m) {
+        pending[s].push_back(m);
+        if (pending[s].size() >= opts.batch) flush(s);
+    }
+    // Waits for ring space; gives up (dropping the batch) if the shard has died.
+    void flush(size_t s) {
+        std::vector<shard::Message>& q = pending[s];
+        for (size_t done = 0, spins = 0; done < q.size() && pids[s] > 0;) {
+            size_t n = commands[s].push(q.data() + done, q.size() - done);
+            done += n;
+            if (n) continue;
+            if (++spins % 1024 == 0) alive(nullptr);
+            ::sched_yield();
+        }
+        q.clear();
+    }
+    // Sends m to every shard and waits until each has published epoch in field.
+    bool broadcast(shard::Message::Type type, std::atomic<uint64_t> shard::Control::*field, std::string* err,
+                   size_t layer = 0) {
+        ++epoch;
+        for (size_t s = 0; s < opts.shards; ++s) {
+            send(s, {static_cast<uint8_t>(type), 0, {}, epoch, 0, layer});
+            flush(s);
+        }
+        for (size_t s = 0, spins = 0; s < opts.shards;) {
+            if ((shared->shards[s].*field).load(std::memory_order_acquire) >= epoch) { ++s; continue; }
+            if (++spins % 1024 == 0 && !alive(err)) return false;
+            ::sched_yield();
+        }
+        return true;
+    }
+    uint64_t total(std::atomic<uint64_t> shard::Control::*field) const {
+        uint64_t n = 0;
+        for (size_t s = 0; s < opts.shards; ++s) n += (shared->shards[s].*field).load(std::memory_order_acquire);
+        return n;
+    }
+
+public:
+    ShardedRIE() = default;
+    ShardedRIE(const ShardedRIE&) = delete;
+    ShardedRIE& operator=(const ShardedRIE&) = delete;
+    ~ShardedRIE() { stop(); }
+
+    bool start(const shard::Options& o, std::string* err = nullptr) {
+        if (!pids.empty()) return fail(err, "already started");
+        if (o.shards == 0 || o.shards > shard::MAX_SHARDS) return fail(err, "shards must be 1.." + std::to_string(shard::MAX_SHARDS));
+        if (o.ring_slots < 2 || (o.ring_slots & (o.ring_slots - 1))) return fail(err, "ring_slots must be a power of two");
+        opts = o;
+        opts.batch = std::max<size_t>(1, std::min(opts.batch, opts.ring_slots));
+        layout = {opts.shards, shard::Layout::align(SpscRing<shard::Message>::bytes(opts.ring_slots))};
+        if (!region.map(layout.total())) return fail(err, "cannot map shared region");
+        shared = new (region.data()) shard::Shared; // the mapping is zero-filled
+        for (size_t s = 0; s < opts.shards; ++s) {
+            SpscRing<shard::Message>::init(region.data() + layout.commands(s), opts.ring_slots);
+            for (size_t p = 0; p < opts.shards; ++p)
+                SpscRing<shard::Message>::init(region.data() + layout.peer(s, p), opts.ring_slots);
+        }
+        pending.assign(opts.shards, {});
+        std::fflush(nullptr);
+        for (size_t s = 0; s < opts.shards; ++s) {
+            pid_t pid = ::fork();
+            if (pid < 0) {
+                stop();
+                return fail(err, "fork failed");
+            }
+            if (pid == 0) {
+                shard::Worker(s, opts, region.data(), layout).run();
+                ::_exit(0);
+            }
+            pids.push_back(pid);
+            commands.emplace_back(region.data() + layout.commands(s));
+        }
+        return true;
+    }
+
+    size_t shards() const { return opts.shards; }
+    size_t shard_of(uint64_t key) const { return shard::shard_of(key, opts.shards, opts.partition); }
+
+    // A key that already has an entity keeps it; the repeat counts as rejected.
+    void create_entity(uint64_t key, OntState s, size_t layer) {
+        send(shard_of(key), {shard::Message::CreateEntity, static_cast<uint8_t>(s), {}, key, 0, layer});
+    }
+    // Both entities must have been created; targetState is the target's state now.
+    void create_reference(uint64_t source, uint64_t target, OntState targetState, size_t layer) {
+        send(shard_of(target), {shard::Message::CreateReference, static_cast<uint8_t>(targetState), {}, source, target, layer});
+    }
+    void apply_state_change(uint64_t key, OntState s, size_t layer) {
+        send(shard_of(key), {shard::Message::StateChange, static_cast<uint8_t>(s), {}, key, 0, layer});
+    }
+
+    // Global layer barrier. Counters are read received-first: every message is counted
+    // as sent before the one that caused it is counted as received, so equal sums mean
+    // nothing was in flight when the received counters were read. Then every shard's
+    // pool commits layer (its compaction, reclamation and snapshots advance to it), and
+    // the coordinator's committed layer follows.
+    bool barrier(size_t layer, std::string* err = nullptr) {
+        if (pids.empty()) return fail(err, "not started");
+        if (!broadcast(shard::Message::Barrier, &shard::Control::barrier_epoch, err)) return false;
+        for (size_t spins = 0;; ++spins) {
+            uint64_t received = total(&shard::Control::received);
+            if (received == total(&shard::Control::sent)) break;
+            if (spins % 1024 == 1023 && !alive(err)) return false;
+            ::sched_yield();
+        }
+        // Quiescent: every shard's writes for the layer are in, so each pool commits it.
+        if (!broadcast(shard::Message::Commit, &shard::Control::commit_epoch, err, layer)) return false;
+        uint64_t cur = shared->committed_layer.load(std::memory_order_relaxed);
+        if (layer > cur) shared->committed_layer.store(layer, std::memory_order_release);
+        return true;
+    }
+    size_t committed_layer() const { return shared ? shared->committed_layer.load(std::memory_order_acquire) : 0; }
+
+    // Per-shard counts as of a barrier taken now.
+    bool stats(std::vector<shard::ShardStats>& out, std::string* err = nullptr) {
+        if (!barrier(committed_layer(), err) || !broadcast(shard::Message::Stats, &shard::Control::stats_epoch, err)) return false;
+        out.assign(opts.shards, {});
+        for (size_t s = 0; s < opts.shards; ++s) {
+            const shard::Control& c = shared->shards[s];
+            shard::ShardStats& st = out[s];
+            st.entities = c.entities.load(std::memory_order_relaxed);
+            st.references = c.references.load(std::memory_order_relaxed);
+            for (size_t i = 0; i < 7; ++i) st.status[i] = c.status[i].load(std::memory_order_relaxed);
+            st.commands = c.commands.load(std::memory_order_relaxed);
+            st.rejected = c.rejected.load(std::memory_order_relaxed);
+            st.sent = c.sent.load(std::memory_order_relaxed);
+            st.received = c.received.load(std::memory_order_relaxed);
+            st.committed_layer = c.committed_layer.load(std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    // Stops the workers after they drain what was sent; false if one did not exit cleanly.
+    bool stop(std::string* err = nullptr) {
+        if (pids.empty()) return true;
+        bool ok = true;
+        for (size_t s = 0; s < pids.size(); ++s)
+            if (pids[s] > 0) {
+                send(s, {shard::Message::Stop, 0, {}, 0, 0, 0});
+                flush(s);
+            }
+        for (pid_t pid : pids) {
+            int st = 0;
+            if (pid > 0 && (::waitpid(pid, &st, 0) != pid || !WIFEXITED(st) || WEXITSTATUS(st) != 0)) ok = false;
+        }
+        if (!ok) fail(err, "a shard exited abnormally");
+        pids.clear();
+        commands.clear();
+        pending.clear();
+        shared = nullptr;
+        region.release();
+        return ok;
+    }
+};
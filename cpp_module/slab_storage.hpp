@@ -0,0 +1,496 @@
+// Generational Slab Storage
+// Concurrent chunked object arena with O(1) handle lookup
+// Author: 1proprogrammerchant
+// C++17+ required
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "epoch_reclaim.hpp"
+#include "rie_metrics.hpp"
+
+// Handle layout: low 32 bits = slot index, high 32 bits = slot generation.
+// Slot 0 is never handed out, so a handle of 0 always means "no object".
+// Generation starts at 0, so first-use handles are plain 1, 2, 3, ...
+constexpr uint32_t handle_index(size_t h) { return static_cast<uint32_t>(h & 0xFFFFFFFFu); }
+constexpr uint32_t handle_generation(size_t h) { return static_cast<uint32_t>(h >> 32); }
+constexpr size_t make_handle(uint32_t index, uint32_t generation) {
+    return (static_cast<size_t>(generation) << 32) | index;
+}
+
+// Ids with the top bit set name entities held outside this pool (another shard). The
+// slab never hands them out (generations stay below 2^31); a reference may use one as
+// its source, and propagation reports it instead of following it.
+constexpr size_t EXTERNAL_ENTITY = size_t(1) << 63;
+constexpr bool is_external(size_t eid) { return (eid & EXTERNAL_ENTITY) != 0; }
+
+// Objects live inline in fixed-size chunks, so addresses are stable for the
+// lifetime of the object and no per-object heap allocation is made.
+//
+// Concurrency: every thread reserves whole chunks for itself (one atomic add per
+// CHUNK_SIZE objects) and fills them without further synchronization. A chunk is
+// published in a fixed directory with a release store and a slot becomes visible
+// when its state word flips to live, so get/for_each never lock and never see a
+// half-built object. Freed slots go to a shared free list, touched only when it is
+// non-empty; so does the unused rest of a thread's chunk when the thread exits or
+// moves on to more slabs than it keeps cursors for. Erasing an object other threads may still use is the caller's problem;
+// retire() instead defers destruction until every thread inside an EpochManager guard
+// has moved on, and release_chunks() hands emptied chunks back the same way. Lookups
+// that may race either must run inside a guard (for_each and emplace_at take one).
+
+// Slot counts and the memory behind them
+struct SlabUsage {
+    size_t live = 0, retired = 0, free = 0; // retired: unlinked, waiting for readers to leave
+    size_t chunks = 0, bytes = 0;
+};
+
+template <typename T, size_t ChunkBits = 10>
+class Slab {
+    static constexpr size_t CHUNK_SIZE = size_t(1) << ChunkBits;
+    static constexpr size_t CHUNK_MASK = CHUNK_SIZE - 1;
+    static constexpr size_t MAX_CHUNKS = size_t(1) << 16; // 64M objects at the default chunk size
+
+    // Slot state word: generation << 2 | phase
+    static constexpr uint64_t FREE = 0, BUILDING = 1, LIVE = 2, RETIRED = 3;
+    static constexpr uint64_t state(uint32_t gen, uint64_t phase) { return uint64_t(gen) << 2 | phase; }
+    // Generations stay below 2^31 (see EXTERNAL_ENTITY). A slot vacated at the last one
+    // is never reused: it stays BUILDING with no object, off the free list, and pins its
+    // chunk, so no handle into it can match again.
+    static constexpr uint32_t MAX_GENERATION = (uint32_t(1) << 31) - 1;
+    static_assert(make_handle(0, MAX_GENERATION) < EXTERNAL_ENTITY, "generations must not reach the external bit");
+    // Word for a slot whose object at generation gen was just destroyed
+    static constexpr uint64_t vacated(uint32_t gen) { return gen < MAX_GENERATION ? state(gen + 1, FREE) : state(gen, BUILDING); }
+
+    struct Slot {
+        alignas(T) unsigned char storage[sizeof(T)];
+        std::atomic<uint64_t> word{state(0, FREE)};
+        T* object() { return std::launder(reinterpret_cast<T*>(storage)); }
+    };
+
+    // A thread's current chunk in one slab: slots [next, end) are its own to hand out.
+    struct Cursor {
+        uint64_t slab = 0;
+        uint32_t next = 0, end = 0;
+    };
+    static constexpr size_t CURSORS = 4;
+    struct ThreadCursors {
+        Cursor c[CURSORS];
+        size_t victim = 0;
+        ~ThreadCursors() {
+            for (auto& cur : c) hand_back(cur);
+        }
+    };
+
+    const uint64_t instance; // distinguishes slabs in thread-local cursors
+    std::unique_ptr<std::atomic<Slot*>[]> chunks;
+    std::atomic<uint32_t> reserved_chunks{0};
+    std::atomic<size_t> live_count{0};
+    std::atomic<size_t> chunk_count{0};
+    mutable std::mutex free_mutex;
+    const metrics::Lock free_lock; // contention is reported under this name
+    std::vector<uint32_t> free_slots;
+    std::atomic<size_t> free_hint{0};
+    std::vector<uint32_t> restored_chunks; // reserved by emplace_at, not yet on the free list
+    std::atomic<bool> restored_pending{false};
+    std::vector<std::pair<uint32_t, uint32_t>> released; // (chunk, first unused generation), under free_mutex
+    std::atomic<size_t> released_hint{0};
+    std::vector<std::pair<uint64_t, uint32_t>> limbo; // (epoch, slot) of retired objects, under free_mutex
+    std::atomic<size_t> limbo_count{0};
+
+    static uint64_t next_instance() {
+        static std::atomic<uint64_t> counter{0};
+        return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+    static ThreadCursors& cursors() {
+        thread_local ThreadCursors tc;
+        return tc;
+    }
+    // Live slabs by instance, so a cursor's unused slots only go back to a slab that
+    // still exists. Leaked on purpose: thread exit may run after static destruction starts.
+    static std::mutex& registry_mutex() {
+        static std::mutex* m = new std::mutex;
+        return *m;
+    }
+    static std::unordered_map<uint64_t, Slab*>& registry() {
+        static auto* r = new std::unordered_map<uint64_t, Slab*>;
+        return *r;
+    }
+    // Returns the unused rest of a cursor's chunk to its slab (evicted cursor, exiting thread).
+    static void hand_back(Cursor& cur) {
+        if (cur.next < cur.end) {
+            std::lock_guard lock(registry_mutex());
+            auto it = registry().find(cur.slab);
+            if (it != registry().end()) it->second->give_back(cur.next, cur.end);
+        }
+        cur.next = cur.end = 0;
+    }
+
+    Slot* slot_at(uint32_t index) const {
+        if (index == 0 || (index >> ChunkBits) >= MAX_CHUNKS) return nullptr;
+        Slot* chunk = chunks[index >> ChunkBits].load(std::memory_order_acquire);
+        return chunk ? &chunk[index & CHUNK_MASK] : nullptr;
+    }
+    // Chunk k, allocating and publishing it if nobody has yet.
+    Slot* chunk(size_t k) {
+        Slot* c = chunks[k].load(std::memory_order_acquire);
+        if (c) return c;
+        Slot* fresh = new Slot[CHUNK_SIZE];
+        if (chunks[k].compare_exchange_strong(c, fresh, std::memory_order_acq_rel)) {
+            chunk_count.fetch_add(1, std::memory_order_relaxed);
+            return fresh;
+        }
+        delete[] fresh;
+        return c;
+    }
+    // Claims a free slot for construction; fails if it is live or being built.
+    bool claim(Slot& s, uint32_t gen, bool keep_generation) {
+        uint64_t w = s.word.load(std::memory_order_relaxed);
+        do {
+            if ((w & 3) != FREE) return false;
+            if (keep_generation) gen = static_cast<uint32_t>(w >> 2);
+        } while (!s.word.compare_exchange_weak(w, state(gen, BUILDING), std::memory_order_acquire));
+        return true;
+    }
+    // Puts the slots of [first, last) that are still free on the free list.
+    void give_back(uint32_t first, uint32_t last) {
+        if (first >= last) return;
+        metrics::TimedLock lock(free_mutex, free_lock);
+        for (uint32_t i = first; i < last; ++i) {
+            Slot* s = slot_at(i);
+            if (s && (s->word.load(std::memory_order_relaxed) & 3) == FREE) free_slots.push_back(i);
+        }
+        free_hint.store(free_slots.size(), std::memory_order_relaxed);
+    }
+    // Moves every slot of a free chunk to BUILDING so nothing can claim it; all or none.
+    bool lock_chunk(Slot* c) {
+        for (size_t i = 0; i < CHUNK_SIZE; ++i) {
+            uint64_t w = c[i].word.load(std::memory_order_relaxed);
+            if ((w & 3) == FREE && c[i].word.compare_exchange_strong(w, (w & ~uint64_t(3)) | BUILDING, std::memory_order_acquire))
+                continue;
+            while (i--) c[i].word.store(c[i].word.load(std::memory_order_relaxed) & ~uint64_t(3), std::memory_order_release);
+            return false;
+        }
+        return true;
+    }
+    // Lists the slots of the chunks emplace_at reserved that no restore has taken since.
+    // Called with free_mutex held; returns how many.
+    size_t adopt_restored() {
+        size_t n = free_slots.size();
+        for (uint32_t c : restored_chunks)
+            for (uint32_t i = c == 0 ? 1 : static_cast<uint32_t>(c * CHUNK_SIZE); i < (c + 1) * CHUNK_SIZE; ++i) {
+                Slot* s = slot_at(i);
+                if (s && (s->word.load(std::memory_order_relaxed) & 3) == FREE) free_slots.push_back(i);
+            }
+        restored_chunks.clear();
+        restored_pending.store(false, std::memory_order_relaxed);
+        free_hint.store(free_slots.size(), std::memory_order_relaxed);
+        return free_slots.size() - n;
+    }
+    bool pop_free(uint32_t& index) {
+        if (free_hint.load(std::memory_order_relaxed) == 0) return false;
+        metrics::TimedLock lock(free_mutex, free_lock);
+        if (free_slots.empty()) return false;
+        index = free_slots.back();
+        free_slots.pop_back();
+        free_hint.store(free_slots.size(), std::memory_order_relaxed);
+        return true;
+    }
+    // Takes back a chunk index release_chunks() emptied, with generations above any
+    // handle into its old slots.
+    bool reuse_chunk(uint32_t& k) {
+        if (released_hint.load(std::memory_order_relaxed) == 0) return false;
+        metrics::TimedLock lock(free_mutex, free_lock);
+        while (!released.empty()) {
+            auto [idx, gen] = released.back();
+            released.pop_back();
+            released_hint.store(released.size(), std::memory_order_relaxed);
+            Slot* fresh = new Slot[CHUNK_SIZE];
+            for (size_t i = 0; i < CHUNK_SIZE; ++i) fresh[i].word.store(state(gen, FREE), std::memory_order_relaxed);
+            Slot* expected = nullptr;
+            if (chunks[idx].compare_exchange_strong(expected, fresh, std::memory_order_acq_rel)) {
+                chunk_count.fetch_add(1, std::memory_order_relaxed);
+                k = idx;
+                return true;
+            }
+            delete[] fresh; // an emplace_at brought it back first
+            restored_chunks.push_back(idx);
+            restored_pending.store(true, std::memory_order_relaxed);
+        }
+        return false;
+    }
+    // Next slot this thread may build in: a recycled one, else the thread's chunk.
+    Slot* acquire(uint32_t& index) {
+        while (true) {
+            while (pop_free(index)) {
+                Slot* s = slot_at(index);
+                if (s && claim(*s, 0, true)) return s; // a restore may have taken it meanwhile
+            }
+            if (!restored_pending.load(std::memory_order_relaxed)) break;
+            metrics::TimedLock lock(free_mutex, free_lock);
+            if (!adopt_restored()) break;
+        }
+        ThreadCursors& tc = cursors();
+        Cursor* cur = nullptr;
+        for (auto& c : tc.c)
+            if (c.slab == instance) cur = &c;
+        if (!cur) {
+            cur = &tc.c[tc.victim++ % CURSORS];
+            hand_back(*cur);
+            cur->slab = instance;
+        }
+        while (true) {
+            while (cur->next < cur->end) {
+                index = cur->next++;
+                Slot& s = chunks[index >> ChunkBits].load(std::memory_order_acquire)[index & CHUNK_MASK];
+                if (claim(s, 0, true)) return &s;
+            }
+            uint32_t k;
+            if (!reuse_chunk(k)) {
+                k = reserved_chunks.fetch_add(1, std::memory_order_relaxed);
+                if (k >= MAX_CHUNKS) throw std::bad_alloc();
+                chunk(k);
+            }
+            cur->next = k == 0 ? 1 : static_cast<uint32_t>(k * CHUNK_SIZE); // slot 0 reserved
+            cur->end = static_cast<uint32_t>((k + 1) * CHUNK_SIZE);
+        }
+    }
+    template <typename Init, typename... Args>
+    T* build(Slot& s, size_t handle, Init&& init, Args&&... args) {
+        T* obj = new (s.storage) T(handle, std::forward<Args>(args)...);
+        init(obj);
+        s.word.store(state(handle_generation(handle), LIVE), std::memory_order_release);
+        live_count.fetch_add(1, std::memory_order_relaxed);
+        return obj;
+    }
+
+public:
+    explicit Slab(metrics::Lock lock = metrics::Lock::SlabFreeList)
+        : instance(next_instance()), chunks(new std::atomic<Slot*>[MAX_CHUNKS]()), free_lock(lock) {
+        std::lock_guard guard(registry_mutex());
+        registry().emplace(instance, this);
+    }
+    Slab(const Slab&) = delete;
+    Slab& operator=(const Slab&) = delete;
+    ~Slab() {
+        {
+            std::lock_guard guard(registry_mutex());
+            registry().erase(instance);
+        }
+        clear();
+        for (size_t k = 0; k < MAX_CHUNKS; ++k) delete[] chunks[k].load(std::memory_order_relaxed);
+    }
+
+    // Constructs T(handle, args...) in a free slot and returns it. Lock-free unless
+    // recycled slots are waiting.
+    template <typename... Args>
+    T* emplace(Args&&... args) {
+        return emplace_init([](T*) {}, std::forward<Args>(args)...);
+    }
+    // As emplace, but runs init(obj) before the object becomes visible to readers.
+    template <typename Init, typename... Args>
+    T* emplace_init(Init&& init, Args&&... args) {
+        uint32_t index;
+        Slot* s = acquire(index);
+        uint32_t gen = static_cast<uint32_t>(s->word.load(std::memory_order_relaxed) >> 2);
+        return build(*s, make_handle(index, gen), std::forward<Init>(init), std::forward<Args>(args)...);
+    }
+
+    // Constructs T at exactly this handle (journal replay, restores). Returns nullptr if
+    // the slot is in use. Threads skip slots taken this way.
+    template <typename... Args>
+    T* emplace_at(size_t handle, Args&&... args) {
+        uint32_t index = handle_index(handle);
+        if (index == 0 || (index >> ChunkBits) >= MAX_CHUNKS || handle_generation(handle) > MAX_GENERATION) return nullptr;
+        // Keep thread reservations beyond this chunk. The slots of chunks reserved here
+        // join the free list once it runs dry, minus those restored by then.
+        uint32_t k = index >> ChunkBits, r = reserved_chunks.load(std::memory_order_relaxed);
+        while (r <= k && !reserved_chunks.compare_exchange_weak(r, k + 1, std::memory_order_relaxed)) {}
+        if (r <= k) {
+            for (uint32_t c = r; c <= k; ++c) chunk(c);
+            metrics::TimedLock lock(free_mutex, free_lock);
+            for (uint32_t c = r; c <= k; ++c) restored_chunks.push_back(c);
+            restored_pending.store(true, std::memory_order_relaxed);
+        }
+        auto guard = EpochManager::global().pin();
+        while (true) {
+            Slot* c = chunk(k);
+            Slot& s = c[index & CHUNK_MASK];
+            if (claim(s, handle_generation(handle), false)) return build(s, handle, [](T*) {}, std::forward<Args>(args)...);
+            { std::lock_guard lock(free_mutex); } // a release_chunks() in progress finishes
+            if (chunks[k].load(std::memory_order_acquire) == c) return nullptr;
+        }
+    }
+
+    // O(1) and lock-free; nullptr for unknown, erased, retired, unpublished or stale handles.
+    T* get(size_t handle) const {
+        Slot* s = slot_at(handle_index(handle));
+        if (!s || s->word.load(std::memory_order_acquire) != state(handle_generation(handle), LIVE)) return nullptr;
+        return s->object();
+    }
+
+    // Destroys the object and bumps the slot generation so old handles go stale.
+    bool erase(size_t handle) {
+        Slot* s = slot_at(handle_index(handle));
+        uint64_t live = state(handle_generation(handle), LIVE);
+        if (!s || !s->word.compare_exchange_strong(live, state(handle_generation(handle), BUILDING), std::memory_order_acquire))
+            return false;
+        s->object()->~T();
+        s->word.store(vacated(handle_generation(handle)), std::memory_order_release);
+        live_count.fetch_sub(1, std::memory_order_relaxed);
+        give_back(handle_index(handle), handle_index(handle) + 1);
+        return true;
+    }
+
+    // Unlinks the object at once (the handle goes stale; get and for_each skip it) but
+    // leaves it intact for threads that already hold it, until reclaim() sees that every
+    // thread pinned at the time has left its epoch guard.
+    bool retire(size_t handle) {
+        Slot* s = slot_at(handle_index(handle));
+        uint64_t live = state(handle_generation(handle), LIVE);
+        if (!s || !s->word.compare_exchange_strong(live, state(handle_generation(handle), RETIRED), std::memory_order_seq_cst))
+            return false;
+        live_count.fetch_sub(1, std::memory_order_relaxed);
+        uint64_t epoch = EpochManager::global().epoch();
+        metrics::TimedLock lock(free_mutex, free_lock);
+        limbo.emplace_back(epoch, handle_index(handle));
+        limbo_count.store(limbo.size(), std::memory_order_relaxed);
+        return true;
+    }
+
+    // Destroys the retired objects no pinned thread can still reach and recycles their
+    // slots (old handles stay stale). Returns how many.
+    size_t reclaim() {
+        std::vector<uint32_t> ready;
+        {
+            metrics::TimedLock lock(free_mutex, free_lock);
+            auto keep = limbo.begin();
+            for (auto& r : limbo) {
+                if (EpochManager::global().reclaimable(r.first)) ready.push_back(r.second);
+                else *keep++ = r;
+            }
+            limbo.erase(keep, limbo.end());
+            limbo_count.store(limbo.size(), std::memory_order_relaxed);
+        }
+        size_t freed = ready.size();
+        auto reusable = ready.begin();
+        for (uint32_t i : ready) {
+            Slot* s = slot_at(i); // a chunk holding a retired slot is never released
+            uint64_t w = s->word.load(std::memory_order_relaxed);
+            s->object()->~T();
+            uint64_t now = vacated(static_cast<uint32_t>(w >> 2));
+            s->word.store(now, std::memory_order_release);
+            if ((now & 3) == FREE) *reusable++ = i;
+        }
+        ready.erase(reusable, ready.end());
+        if (!ready.empty()) {
+            metrics::TimedLock lock(free_mutex, free_lock);
+            free_slots.insert(free_slots.end(), ready.begin(), ready.end());
+            free_hint.store(free_slots.size(), std::memory_order_relaxed);
+        }
+        return freed;
+    }
+
+    // Defragments: orders the free list so new objects fill the lowest holes first and
+    // the high chunks drain, then frees every chunk all of whose slots are on the free
+    // list (no live or retired object, no thread's reservation). Freed chunks go through
+    // the epoch manager and their indices are reused before new ones are reserved, so
+    // capacity stays bounded by the peak. Handles into them stay stale. Returns the
+    // number released.
+    size_t release_chunks() {
+        metrics::TimedLock lock(free_mutex, free_lock);
+        adopt_restored();
+        std::sort(free_slots.begin(), free_slots.end(), std::greater<uint32_t>());
+        free_slots.erase(std::unique(free_slots.begin(), free_slots.end()), free_slots.end());
+        size_t reserved = reserved_chunks.load(std::memory_order_acquire);
+        std::vector<uint32_t> in_chunk(reserved);
+        for (uint32_t i : free_slots)
+            if ((i >> ChunkBits) < reserved) ++in_chunk[i >> ChunkBits];
+        size_t freed = 0;
+        for (size_t k = 1; k < reserved; ++k) { // chunk 0 holds the reserved slot 0
+            Slot* c = in_chunk[k] == CHUNK_SIZE ? chunks[k].load(std::memory_order_acquire) : nullptr;
+            if (!c || !lock_chunk(c)) {
+                in_chunk[k] = 0;
+                continue;
+            }
+            uint32_t gen = 0;
+            for (size_t i = 0; i < CHUNK_SIZE; ++i) gen = std::max(gen, static_cast<uint32_t>(c[i].word.load(std::memory_order_relaxed) >> 2));
+            released.emplace_back(static_cast<uint32_t>(k), gen);
+            chunks[k].store(nullptr, std::memory_order_release);
+            chunk_count.fetch_sub(1, std::memory_order_relaxed);
+            EpochManager::global().retire(c, [](void* p) { delete[] static_cast<Slot*>(p); });
+            ++freed;
+        }
+        if (freed) {
+            std::sort(released.begin(), released.end(), std::greater<>()); // lowest reused first
+            released_hint.store(released.size(), std::memory_order_relaxed);
+            auto gone = [&](uint32_t i) { return (i >> ChunkBits) < reserved && in_chunk[i >> ChunkBits] == CHUNK_SIZE; };
+            free_slots.erase(std::remove_if(free_slots.begin(), free_slots.end(), gone), free_slots.end());
+        }
+        free_hint.store(free_slots.size(), std::memory_order_relaxed);
+        return freed;
+    }
+
+    // Visits live objects in slot order; objects published concurrently may be missed.
+    template <typename F>
+    void for_each(F&& fn) const {
+        auto guard = EpochManager::global().pin();
+        size_t n = capacity();
+        for (size_t k = 0; k * CHUNK_SIZE < n; ++k) {
+            Slot* c = chunks[k].load(std::memory_order_acquire);
+            if (!c) continue;
+            for (size_t i = 0; i < CHUNK_SIZE; ++i)
+                if ((c[i].word.load(std::memory_order_acquire) & 3) == LIVE) fn(c[i].object());
+        }
+    }
+
+    // Destroys every object and starts over from slot 1. Chunks stay allocated.
+    // Not thread-safe: no other operation may run concurrently.
+    void clear() {
+        for (size_t k = 0; k < MAX_CHUNKS; ++k) {
+            Slot* c = chunks[k].load(std::memory_order_relaxed);
+            if (!c) continue;
+            for (size_t i = 0; i < CHUNK_SIZE; ++i) {
+                if ((c[i].word.load(std::memory_order_relaxed) & 3) >= LIVE) c[i].object()->~T(); // live or retired
+                c[i].word.store(state(0, FREE), std::memory_order_relaxed);
+            }
+        }
+        std::lock_guard lock(free_mutex);
+        free_slots.clear();
+        free_hint.store(0, std::memory_order_relaxed);
+        limbo.clear();
+        limbo_count.store(0, std::memory_order_relaxed);
+        restored_chunks.clear();
+        restored_pending.store(false, std::memory_order_relaxed);
+        released.clear();
+        released_hint.store(0, std::memory_order_relaxed);
+        reserved_chunks.store(0, std::memory_order_relaxed);
+        live_count.store(0, std::memory_order_relaxed);
+    }
+
+    size_t size() const { return live_count.load(std::memory_order_relaxed); }
+    SlabUsage usage() const {
+        SlabUsage u;
+        u.live = size();
+        u.retired = limbo_count.load(std::memory_order_relaxed);
+        u.free = free_hint.load(std::memory_order_relaxed);
+        if (restored_pending.load(std::memory_order_relaxed)) {
+            std::lock_guard lock(free_mutex);
+            for (uint32_t c : restored_chunks)
+                for (uint32_t i = c == 0 ? 1 : static_cast<uint32_t>(c * CHUNK_SIZE); i < (c + 1) * CHUNK_SIZE; ++i)
+                    if (Slot* s = slot_at(i)) u.free += (s->word.load(std::memory_order_relaxed) & 3) == FREE;
+        }
+        u.chunks = chunk_count.load(std::memory_order_relaxed);
+        u.bytes = u.chunks * CHUNK_SIZE * sizeof(Slot);
+        return u;
+    }
+    // One past the highest slot index any thread has reserved; bounds dense per-slot side tables.
+    size_t capacity() const { return size_t(reserved_chunks.load(std::memory_order_acquire)) * CHUNK_SIZE; }
+};
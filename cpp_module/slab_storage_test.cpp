@@ -0,0 +1,53 @@
+// Slab Generation Test
+// A slot vacated at the last generation must never be handed out again
+// Author: 1proprogrammerchant
+// C++17+ required
+// Build: g++ -std=c++17 -O2 -pthread slab_storage_test.cpp -o slab_storage_test && ./slab_storage_test
+// Output: one line per check; exit status 1 if any failed.
+#include <cstdio>
+#include <string>
+#include "slab_storage.hpp"
+
+static int failures = 0;
+
+static void check(bool ok, const std::string& what) {
+    std::printf("%s %s\n", ok ? "PASS" : "FAIL", what.c_str());
+    failures += !ok;
+}
+
+struct Item {
+    size_t id;
+    explicit Item(size_t h) : id(h) {}
+};
+
+static constexpr uint32_t LAST = (uint32_t(1) << 31) - 1;
+
+// The slot is restored straight at the last generation instead of being cycled 2^31 times.
+static void saturated_slot(bool retire) {
+    const std::string how = retire ? "retire" : "erase";
+    Slab<Item> slab;
+    const size_t last = make_handle(5, LAST);
+    check(slab.emplace_at(make_handle(6, LAST + 1)) == nullptr, "emplace_at: generation past the last refused");
+    check(slab.emplace_at(last) != nullptr, "emplace_at: last generation accepted");
+    if (retire) {
+        check(slab.retire(last), "retire: saturated slot");
+        for (int i = 0; i < 2; ++i) EpochManager::global().collect();
+        check(slab.reclaim() == 1, "retire: object destroyed");
+    } else {
+        check(slab.erase(last), "erase: saturated slot");
+    }
+    check(slab.get(last) == nullptr, how + " saturated: old handle stale");
+    check(slab.get(make_handle(5, 0)) == nullptr, how + " saturated: wrapped handle stale");
+    check(slab.emplace_at(make_handle(5, 0)) == nullptr, how + " saturated: slot not restorable");
+    bool reused = false;
+    for (int i = 0; i < 4096; ++i) reused |= handle_index(slab.emplace()->id) == 5;
+    check(!reused, how + " saturated: slot never handed out");
+    check(slab.release_chunks() == 0, how + " saturated: chunk pinned");
+}
+
+int main() {
+    saturated_slot(false);
+    saturated_slot(true);
+    std::printf("%s\n", failures ? "FAILED" : "all checks passed");
+    return failures ? 1 : 0;
+}
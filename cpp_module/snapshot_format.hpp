@@ -0,0 +1,556 @@
+// Memory-Mapped Graph Snapshots
+// Versioned, position-independent on-disk image of a MemoryPool, read in place
+// Author: 1proprogrammerchant
+// C++17+ required (POSIX mmap; little-endian layout)
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "oesm_highperf.hpp"
+#include "reference_table.hpp"
+
+// File layout: SnapshotHeader, then 64-byte aligned sections. Every position is
+// an offset from the start of the file, so the image can be mapped anywhere.
+// Entities and references are dense tables indexed by slab slot index (empty
+// slots have id 0), so an id resolves to its record in O(1). Each object's
+// version history is kept too, oldest first, so load_snapshot() can rebuild a
+// pool whose as-of reads match the original.
+namespace snapshot {
+
+constexpr char MAGIC[8] = {'R', 'I', 'E', 'S', 'N', 'A', 'P', '\0'};
+constexpr uint32_t VERSION = 2;
+
+enum Section : uint32_t {
+    Entities,          // SnapEntity[entity slots]
+    Adjacency,         // uint64 reference ids; per entity: incoming then outgoing
+    RefIds,            // uint64[ref slots], 0 = empty slot
+    RefSources,        // uint64[ref slots]
+    RefTargets,        // uint64[ref slots]
+    RefCreationLayer,  // uint64[ref slots]
+    RefLastLayer,      // uint64[ref slots]
+    RefCandidates,     // uint32[ref slots], candidate group, 0 = none
+    RefCreatedState,   // uint8[ref slots]
+    RefStatus,         // uint8[ref slots]
+    CandidateOffsets,  // uint64[groups + 1], group g = ids[off[g-1], off[g]) (group 0 empty)
+    CandidateIds,      // uint64
+    OverflowOffsets,   // uint64[groups + 1], attribute overflow groups
+    OverflowSymbols,   // uint32
+    StringOffsets,     // uint64[symbols + 1], symbol s = bytes[off[s-1], off[s]) (symbol 0 empty)
+    StringBytes,       // char
+    AttributeBits,     // uint32[AttributeSet::FREQUENT_BITS], symbol per frequent bit
+    EntityHistoryOffsets, // uint64[entity slots + 1], slot i = versions[off[i], off[i+1])
+    EntityHistory,     // SnapVersion, value = state
+    RefHistoryOffsets, // uint64[ref slots + 1]
+    RefHistory,        // SnapVersion, value = status, candidates = group
+    SectionCount
+};
+
+struct SectionDesc {
+    uint64_t offset;
+    uint64_t count;    // elements
+    uint64_t bytes;
+    uint64_t checksum; // FNV-1a over the section bytes
+};
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t file_size;
+    uint64_t entity_count;     // live entities
+    uint64_t reference_count;  // live references
+    uint64_t committed_layer;
+    SectionDesc sections[SectionCount];
+    uint64_t header_checksum;  // FNV-1a over the header with this field zeroed
+};
+
+struct SnapEntity {
+    uint64_t id;               // 0 = empty slot
+    uint64_t layer;
+    uint64_t attr_bits[AttributeSet::WORDS];
+    uint64_t adj_offset;       // first incoming id in Adjacency
+    uint32_t in_count;
+    uint32_t out_count;        // outgoing ids follow the incoming ones
+    uint32_t name;             // symbol
+    uint32_t attr_overflow;    // OverflowOffsets group, 0 = none
+    uint8_t state;
+    uint8_t pad[7];
+};
+static_assert(sizeof(SnapEntity) == 80, "SnapEntity layout is part of the file format");
+
+struct SnapVersion {
+    uint64_t layer;
+    uint32_t candidates;       // CandidateOffsets group (references), 0 = none
+    uint8_t value;             // OntState or RefIntegrityStatus
+    uint8_t pad[3];
+};
+static_assert(sizeof(SnapVersion) == 16, "SnapVersion layout is part of the file format");
+
+inline uint64_t fnv1a(const void* data, size_t n, uint64_t h = 1469598103934665603ull) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < n; ++i) h = (h ^ p[i]) * 1099511628211ull;
+    return h;
+}
+
+inline uint64_t header_checksum(SnapshotHeader h) {
+    h.header_checksum = 0;
+    return fnv1a(&h, sizeof h);
+}
+
+// Writes the pool to path (via path.tmp + rename, so readers never see a torn file).
+// Writers should be quiescent: the image is taken without stopping mutators.
+inline bool write_snapshot(MemoryPool& pool, const std::string& path, std::string* error = nullptr) {
+    auto fail = [&](const char* msg) { if (error) *error = msg; return false; };
+    const size_t ecap = pool.entity_capacity(), rcap = pool.reference_capacity();
+    auto epoch = EpochManager::global().pin(); // history walks race the compactor
+    auto ents = pool.all_entities();
+    auto refs = pool.all_references();
+
+    std::vector<SnapEntity> erec(ecap);
+    std::vector<uint64_t> adjacency;
+    std::vector<uint64_t> group_off{0}, group_ids;
+    std::vector<uint64_t> overflow_off{0};
+    std::vector<uint32_t> overflow_syms;
+    std::map<std::vector<size_t>, uint32_t> group_of;
+    std::unordered_map<uint32_t, uint32_t> overflow_of;
+    auto group_for = [&](const CandidateSet& c) -> uint32_t {
+        if (c.empty()) return 0;
+        auto [it, fresh] = group_of.emplace(std::vector<size_t>(c.begin(), c.end()), static_cast<uint32_t>(group_off.size()));
+        if (fresh) {
+            group_ids.insert(group_ids.end(), it->first.begin(), it->first.end());
+            group_off.push_back(group_ids.size());
+        }
+        return it->second;
+    };
+    // Appends a chain oldest first; off[slot + 1] is filled in for every slot afterwards.
+    auto append_history = [](const auto& chain, std::vector<SnapVersion>& out, auto&& fill) {
+        std::vector<const std::remove_pointer_t<decltype(chain.latest())>*> newest_first;
+        for (auto* v = chain.latest(); v; v = v->prev.load(std::memory_order_acquire)) newest_first.push_back(v);
+        for (auto it = newest_first.rbegin(); it != newest_first.rend(); ++it) {
+            SnapVersion sv{};
+            sv.layer = (*it)->layer;
+            fill(sv, (*it)->value);
+            out.push_back(sv);
+        }
+    };
+    std::vector<uint64_t> ehist_off(ecap + 1), rhist_off(rcap + 1);
+    std::vector<SnapVersion> ehist, rhist;
+
+    std::vector<const Entity*> entity_at(ecap);
+    for (auto* e : ents) {
+        entity_at[handle_index(e->id)] = e;
+        SnapEntity& r = erec[handle_index(e->id)];
+        r.id = e->id;
+        r.layer = e->temporal_layer;
+        std::memcpy(r.attr_bits, e->attributes.bits, sizeof r.attr_bits);
+        r.name = e->name;
+        r.state = static_cast<uint8_t>(e->state);
+        if (e->attributes.overflow) {
+            auto [it, fresh] = overflow_of.emplace(e->attributes.overflow, static_cast<uint32_t>(overflow_off.size()));
+            if (fresh) {
+                overflow_syms.insert(overflow_syms.end(), e->attributes.overflow_begin(), e->attributes.overflow_end());
+                overflow_off.push_back(overflow_syms.size());
+            }
+            r.attr_overflow = it->second;
+        }
+        r.adj_offset = adjacency.size();
+        e->incomingReferences.for_each([&](size_t rid) { adjacency.push_back(rid); });
+        r.in_count = static_cast<uint32_t>(adjacency.size() - r.adj_offset);
+        e->outgoingReferences.for_each([&](size_t rid) { adjacency.push_back(rid); });
+        r.out_count = static_cast<uint32_t>(adjacency.size() - r.adj_offset - r.in_count);
+    }
+    for (size_t i = 0; i < ecap; ++i) {
+        if (entity_at[i])
+            append_history(entity_at[i]->history, ehist, [](SnapVersion& sv, OntState s) { sv.value = static_cast<uint8_t>(s); });
+        ehist_off[i + 1] = ehist.size();
+    }
+
+    std::vector<uint64_t> rid(rcap), rsrc(rcap), rtgt(rcap), rclayer(rcap), rllayer(rcap);
+    std::vector<uint32_t> rcand(rcap);
+    std::vector<uint8_t> rcreated(rcap), rstatus(rcap);
+    std::vector<const ReferenceObject*> ref_at(rcap);
+    for (auto* r : refs) {
+        size_t i = handle_index(r->id);
+        ref_at[i] = r;
+        rid[i] = r->id;
+        rsrc[i] = r->sourceEntityId;
+        rtgt[i] = r->targetEntityId;
+        rclayer[i] = r->creationLayer;
+        rllayer[i] = pool.validated_layer(r->id);
+        rcreated[i] = static_cast<uint8_t>(r->targetStateAtCreation);
+        rstatus[i] = static_cast<uint8_t>(r->integrityStatus);
+        rcand[i] = group_for(r->candidateTargets);
+    }
+    for (size_t i = 0; i < rcap; ++i) {
+        if (ref_at[i])
+            append_history(ref_at[i]->history, rhist, [&](SnapVersion& sv, const ReferenceVersion& v) {
+                sv.value = static_cast<uint8_t>(v.status);
+                sv.candidates = group_for(v.candidates);
+            });
+        rhist_off[i + 1] = rhist.size();
+    }
+
+    const SymbolTable& symbols = SymbolTable::global();
+    std::vector<uint64_t> str_off{0};
+    std::string str_bytes;
+    for (Symbol s = 1; s <= symbols.size(); ++s) {
+        str_bytes.append(symbols.str(s));
+        str_off.push_back(str_bytes.size());
+    }
+    std::vector<uint32_t> attr_bits(AttributeSet::FREQUENT_BITS);
+    for (uint32_t b = 0; b < attr_bits.size(); ++b) attr_bits[b] = AttributeDictionary::global().symbol_for_bit(b);
+
+    struct Blob { const void* data; uint64_t count; uint64_t elem; };
+    Blob blobs[SectionCount] = {
+        {erec.data(), erec.size(), sizeof(SnapEntity)},
+        {adjacency.data(), adjacency.size(), 8},
+        {rid.data(), rcap, 8}, {rsrc.data(), rcap, 8}, {rtgt.data(), rcap, 8},
+        {rclayer.data(), rcap, 8}, {rllayer.data(), rcap, 8},
+        {rcand.data(), rcap, 4}, {rcreated.data(), rcap, 1}, {rstatus.data(), rcap, 1},
+        {group_off.data(), group_off.size(), 8}, {group_ids.data(), group_ids.size(), 8},
+        {overflow_off.data(), overflow_off.size(), 8}, {overflow_syms.data(), overflow_syms.size(), 4},
+        {str_off.data(), str_off.size(), 8}, {str_bytes.data(), str_bytes.size(), 1},
+        {attr_bits.data(), attr_bits.size(), 4},
+        {ehist_off.data(), ehist_off.size(), 8}, {ehist.data(), ehist.size(), sizeof(SnapVersion)},
+        {rhist_off.data(), rhist_off.size(), 8}, {rhist.data(), rhist.size(), sizeof(SnapVersion)},
+    };
+
+    SnapshotHeader h{};
+    std::memcpy(h.magic, MAGIC, sizeof MAGIC);
+    h.version = VERSION;
+    h.header_size = sizeof(SnapshotHeader);
+    h.entity_count = ents.size();
+    h.reference_count = refs.size();
+    h.committed_layer = pool.committed_layer();
+    uint64_t pos = (sizeof(SnapshotHeader) + 63) & ~uint64_t(63);
+    for (uint32_t s = 0; s < SectionCount; ++s) {
+        SectionDesc& d = h.sections[s];
+        d.offset = pos;
+        d.count = blobs[s].count;
+        d.bytes = blobs[s].count * blobs[s].elem;
+        d.checksum = fnv1a(blobs[s].data, d.bytes);
+        pos = (pos + d.bytes + 63) & ~uint64_t(63);
+    }
+    h.file_size = pos;
+    h.header_checksum = header_checksum(h);
+
+    std::string tmp = path + ".tmp";
+    FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (!f) return fail("cannot open output file");
+    static const char zeros[64] = {};
+    bool ok = std::fwrite(&h, sizeof h, 1, f) == 1;
+    uint64_t written = sizeof h;
+    for (uint32_t s = 0; ok && s < SectionCount; ++s) {
+        const SectionDesc& d = h.sections[s];
+        ok = std::fwrite(zeros, 1, d.offset - written, f) == d.offset - written;
+        if (ok && d.bytes) ok = std::fwrite(blobs[s].data, 1, d.bytes, f) == d.bytes;
+        written = d.offset + d.bytes;
+    }
+    if (ok && written < h.file_size) ok = std::fwrite(zeros, 1, h.file_size - written, f) == h.file_size - written;
+    ok = (std::fflush(f) == 0) && ok && fsync(fileno(f)) == 0;
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok) { std::remove(tmp.c_str()); return fail("write failed"); }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) { std::remove(tmp.c_str()); return fail("rename failed"); }
+    return true;
+}
+
+// Read-in-place view of a snapshot. The mapping is MAP_PRIVATE and writable, so
+// mutations (set_state/set_status, revalidate_all) are copy-on-write per page
+// and never reach the file. open() checks the header and section bounds only,
+// so it is O(1); verify() does the full integrity pass.
+class SnapshotView {
+    void* base = nullptr;
+    size_t length = 0;
+
+    template <typename T>
+    T* section(Section s) const { return reinterpret_cast<T*>(static_cast<char*>(base) + header()->sections[s].offset); }
+    uint64_t count(Section s) const { return header()->sections[s].count; }
+    std::pair<const SnapVersion*, size_t> history(Section offs, Section data, size_t slot) const {
+        if (slot + 1 >= count(offs)) return {nullptr, 0};
+        const uint64_t* off = section<uint64_t>(offs);
+        return {section<SnapVersion>(data) + off[slot], off[slot + 1] - off[slot]};
+    }
+
+public:
+    SnapshotView() = default;
+    SnapshotView(const SnapshotView&) = delete;
+    SnapshotView& operator=(const SnapshotView&) = delete;
+    ~SnapshotView() { close(); }
+
+    bool open(const std::string& path, std::string* error = nullptr) {
+        auto fail = [&](const char* msg) { if (error) *error = msg; close(); return false; };
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return fail("cannot open snapshot");
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(SnapshotHeader)) { ::close(fd); return fail("file too small"); }
+        length = static_cast<size_t>(st.st_size);
+        void* p = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) { length = 0; return fail("mmap failed"); }
+        base = p;
+        const SnapshotHeader* h = header();
+        if (std::memcmp(h->magic, MAGIC, sizeof MAGIC) != 0) return fail("bad magic");
+        if (h->version != VERSION) return fail("unsupported version");
+        if (h->header_size != sizeof(SnapshotHeader) || h->file_size != length) return fail("size mismatch");
+        if (header_checksum(*h) != h->header_checksum) return fail("header checksum mismatch");
+        for (const SectionDesc& d : h->sections)
+            if (d.offset % 8 != 0 || d.offset > length || d.bytes > length - d.offset) return fail("section out of bounds");
+        return true;
+    }
+
+    void close() {
+        if (base) munmap(base, length);
+        base = nullptr;
+        length = 0;
+    }
+
+    const SnapshotHeader* header() const { return static_cast<const SnapshotHeader*>(base); }
+
+    size_t entity_slots() const { return count(Entities); }
+    size_t reference_slots() const { return count(RefIds); }
+
+    const SnapEntity* entity(size_t id) const {
+        uint32_t i = handle_index(id);
+        if (i >= entity_slots()) return nullptr;
+        const SnapEntity* e = section<SnapEntity>(Entities) + i;
+        return e->id == id && id != 0 ? e : nullptr;
+    }
+    // Record in slot i, or nullptr if the slot is empty
+    const SnapEntity* entity_at(size_t i) const {
+        if (i >= entity_slots()) return nullptr;
+        const SnapEntity* e = section<SnapEntity>(Entities) + i;
+        return e->id ? e : nullptr;
+    }
+    const uint64_t* incoming(const SnapEntity* e) const { return section<uint64_t>(Adjacency) + e->adj_offset; }
+    const uint64_t* outgoing(const SnapEntity* e) const { return incoming(e) + e->in_count; }
+
+    // Reference columns, indexed by slot; valid rows have ref_ids()[i] != 0.
+    const uint64_t* ref_ids() const { return section<uint64_t>(RefIds); }
+    const uint64_t* ref_sources() const { return section<uint64_t>(RefSources); }
+    const uint64_t* ref_targets() const { return section<uint64_t>(RefTargets); }
+    const uint64_t* ref_creation_layers() const { return section<uint64_t>(RefCreationLayer); }
+    const uint64_t* ref_last_layers() const { return section<uint64_t>(RefLastLayer); }
+    const uint32_t* ref_candidates() const { return section<uint32_t>(RefCandidates); }
+    const uint8_t* ref_created_states() const { return section<uint8_t>(RefCreatedState); }
+    const uint8_t* ref_statuses() const { return section<uint8_t>(RefStatus); }
+    // Row of a reference id, or -1
+    long reference_row(size_t id) const {
+        uint32_t i = handle_index(id);
+        return (id != 0 && i < reference_slots() && ref_ids()[i] == id) ? static_cast<long>(i) : -1;
+    }
+
+    std::pair<const uint64_t*, size_t> candidates(uint32_t group) const {
+        if (group == 0 || group >= count(CandidateOffsets)) return {nullptr, 0};
+        const uint64_t* off = section<uint64_t>(CandidateOffsets);
+        return {section<uint64_t>(CandidateIds) + off[group - 1], off[group] - off[group - 1]};
+    }
+    std::pair<const uint32_t*, size_t> attribute_overflow(uint32_t group) const {
+        if (group == 0 || group >= count(OverflowOffsets)) return {nullptr, 0};
+        const uint64_t* off = section<uint64_t>(OverflowOffsets);
+        return {section<uint32_t>(OverflowSymbols) + off[group - 1], off[group] - off[group - 1]};
+    }
+    // Version history of an entity / a reference row, oldest first.
+    std::pair<const SnapVersion*, size_t> entity_history(const SnapEntity* e) const {
+        return history(EntityHistoryOffsets, EntityHistory, static_cast<size_t>(e - section<SnapEntity>(Entities)));
+    }
+    std::pair<const SnapVersion*, size_t> reference_history(size_t row) const {
+        return history(RefHistoryOffsets, RefHistory, row);
+    }
+    std::string_view str(uint32_t sym) const {
+        if (sym == 0 || sym >= count(StringOffsets)) return {};
+        const uint64_t* off = section<uint64_t>(StringOffsets);
+        return {section<char>(StringBytes) + off[sym - 1], off[sym] - off[sym - 1]};
+    }
+    // Attribute names of an entity, decoded through the snapshot's own dictionary.
+    template <typename F>
+    void for_each_attribute(const SnapEntity* e, F&& fn) const {
+        const uint32_t* bit_sym = section<uint32_t>(AttributeBits);
+        for (size_t w = 0; w < AttributeSet::WORDS; ++w)
+            for (uint64_t m = e->attr_bits[w]; m; m &= m - 1) fn(str(bit_sym[w * 64 + __builtin_ctzll(m)]));
+        auto [syms, n] = attribute_overflow(e->attr_overflow);
+        for (size_t i = 0; i < n; ++i) fn(str(syms[i]));
+    }
+
+    // Copy-on-write mutations
+    bool set_state(size_t id, OntState s, size_t layer) {
+        SnapEntity* e = const_cast<SnapEntity*>(entity(id));
+        if (!e) return false;
+        e->state = static_cast<uint8_t>(s);
+        e->layer = layer;
+        return true;
+    }
+    bool set_status(size_t id, RefIntegrityStatus s, size_t layer) {
+        long row = reference_row(id);
+        if (row < 0) return false;
+        section<uint8_t>(RefStatus)[row] = static_cast<uint8_t>(s);
+        section<uint64_t>(RefLastLayer)[row] = layer;
+        return true;
+    }
+
+    // Recomputes every reference status from the current entity states in one sweep
+    // (the vectorized ReferenceTable kernel over the mapped columns), under policy p.
+    void revalidate_all(size_t layer, const IntegrityPolicy& p = default_policy()) {
+        const size_t n = reference_slots();
+        const SnapEntity* ents = section<SnapEntity>(Entities);
+        std::vector<uint8_t> gathered(n);
+        for (size_t i = 0; i < n; ++i) {
+            uint32_t t = handle_index(ref_targets()[i]);
+            bool live = t < entity_slots() && ents[t].id == ref_targets()[i];
+            gathered[i] = live ? ents[t].state : static_cast<uint8_t>(OntState::Collapsed);
+        }
+        uint8_t* status = section<uint8_t>(RefStatus);
+        std::vector<uint8_t> out(n);
+        refkernel::classify(gathered.data(), ref_created_states(), out.data(), n, p);
+        uint64_t* last = section<uint64_t>(RefLastLayer);
+        for (size_t i = 0; i < n; ++i) {
+            if (ref_ids()[i] == 0) continue;
+            status[i] = out[i];
+            last[i] = layer;
+        }
+    }
+
+    // Full integrity check: section checksums, then cross-references between sections.
+    bool verify(std::string* error = nullptr) const {
+        auto fail = [&](std::string msg) { if (error) *error = std::move(msg); return false; };
+        if (!base) return fail("not open");
+        static const char* names[SectionCount] = {
+            "entities", "adjacency", "ref_ids", "ref_sources", "ref_targets", "ref_creation_layer",
+            "ref_last_layer", "ref_candidates", "ref_created_state", "ref_status", "candidate_offsets",
+            "candidate_ids", "overflow_offsets", "overflow_symbols", "string_offsets", "string_bytes", "attribute_bits",
+            "entity_history_offsets", "entity_history", "ref_history_offsets", "ref_history"};
+        for (uint32_t s = 0; s < SectionCount; ++s) {
+            const SectionDesc& d = header()->sections[s];
+            if (fnv1a(static_cast<const char*>(base) + d.offset, d.bytes) != d.checksum)
+                return fail(std::string("checksum mismatch in section ") + names[s]);
+        }
+        auto monotone = [&](Section offs, Section data) {
+            const uint64_t* off = section<uint64_t>(offs);
+            if (count(offs) == 0 || off[0] != 0) return false;
+            for (size_t i = 1; i < count(offs); ++i) if (off[i] < off[i - 1]) return false;
+            return off[count(offs) - 1] == count(data);
+        };
+        if (!monotone(CandidateOffsets, CandidateIds)) return fail("bad candidate offsets");
+        if (!monotone(OverflowOffsets, OverflowSymbols)) return fail("bad overflow offsets");
+        if (!monotone(StringOffsets, StringBytes)) return fail("bad string offsets");
+        if (!monotone(EntityHistoryOffsets, EntityHistory) || count(EntityHistoryOffsets) != entity_slots() + 1)
+            return fail("bad entity history offsets");
+        if (!monotone(RefHistoryOffsets, RefHistory) || count(RefHistoryOffsets) != reference_slots() + 1)
+            return fail("bad reference history offsets");
+        const SnapVersion* ev = section<SnapVersion>(EntityHistory);
+        for (size_t k = 0; k < count(EntityHistory); ++k)
+            if (ev[k].value > static_cast<uint8_t>(OntState::Collapsed)) return fail("entity history has a bad state");
+        const SnapVersion* rv = section<SnapVersion>(RefHistory);
+        for (size_t k = 0; k < count(RefHistory); ++k)
+            if (rv[k].value > static_cast<uint8_t>(RefIntegrityStatus::ObserverRelative) || rv[k].candidates >= count(CandidateOffsets))
+                return fail("reference history has a bad status or candidate group");
+        const size_t nsym = count(StringOffsets);
+        const SnapEntity* ents = section<SnapEntity>(Entities);
+        size_t live_entities = 0, live_refs = 0;
+        for (size_t i = 0; i < entity_slots(); ++i) {
+            const SnapEntity& e = ents[i];
+            if (e.id == 0) continue;
+            ++live_entities;
+            if (handle_index(e.id) != i) return fail("entity " + std::to_string(i) + " stored in the wrong slot");
+            if (e.name >= nsym || e.state > static_cast<uint8_t>(OntState::Collapsed)) return fail("entity " + std::to_string(e.id) + " has a bad name or state");
+            if (e.attr_overflow >= count(OverflowOffsets)) return fail("entity " + std::to_string(e.id) + " has a bad overflow group");
+            if (e.adj_offset + e.in_count + e.out_count > count(Adjacency)) return fail("entity " + std::to_string(e.id) + " adjacency out of range");
+        }
+        for (size_t i = 0; i < reference_slots(); ++i) {
+            if (ref_ids()[i] == 0) continue;
+            ++live_refs;
+            if (handle_index(ref_ids()[i]) != i) return fail("reference " + std::to_string(i) + " stored in the wrong slot");
+            if (ref_statuses()[i] > static_cast<uint8_t>(RefIntegrityStatus::ObserverRelative) ||
+                ref_created_states()[i] > static_cast<uint8_t>(OntState::Collapsed))
+                return fail("reference " + std::to_string(ref_ids()[i]) + " has a bad status or state");
+            if (ref_candidates()[i] >= count(CandidateOffsets)) return fail("reference " + std::to_string(ref_ids()[i]) + " has a bad candidate group");
+        }
+        const uint32_t* bit_sym = section<uint32_t>(AttributeBits);
+        for (size_t b = 0; b < count(AttributeBits); ++b)
+            if (bit_sym[b] >= nsym) return fail("attribute bit " + std::to_string(b) + " has a bad symbol");
+        const uint32_t* osyms = section<uint32_t>(OverflowSymbols);
+        for (size_t k = 0; k < count(OverflowSymbols); ++k)
+            if (osyms[k] >= nsym) return fail("overflow symbol out of range");
+        if (live_entities != header()->entity_count || live_refs != header()->reference_count)
+            return fail("live object counts do not match the header");
+        return true;
+    }
+};
+
+// Rebuilds the snapshot in pool under the original ids, with every object's version
+// history, current fields and the committed layer. Names and attributes are
+// re-interned through the snapshot's string table. Like journal replay, nothing is
+// reported to the mutation sink. Fails if an id is taken (load into an empty pool);
+// run view.verify() first on files that are not trusted.
+inline bool load_snapshot(const SnapshotView& view, MemoryPool& pool, std::string* error = nullptr) {
+    auto fail = [&](std::string msg) { if (error) *error = std::move(msg); return false; };
+    std::unordered_map<uint32_t, Symbol> symbols;
+    auto symbol = [&](uint32_t s) -> Symbol {
+        if (s == 0) return 0;
+        auto [it, fresh] = symbols.emplace(s, 0);
+        if (fresh) it->second = SymbolTable::global().intern(view.str(s));
+        return it->second;
+    };
+    std::unordered_map<uint32_t, CandidateSet> groups;
+    auto candidates = [&](uint32_t g) -> CandidateSet {
+        if (g == 0) return {};
+        auto [it, fresh] = groups.emplace(g, CandidateSet{});
+        if (fresh) {
+            auto [ids, n] = view.candidates(g);
+            it->second = CandidateSet::of(std::vector<size_t>(ids, ids + n));
+        }
+        return it->second;
+    };
+
+    std::vector<std::string_view> attrs;
+    for (size_t i = 0; i < view.entity_slots(); ++i) {
+        const SnapEntity* e = view.entity_at(i);
+        if (!e) continue;
+        attrs.clear();
+        view.for_each_attribute(e, [&](std::string_view a) { attrs.push_back(a); });
+        auto [hist, n] = view.entity_history(e);
+        // The constructor records the oldest version; the rest are pushed as they were.
+        Entity* x = pool.restore_entity(e->id, symbol(e->name), AttributeDictionary::global().encode(attrs),
+                                        static_cast<OntState>(n ? hist[0].value : e->state), n ? hist[0].layer : e->layer);
+        if (!x) return fail("entity id " + std::to_string(e->id) + " is already in use");
+        for (size_t k = 1; k < n; ++k) x->history.push(static_cast<OntState>(hist[k].value), hist[k].layer);
+        x->state = static_cast<OntState>(e->state);
+        x->temporal_layer = e->layer;
+    }
+
+    for (size_t i = 0; i < view.reference_slots(); ++i) {
+        const uint64_t rid = view.ref_ids()[i];
+        if (rid == 0) continue;
+        ReferenceObject* r = pool.restore_reference(rid, view.ref_sources()[i], view.ref_targets()[i],
+                                                    static_cast<OntState>(view.ref_created_states()[i]),
+                                                    view.ref_creation_layers()[i]);
+        if (!r) return fail("reference id " + std::to_string(rid) + " is already in use");
+        auto [hist, n] = view.reference_history(i);
+        // The constructor recorded Valid at the creation layer. A trimmed history starts
+        // later, at a layer no other version shares, so trimming there drops exactly that.
+        const auto* born = r->history.latest();
+        bool same_start = n && hist[0].layer == born->layer && hist[0].candidates == 0 &&
+                          static_cast<RefIntegrityStatus>(hist[0].value) == born->value.status;
+        for (size_t k = same_start ? 1 : 0; k < n; ++k)
+            r->history.push({static_cast<RefIntegrityStatus>(hist[k].value), candidates(hist[k].candidates)}, hist[k].layer);
+        if (n && !same_start) r->history.trim(hist[0].layer);
+        r->integrityStatus = static_cast<RefIntegrityStatus>(view.ref_statuses()[i]);
+        r->candidateTargets = candidates(view.ref_candidates()[i]);
+        r->lastValidatedLayer = view.ref_last_layers()[i];
+        pool.sync_status(*r);
+    }
+    pool.commit_layer(view.header()->committed_layer);
+    return true;
+}
+
+} // namespace snapshot
@@ -0,0 +1,143 @@
+// RIE Snapshot Tool
+// Writes snapshots from a live pool, checks them, and serves reads from the mapping
+// Author: 1proprogrammerchant
+// C++17+ required
+// Build: g++ -std=c++17 -O2 -pthread snapshot_tool.cpp -o snapshot_tool
+// Usage:
+//   snapshot_tool write <file> [entities references]   demo story, or a synthetic graph
+//   snapshot_tool check <file>                          full integrity check
+//   snapshot_tool info <file>                           counts; prints the first entities
+//   snapshot_tool revalidate <file> <layer> [policy]    COW sweep over the mapped columns
+//   snapshot_tool load <file> [snapshot_out]             rebuild a pool with ids and histories
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include "oesm_highperf.hpp"
+#include "snapshot_format.hpp"
+
+static void build_demo(MemoryPool& pool, ReferentialIntegrityEngine& rie) {
+    Entity* E1 = pool.create_entity("the man", {"male", "human"}, OntState::Defined, 0);
+    Entity* E2 = pool.create_entity("the voice", {"voice"}, OntState::Defined, 1);
+    pool.create_reference(E2->id, E1->id, E1->state, 1);
+    Entity* E1a = pool.create_entity("the man (aspect A)", {"male", "human", "aspectA"}, OntState::Split, 2);
+    Entity* E1b = pool.create_entity("the man (aspect B)", {"male", "human", "aspectB"}, OntState::Split, 2);
+    rie.apply_state_change({E1->id, OntState::Split, 2, {E1a->id, E1b->id}});
+    pool.commit_layer(2);
+}
+
+static void build_synthetic(MemoryPool& pool, size_t nents, size_t nrefs) {
+    static const char* vocab[] = {"male", "female", "human", "voice", "object", "place", "abstract", "plural"};
+    std::mt19937_64 rng(1);
+    std::vector<size_t> ids;
+    ids.reserve(nents);
+    size_t top = 0;
+    for (size_t i = 0; i < nents; ++i) {
+        std::vector<std::string> attrs{vocab[rng() % 8], vocab[rng() % 8]};
+        size_t layer = rng() % 4;
+        ids.push_back(pool.create_entity("entity" + std::to_string(i), attrs, OntState::Defined, layer)->id);
+        top = std::max(top, layer);
+    }
+    for (size_t i = 0; i < nrefs && nents; ++i) {
+        size_t src = ids[rng() % nents], tgt = ids[rng() % nents], layer = rng() % 4;
+        pool.create_reference(src, tgt, OntState::Defined, layer);
+        top = std::max(top, layer);
+    }
+    pool.commit_layer(top);
+}
+
+static double ms_since(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::fprintf(stderr, "usage: %s write|check|info|revalidate|load <file> [...]\n", argv[0]);
+        return 2;
+    }
+    std::string cmd = argv[1], path = argv[2];
+    std::string err;
+    if (cmd == "write") {
+        MemoryPool pool;
+        ReferentialIntegrityEngine rie(pool);
+        if (argc >= 5) build_synthetic(pool, std::strtoull(argv[3], nullptr, 10), std::strtoull(argv[4], nullptr, 10));
+        else build_demo(pool, rie);
+        auto t0 = std::chrono::steady_clock::now();
+        if (!snapshot::write_snapshot(pool, path, &err)) { std::fprintf(stderr, "write: %s\n", err.c_str()); return 1; }
+        std::printf("wrote %s in %.1f ms\n", path.c_str(), ms_since(t0));
+        return 0;
+    }
+    snapshot::SnapshotView view;
+    auto t0 = std::chrono::steady_clock::now();
+    if (!view.open(path, &err)) { std::fprintf(stderr, "open: %s\n", err.c_str()); return 1; }
+    double open_ms = ms_since(t0);
+    const snapshot::SnapshotHeader* h = view.header();
+    if (cmd == "check") {
+        t0 = std::chrono::steady_clock::now();
+        if (!view.verify(&err)) { std::fprintf(stderr, "check: %s\n", err.c_str()); return 1; }
+        std::printf("ok: version %u, %llu entities, %llu references (open %.3f ms, verify %.1f ms)\n", h->version,
+                    (unsigned long long)h->entity_count, (unsigned long long)h->reference_count, open_ms, ms_since(t0));
+    } else if (cmd == "info") {
+        std::printf("version %u | %llu bytes | %llu entities | %llu references | open %.3f ms\n", h->version,
+                    (unsigned long long)h->file_size, (unsigned long long)h->entity_count,
+                    (unsigned long long)h->reference_count, open_ms);
+        size_t shown = 0;
+        for (size_t i = 1; i < view.entity_slots() && shown < 8; ++i) {
+            const snapshot::SnapEntity* e = view.entity(i);
+            if (!e) continue;
+            ++shown;
+            std::printf("Entity[%llu]: %.*s | State: %u | Layer: %llu | Attr: ", (unsigned long long)e->id,
+                        (int)view.str(e->name).size(), view.str(e->name).data(), e->state, (unsigned long long)e->layer);
+            view.for_each_attribute(e, [](std::string_view a) { std::printf("%.*s ", (int)a.size(), a.data()); });
+            std::printf("| in %u out %u\n", e->in_count, e->out_count);
+        }
+        for (size_t i = 0, shownr = 0; i < view.reference_slots() && shownr < 8; ++i) {
+            if (!view.ref_ids()[i]) continue;
+            ++shownr;
+            std::printf("Reference[%llu]: %llu -> %llu | Status: %u", (unsigned long long)view.ref_ids()[i],
+                        (unsigned long long)view.ref_sources()[i], (unsigned long long)view.ref_targets()[i], view.ref_statuses()[i]);
+            auto [c, n] = view.candidates(view.ref_candidates()[i]);
+            if (n) {
+                std::printf(" | Candidates: ");
+                for (size_t k = 0; k < n; ++k) std::printf("%llu ", (unsigned long long)c[k]);
+            }
+            std::printf("\n");
+        }
+    } else if (cmd == "revalidate" && argc >= 4) {
+        const IntegrityPolicy* p = argc >= 5 ? policy::by_name(argv[4]) : &default_policy();
+        if (!p) { std::fprintf(stderr, "unknown policy %s\n", argv[4]); return 2; }
+        t0 = std::chrono::steady_clock::now();
+        view.revalidate_all(std::strtoull(argv[3], nullptr, 10), *p);
+        size_t counts[8] = {};
+        for (size_t i = 0; i < view.reference_slots(); ++i)
+            if (view.ref_ids()[i]) ++counts[view.ref_statuses()[i] & 7];
+        std::printf("revalidated %llu references in %.1f ms (file unchanged):", (unsigned long long)h->reference_count, ms_since(t0));
+        for (int s = 0; s < 7; ++s) std::printf(" %d=%zu", s, counts[s]);
+        std::printf("\n");
+    } else if (cmd == "load") {
+        MemoryPool pool;
+        t0 = std::chrono::steady_clock::now();
+        if (!snapshot::load_snapshot(view, pool, &err)) { std::fprintf(stderr, "load: %s\n", err.c_str()); return 1; }
+        double load_ms = ms_since(t0);
+        auto ents = pool.all_entities();
+        auto refs = pool.all_references();
+        size_t versions = 0;
+        for (auto* e : ents) versions += e->history.length();
+        for (auto* r : refs) versions += r->history.length();
+        std::printf("loaded %zu entities, %zu references, %zu versions, committed layer %zu in %.1f ms\n",
+                    ents.size(), refs.size(), versions, pool.committed_layer(), load_ms);
+        if (ents.size() <= 8) {
+            for (auto* e : ents) e->print();
+            for (auto* r : refs) r->print();
+        }
+        if (argc >= 4 && !snapshot::write_snapshot(pool, argv[3], &err)) {
+            std::fprintf(stderr, "snapshot: %s\n", err.c_str());
+            return 1;
+        }
+    } else {
+        std::fprintf(stderr, "unknown command %s\n", cmd.c_str());
+        return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,266 @@
+// Split Resolver
+// Ranks the candidate targets of Unresolved split references by attribute similarity
+// Author: 1proprogrammerchant
+// C++17+ required
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "oesm_highperf.hpp"
+#include "reference_table.hpp"
+
+namespace simkernel {
+
+// The inline part of an AttributeSet, gathered into contiguous rows
+struct Bits {
+    uint64_t w[AttributeSet::WORDS];
+};
+
+// inter[i] = |a[i] & b[i]|, uni[i] = |a[i] | b[i]|
+inline void overlap_scalar(const Bits* a, const Bits* b, uint32_t* inter, uint32_t* uni, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t x = 0, y = 0;
+        for (size_t w = 0; w < AttributeSet::WORDS; ++w) {
+            x += static_cast<uint32_t>(__builtin_popcountll(a[i].w[w] & b[i].w[w]));
+            y += static_cast<uint32_t>(__builtin_popcountll(a[i].w[w] | b[i].w[w]));
+        }
+        inter[i] = x;
+        uni[i] = y;
+    }
+}
+
+#ifdef RIE_X86
+// Per-byte popcounts through a nibble lookup
+__attribute__((target("avx2")))
+inline __m256i popcount_bytes(__m256i v) {
+    const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                         0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low = _mm256_set1_epi8(0x0f);
+    return _mm256_add_epi8(_mm256_shuffle_epi8(lut, _mm256_and_si256(v, low)),
+                           _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(v, 4), low)));
+}
+// {sum of v0's lanes, ..., sum of v3's lanes}
+__attribute__((target("avx2")))
+inline __m256i lane_sums(__m256i v0, __m256i v1, __m256i v2, __m256i v3) {
+    __m256i s01 = _mm256_add_epi64(_mm256_unpacklo_epi64(v0, v1), _mm256_unpackhi_epi64(v0, v1));
+    __m256i s23 = _mm256_add_epi64(_mm256_unpacklo_epi64(v2, v3), _mm256_unpackhi_epi64(v2, v3));
+    return _mm256_add_epi64(_mm256_permute2x128_si256(s01, s23, 0x20), _mm256_permute2x128_si256(s01, s23, 0x31));
+}
+
+// One 256-bit AND/OR per pair, four pairs per step; compiled for AVX2 regardless of
+// -march, picked at runtime
+__attribute__((target("avx2")))
+inline void overlap_avx2(const Bits* a, const Bits* b, uint32_t* inter, uint32_t* uni, size_t n) {
+    static_assert(sizeof(Bits) == 32, "one AttributeSet bitset per AVX2 register");
+    const __m256i zero = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i x[4], y[4];
+        for (size_t k = 0; k < 4; ++k) {
+            __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i + k));
+            __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i + k));
+            x[k] = _mm256_sad_epu8(popcount_bytes(_mm256_and_si256(va, vb)), zero);
+            y[k] = _mm256_sad_epu8(popcount_bytes(_mm256_or_si256(va, vb)), zero);
+        }
+        alignas(32) uint64_t xs[4], ys[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(xs), lane_sums(x[0], x[1], x[2], x[3]));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(ys), lane_sums(y[0], y[1], y[2], y[3]));
+        for (size_t k = 0; k < 4; ++k) {
+            inter[i + k] = static_cast<uint32_t>(xs[k]);
+            uni[i + k] = static_cast<uint32_t>(ys[k]);
+        }
+    }
+    overlap_scalar(a + i, b + i, inter + i, uni + i, n - i);
+}
+#endif
+
+inline void overlap(const Bits* a, const Bits* b, uint32_t* inter, uint32_t* uni, size_t n) {
+#ifdef RIE_X86
+    if (refkernel::has_avx2()) return overlap_avx2(a, b, inter, uni, n);
+#endif
+    overlap_scalar(a, b, inter, uni, n);
+}
+
+// Attributes in both overflow groups (sorted symbol arrays)
+inline uint32_t overflow_common(const AttributeSet& a, const AttributeSet& b) {
+    if (!a.overflow || !b.overflow) return 0;
+    if (a.overflow == b.overflow) return static_cast<uint32_t>(AttributeSet::OverflowGroups::global().size(a.overflow));
+    const Symbol *x = a.overflow_begin(), *xe = a.overflow_end(), *y = b.overflow_begin(), *ye = b.overflow_end();
+    uint32_t n = 0;
+    while (x != xe && y != ye) {
+        if (*x < *y) ++x;
+        else if (*y < *x) ++y;
+        else ++n, ++x, ++y;
+    }
+    return n;
+}
+
+// Adds the overflow attributes to counts taken over the inline bits
+inline void add_overflow(const AttributeSet& a, const AttributeSet& b, uint32_t& inter, uint32_t& uni) {
+    if (!a.overflow && !b.overflow) return;
+    uint32_t common = overflow_common(a, b);
+    inter += common;
+    uni += static_cast<uint32_t>(AttributeSet::OverflowGroups::global().size(a.overflow) +
+                                 AttributeSet::OverflowGroups::global().size(b.overflow)) - common;
+}
+
+// Jaccard similarity of two attribute sets (one pair; the batch path uses overlap())
+inline float jaccard(const AttributeSet& a, const AttributeSet& b) {
+    Bits x, y;
+    std::copy(a.bits, a.bits + AttributeSet::WORDS, x.w);
+    std::copy(b.bits, b.bits + AttributeSet::WORDS, y.w);
+    uint32_t inter, uni;
+    overlap_scalar(&x, &y, &inter, &uni, 1);
+    add_overflow(a, b, inter, uni);
+    return uni ? float(inter) / float(uni) : 0.0f;
+}
+
+} // namespace simkernel
+
+struct ResolverOptions {
+    float min_score = 0.25f;      // auto-resolve: the best candidate's Jaccard similarity...
+    float min_confidence = 0.6f;  // ...and its share of all candidates' scores
+    bool auto_resolve = true;
+    size_t grain = 1024;          // references per parallel task
+};
+
+struct RankedCandidate {
+    size_t entity;
+    float score; // Jaccard similarity of the source's and the candidate's attributes
+};
+
+struct RankedReference {
+    size_t reference, source;
+    size_t first;           // candidates[first, first + count), best first
+    uint32_t count;
+    float confidence;       // best score / sum of scores (0 when nothing overlaps)
+    bool resolved;          // narrowed to candidates[first] by this run
+};
+
+struct ResolveReport {
+    std::vector<RankedReference> references;
+    std::vector<RankedCandidate> candidates;
+    size_t resolved = 0;
+
+    const RankedCandidate* best(const RankedReference& r) const { return r.count ? &candidates[r.first] : nullptr; }
+};
+
+// Scores every candidate of an Unresolved reference against the referencing context: the
+// Jaccard similarity between the source entity's attributes and the candidate's. References
+// are ranked in parallel; pairs are gathered into rows and scored by the bitset kernels,
+// overflow attributes are merged in afterwards.
+//
+// A confident ranking resolves the reference: its status becomes IdentitySplit (the split
+// target is known) and its candidates narrow to the winner, recorded as a new version at
+// the given layer and reported to the mutation sink. The target itself is kept, so
+// snapshots and journal replay see the resolution like any other status change.
+// It writes the same reference fields the engine does, so it runs under the engine's
+// status lock. Like the engine it does not commit the layer; the caller does.
+class SplitResolver {
+    ReferentialIntegrityEngine& rie;
+    MemoryPool& pool;
+    WorkStealingPool* workers;
+    ResolverOptions opts;
+
+    // Per-task gather rows
+    struct Scratch {
+        std::vector<const Entity*> targets;
+        std::vector<simkernel::Bits> a, b;
+        std::vector<uint32_t> inter, uni;
+    };
+
+    void rank(const ReferenceObject* ref, RankedReference& out, RankedCandidate* cands, Scratch& s) const {
+        const Entity* src = pool.get_entity(ref->sourceEntityId);
+        const size_t n = out.count;
+        s.targets.resize(n);
+        s.a.assign(n, simkernel::Bits{});
+        s.b.assign(n, simkernel::Bits{});
+        s.inter.resize(n);
+        s.uni.resize(n);
+        size_t k = 0;
+        for (size_t c : ref->candidateTargets) {
+            const Entity* e = src ? pool.get_entity(c) : nullptr;
+            if (e) {
+                std::copy(src->attributes.bits, src->attributes.bits + AttributeSet::WORDS, s.a[k].w);
+                std::copy(e->attributes.bits, e->attributes.bits + AttributeSet::WORDS, s.b[k].w);
+            }
+            s.targets[k] = e;
+            cands[k++] = {c, 0.0f};
+        }
+        simkernel::overlap(s.a.data(), s.b.data(), s.inter.data(), s.uni.data(), n);
+        float sum = 0;
+        for (size_t i = 0; i < n; ++i) {
+            const Entity* e = s.targets[i];
+            if (!e) continue; // gone: scores 0
+            uint32_t inter = s.inter[i], uni = s.uni[i];
+            simkernel::add_overflow(src->attributes, e->attributes, inter, uni);
+            cands[i].score = uni ? float(inter) / float(uni) : 0.0f;
+            sum += cands[i].score;
+        }
+        std::stable_sort(cands, cands + n, [](const RankedCandidate& x, const RankedCandidate& y) { return x.score > y.score; });
+        out.confidence = sum > 0 ? cands[0].score / sum : 0.0f;
+    }
+
+public:
+    // Without a worker pool, ranking runs on the calling thread.
+    explicit SplitResolver(ReferentialIntegrityEngine& e, WorkStealingPool* w = nullptr, ResolverOptions o = {})
+        : rie(e), pool(e.memory_pool()), workers(w), opts(o) {}
+
+    // Every Unresolved reference with candidates
+    ResolveReport run(size_t layer) {
+        metrics::TimedLock guard(rie.status_mutex(), metrics::Lock::Propagation);
+        auto epoch = EpochManager::global().pin();
+        std::vector<ReferenceObject*> refs;
+        for (ReferenceObject* r : pool.all_references())
+            if (r->integrityStatus == RefIntegrityStatus::Unresolved && !r->candidateTargets.empty()) refs.push_back(r);
+        return rank_all(refs, layer);
+    }
+    // The given references; those not Unresolved or without candidates are skipped.
+    ResolveReport run(const std::vector<size_t>& rids, size_t layer) {
+        metrics::TimedLock guard(rie.status_mutex(), metrics::Lock::Propagation);
+        auto epoch = EpochManager::global().pin();
+        std::vector<ReferenceObject*> refs;
+        for (size_t rid : rids)
+            if (ReferenceObject* r = pool.get_reference(rid))
+                if (r->integrityStatus == RefIntegrityStatus::Unresolved && !r->candidateTargets.empty()) refs.push_back(r);
+        return rank_all(refs, layer);
+    }
+
+private:
+    // Caller holds the status lock
+    ResolveReport rank_all(const std::vector<ReferenceObject*>& refs, size_t layer) {
+        ResolveReport report;
+        report.references.resize(refs.size());
+        size_t total = 0;
+        for (size_t i = 0; i < refs.size(); ++i) {
+            uint32_t n = static_cast<uint32_t>(refs[i]->candidateTargets.size());
+            report.references[i] = {refs[i]->id, refs[i]->sourceEntityId, total, n, 0.0f, false};
+            total += n;
+        }
+        report.candidates.resize(total);
+        std::atomic<size_t> resolved{0};
+        parallel_for(workers, refs.size(), opts.grain, [&](size_t b, size_t e) {
+            Scratch scratch;
+            size_t local = 0;
+            for (size_t i = b; i < e; ++i) {
+                RankedReference& r = report.references[i];
+                RankedCandidate* cands = report.candidates.data() + r.first;
+                rank(refs[i], r, cands, scratch);
+                if (!opts.auto_resolve || cands[0].score < opts.min_score || r.confidence < opts.min_confidence) continue;
+                ReferenceObject* ref = refs[i];
+                ref->integrityStatus = RefIntegrityStatus::IdentitySplit;
+                ref->candidateTargets = CandidateSet::of(&cands[0].entity, 1);
+                ref->lastValidatedLayer = layer;
+                pool.sync_status(*ref);
+                if (ref->record_version())
+                    if (MutationSink* m = pool.mutation_sink()) m->reference_status_changed(*ref);
+                r.resolved = true;
+                ++local;
+            }
+            resolved.fetch_add(local, std::memory_order_relaxed);
+        });
+        report.resolved = resolved.load(std::memory_order_relaxed);
+        return report;
+    }
+};
@@ -0,0 +1,274 @@
+// Interned Strings and Attribute Dictionary
+// Entity names and attributes as compact symbol ids and bitsets
+// Author: 1proprogrammerchant
+// C++17+ required
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "candidate_groups.hpp"
+
+using Symbol = uint32_t; // 0 = empty string
+
+// Global, thread-safe string interner. Strings are copied once into append-only
+// blocks and never move, so str() is a lock-free table read.
+class SymbolTable {
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+    static constexpr size_t CHUNK_BITS = 12;
+    static constexpr size_t CHUNK_SIZE = size_t(1) << CHUNK_BITS;
+    static constexpr size_t MAX_CHUNKS = size_t(1) << 14;
+    static constexpr size_t CAPACITY = MAX_CHUNKS * CHUNK_SIZE; // symbols, 0 included
+
+    std::atomic<std::atomic<const char*>*> chunks[MAX_CHUNKS] = {};
+    std::vector<std::unique_ptr<char[]>> blocks, large;
+    size_t block_used = BLOCK_SIZE;
+    std::unordered_map<std::string_view, Symbol> index;
+    mutable std::shared_mutex mutex;
+    Symbol next_symbol = 1;
+
+    // Layout per string: uint32 length, bytes, NUL
+    const char* store(std::string_view s) {
+        size_t need = sizeof(uint32_t) + s.size() + 1;
+        if (need > BLOCK_SIZE / 4) {
+            large.emplace_back(new char[need]);
+            write(large.back().get(), s);
+            return large.back().get();
+        }
+        if (block_used + need > BLOCK_SIZE) {
+            blocks.emplace_back(new char[BLOCK_SIZE]);
+            block_used = 0;
+        }
+        char* p = blocks.back().get() + block_used;
+        block_used += (need + 3) & ~size_t(3);
+        write(p, s);
+        return p;
+    }
+    static void write(char* p, std::string_view s) {
+        uint32_t len = static_cast<uint32_t>(s.size());
+        std::memcpy(p, &len, sizeof len);
+        std::memcpy(p + sizeof len, s.data(), s.size());
+        p[sizeof len + s.size()] = '\0';
+    }
+    const char* record(Symbol sym) const {
+        const auto* chunk = chunks[sym >> CHUNK_BITS].load(std::memory_order_acquire);
+        return chunk ? chunk[sym & (CHUNK_SIZE - 1)].load(std::memory_order_acquire) : nullptr;
+    }
+
+public:
+    static SymbolTable& global() {
+        static SymbolTable instance;
+        return instance;
+    }
+    SymbolTable() = default;
+    SymbolTable(const SymbolTable&) = delete;
+    SymbolTable& operator=(const SymbolTable&) = delete;
+    ~SymbolTable() { for (auto& c : chunks) delete[] c.load(); }
+
+    // Symbol for s, adding it if new (0 for the empty string). false if all
+    // MAX_CHUNKS * CHUNK_SIZE symbols are taken; sym is then 0.
+    bool try_intern(std::string_view s, Symbol& sym) {
+        sym = 0;
+        if (s.empty()) return true;
+        {
+            std::shared_lock lock(mutex);
+            auto it = index.find(s);
+            if (it != index.end()) { sym = it->second; return true; }
+        }
+        std::unique_lock lock(mutex);
+        auto it = index.find(s);
+        if (it != index.end()) { sym = it->second; return true; }
+        if (next_symbol >= CAPACITY) return false;
+        sym = next_symbol++;
+        const char* rec = store(s);
+        auto* chunk = chunks[sym >> CHUNK_BITS].load(std::memory_order_relaxed);
+        if (!chunk) {
+            chunk = new std::atomic<const char*>[CHUNK_SIZE];
+            for (size_t i = 0; i < CHUNK_SIZE; ++i) chunk[i].store(nullptr, std::memory_order_relaxed);
+            chunks[sym >> CHUNK_BITS].store(chunk, std::memory_order_release);
+        }
+        chunk[sym & (CHUNK_SIZE - 1)].store(rec, std::memory_order_release);
+        index.emplace(std::string_view(rec + sizeof(uint32_t), s.size()), sym);
+        return true;
+    }
+    // As try_intern; a full table throws std::bad_alloc, like a full slab.
+    Symbol intern(std::string_view s) {
+        Symbol sym;
+        if (!try_intern(s, sym)) throw std::bad_alloc();
+        return sym;
+    }
+
+    // Existing symbol for s, or 0 if it was never interned.
+    Symbol find(std::string_view s) const {
+        std::shared_lock lock(mutex);
+        auto it = index.find(s);
+        return it == index.end() ? 0 : it->second;
+    }
+
+    std::string_view str(Symbol sym) const {
+        const char* rec = sym ? record(sym) : nullptr;
+        if (!rec) return {};
+        uint32_t len;
+        std::memcpy(&len, rec, sizeof len);
+        return {rec + sizeof len, len};
+    }
+
+    size_t size() const {
+        std::shared_lock lock(mutex);
+        return next_symbol - 1;
+    }
+};
+
+class AttributeDictionary;
+struct AttributeQuery;
+
+// Attribute set: the first FREQUENT_BITS distinct attributes seen get a bit in an
+// inline bitset; the rest live in an interned, sorted overflow group.
+struct AttributeSet {
+    static constexpr size_t WORDS = 4;
+    static constexpr size_t FREQUENT_BITS = WORDS * 64;
+    uint64_t bits[WORDS] = {};
+    uint32_t overflow = 0; // GroupInterner<Symbol> id, 0 = none
+
+    using OverflowGroups = GroupInterner<Symbol>;
+
+    bool empty() const { return !(bits[0] | bits[1] | bits[2] | bits[3]) && overflow == 0; }
+    bool test(uint32_t bit) const { return (bits[bit >> 6] >> (bit & 63)) & 1; }
+    void set(uint32_t bit) { bits[bit >> 6] |= uint64_t(1) << (bit & 63); }
+
+    const Symbol* overflow_begin() const { return OverflowGroups::global().data(overflow); }
+    const Symbol* overflow_end() const { return overflow_begin() + OverflowGroups::global().size(overflow); }
+
+    // True when every attribute of q is present here.
+    bool contains_all(const AttributeSet& q) const {
+        for (size_t w = 0; w < WORDS; ++w)
+            if ((bits[w] & q.bits[w]) != q.bits[w]) return false;
+        if (q.overflow == 0 || q.overflow == overflow) return true;
+        const Symbol *a = overflow_begin(), *ae = overflow_end();
+        for (const Symbol* b = q.overflow_begin(); b != q.overflow_end(); ++b) {
+            while (a != ae && *a < *b) ++a;
+            if (a == ae || *a != *b) return false;
+        }
+        return true;
+    }
+    bool contains_all(const AttributeQuery& q) const;
+
+    size_t count() const {
+        size_t n = OverflowGroups::global().size(overflow);
+        for (size_t w = 0; w < WORDS; ++w) n += static_cast<size_t>(__builtin_popcountll(bits[w]));
+        return n;
+    }
+
+    template <typename F>
+    void for_each(const AttributeDictionary& dict, F&& fn) const;
+};
+
+// What AttributeDictionary::lookup returns: the frequent bits plus the sorted
+// overflow symbols themselves, so a query never interns a group.
+struct AttributeQuery {
+    AttributeSet set; // overflow stays 0
+    std::vector<Symbol> overflow;
+};
+
+inline bool AttributeSet::contains_all(const AttributeQuery& q) const {
+    if (!contains_all(q.set)) return false;
+    const Symbol *a = overflow_begin(), *ae = overflow_end();
+    for (Symbol b : q.overflow) {
+        while (a != ae && *a < b) ++a;
+        if (a == ae || *a != b) return false;
+    }
+    return true;
+}
+
+// Global attribute vocabulary: symbol <-> frequent-bit assignment.
+class AttributeDictionary {
+    std::unordered_map<Symbol, uint16_t> bit_of;
+    std::vector<Symbol> symbol_of_bit;
+    mutable std::shared_mutex mutex;
+
+    // Bit for sym, assigning one while bits remain; -1 when it must overflow.
+    int assign_bit(Symbol sym) {
+        {
+            std::shared_lock lock(mutex);
+            auto it = bit_of.find(sym);
+            if (it != bit_of.end()) return it->second;
+            if (symbol_of_bit.size() >= AttributeSet::FREQUENT_BITS) return -1;
+        }
+        std::unique_lock lock(mutex);
+        auto it = bit_of.find(sym);
+        if (it != bit_of.end()) return it->second;
+        if (symbol_of_bit.size() >= AttributeSet::FREQUENT_BITS) return -1;
+        uint16_t bit = static_cast<uint16_t>(symbol_of_bit.size());
+        symbol_of_bit.push_back(sym);
+        bit_of.emplace(sym, bit);
+        return bit;
+    }
+
+public:
+    static AttributeDictionary& global() {
+        static AttributeDictionary instance;
+        return instance;
+    }
+
+    // Interns the attributes into a set (used when creating entities).
+    template <typename Range>
+    AttributeSet encode(const Range& attrs) {
+        AttributeSet set;
+        std::vector<Symbol> overflow;
+        for (const auto& a : attrs) {
+            Symbol sym = SymbolTable::global().intern(a);
+            if (!sym) continue;
+            int bit = assign_bit(sym);
+            if (bit >= 0) set.set(static_cast<uint32_t>(bit));
+            else overflow.push_back(sym);
+        }
+        if (!overflow.empty()) set.overflow = AttributeSet::OverflowGroups::global().intern(overflow.data(), overflow.size());
+        return set;
+    }
+    AttributeSet encode(std::initializer_list<std::string_view> attrs) {
+        return encode<std::initializer_list<std::string_view>>(attrs);
+    }
+
+    // Query form: no strings or overflow groups are interned. ok is false if an
+    // attribute was never seen, in which case no entity can match.
+    template <typename Range>
+    AttributeQuery lookup(const Range& attrs, bool& ok) const {
+        AttributeQuery q;
+        ok = true;
+        std::shared_lock lock(mutex);
+        for (const auto& a : attrs) {
+            Symbol sym = SymbolTable::global().find(a);
+            auto it = sym ? bit_of.find(sym) : bit_of.end();
+            if (!sym) { ok = false; continue; }
+            if (it != bit_of.end()) q.set.set(it->second);
+            else q.overflow.push_back(sym);
+        }
+        lock.unlock();
+        std::sort(q.overflow.begin(), q.overflow.end());
+        q.overflow.erase(std::unique(q.overflow.begin(), q.overflow.end()), q.overflow.end());
+        return q;
+    }
+
+    Symbol symbol_for_bit(uint32_t bit) const {
+        std::shared_lock lock(mutex);
+        return bit < symbol_of_bit.size() ? symbol_of_bit[bit] : 0;
+    }
+};
+
+template <typename F>
+void AttributeSet::for_each(const AttributeDictionary& dict, F&& fn) const {
+    for (size_t w = 0; w < WORDS; ++w)
+        for (uint64_t m = bits[w]; m; m &= m - 1)
+            fn(SymbolTable::global().str(dict.symbol_for_bit(static_cast<uint32_t>(w * 64 + __builtin_ctzll(m)))));
+    for (const Symbol* s = overflow_begin(); s != overflow_end(); ++s) fn(SymbolTable::global().str(*s));
+}
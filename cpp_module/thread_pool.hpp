@@ -0,0 +1,131 @@
+// Work-Stealing Thread Pool
+// Per-worker task deques: owners pop LIFO, idle workers steal FIFO
+// Author: 1proprogrammerchant
+// C++17+ required
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkStealingPool {
+    struct Worker {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+    std::atomic<size_t> pending{0};
+    std::atomic<size_t> next_queue{0};
+    std::atomic<bool> stopping{false};
+    std::mutex sleep_mutex;
+    std::condition_variable sleep_cv;
+
+    static inline thread_local int current_worker = -1;
+    static inline thread_local const WorkStealingPool* current_pool = nullptr;
+
+    bool pop_local(size_t self, std::function<void()>& task) {
+        Worker& w = *workers[self];
+        std::lock_guard lock(w.mutex);
+        if (w.tasks.empty()) return false;
+        task = std::move(w.tasks.back());
+        w.tasks.pop_back();
+        return true;
+    }
+    bool steal(size_t self, std::function<void()>& task) {
+        for (size_t i = 1; i <= workers.size(); ++i) {
+            Worker& w = *workers[(self + i) % workers.size()];
+            std::lock_guard lock(w.mutex);
+            if (w.tasks.empty()) continue;
+            task = std::move(w.tasks.front());
+            w.tasks.pop_front();
+            return true;
+        }
+        return false;
+    }
+    bool run_one(size_t self) {
+        std::function<void()> task;
+        if (!pop_local(self, task) && !steal(self, task)) return false;
+        pending.fetch_sub(1, std::memory_order_relaxed);
+        task();
+        return true;
+    }
+    void worker_loop(size_t self) {
+        current_worker = static_cast<int>(self);
+        current_pool = this;
+        while (!stopping.load(std::memory_order_acquire)) {
+            if (run_one(self)) continue;
+            std::unique_lock lock(sleep_mutex);
+            sleep_cv.wait(lock, [&] { return stopping.load() || pending.load() > 0; });
+        }
+    }
+
+public:
+    explicit WorkStealingPool(size_t n = std::max(1u, std::thread::hardware_concurrency())) {
+        for (size_t i = 0; i < n; ++i) workers.emplace_back(std::make_unique<Worker>());
+        for (size_t i = 0; i < n; ++i) threads.emplace_back(&WorkStealingPool::worker_loop, this, i);
+    }
+    ~WorkStealingPool() {
+        {
+            std::lock_guard lock(sleep_mutex);
+            stopping.store(true, std::memory_order_release);
+        }
+        sleep_cv.notify_all();
+        for (auto& t : threads) t.join();
+    }
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    size_t size() const { return workers.size(); }
+
+    // Workers push to their own deque; external callers spread round-robin.
+    void submit(std::function<void()> task) {
+        size_t q = (current_pool == this) ? static_cast<size_t>(current_worker)
+                                          : next_queue.fetch_add(1, std::memory_order_relaxed) % workers.size();
+        {
+            std::lock_guard lock(workers[q]->mutex);
+            workers[q]->tasks.push_back(std::move(task));
+        }
+        {
+            std::lock_guard lock(sleep_mutex);
+            pending.fetch_add(1, std::memory_order_relaxed);
+        }
+        sleep_cv.notify_one();
+    }
+
+    // Runs fn(begin, end) over [0, n) in grain-sized chunks and waits for all of them.
+    // The calling thread executes tasks while it waits, so nested calls cannot deadlock.
+    template <typename F>
+    void parallel_for(size_t n, size_t grain, F&& fn) {
+        if (n == 0) return;
+        grain = std::max<size_t>(grain, 1);
+        size_t chunks = (n + grain - 1) / grain;
+        if (chunks == 1) { fn(size_t(0), n); return; }
+        std::atomic<size_t> remaining{chunks};
+        for (size_t c = 0; c < chunks; ++c) {
+            size_t b = c * grain, e = std::min(n, b + grain);
+            submit([&fn, &remaining, b, e] {
+                fn(b, e);
+                remaining.fetch_sub(1, std::memory_order_acq_rel);
+            });
+        }
+        size_t self = (current_pool == this) ? static_cast<size_t>(current_worker) : 0;
+        while (remaining.load(std::memory_order_acquire) != 0) {
+            if (!run_one(self)) std::this_thread::yield();
+        }
+    }
+};
+
+// Serial fallback when no pool is supplied.
+template <typename F>
+void parallel_for(WorkStealingPool* pool, size_t n, size_t grain, F&& fn) {
+    if (pool) pool->parallel_for(n, grain, std::forward<F>(fn));
+    else if (n) fn(size_t(0), n);
+}
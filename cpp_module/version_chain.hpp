@@ -0,0 +1,117 @@
+// Version Chains
+// Per-object layer history for as-of-layer reads (MVCC)
+// Author: 1proprogrammerchant
+// C++17+ required
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include "epoch_reclaim.hpp"
+
+// Newest-first list of (layer, value) versions. Writers push at the head with a CAS;
+// readers walk it inside an epoch guard and never block. Versions older than the
+// reader horizon are detached by trim() and freed through the epoch manager.
+template <typename T>
+class VersionChain {
+public:
+    struct Version {
+        T value;
+        size_t layer;
+        std::atomic<Version*> prev;
+        Version(const T& v, size_t l, Version* p) : value(v), layer(l), prev(p) {}
+    };
+
+private:
+    std::atomic<Version*> head{nullptr};
+
+    static void free_list(void* p) {
+        for (Version* v = static_cast<Version*>(p); v;) {
+            Version* next = v->prev.load(std::memory_order_relaxed);
+            delete v;
+            v = next;
+        }
+    }
+
+public:
+    VersionChain() = default;
+    VersionChain(const VersionChain&) = delete;
+    VersionChain& operator=(const VersionChain&) = delete;
+    // Readers may still be walking the chain; the nodes go through the epoch manager.
+    ~VersionChain() {
+        if (Version* v = head.exchange(nullptr, std::memory_order_acq_rel)) EpochManager::global().retire(v, free_list);
+    }
+
+    void push(const T& value, size_t layer) {
+        Version* v = new Version(value, layer, head.load(std::memory_order_relaxed));
+        Version* expected = v->prev.load(std::memory_order_relaxed);
+        while (!head.compare_exchange_weak(expected, v, std::memory_order_release, std::memory_order_relaxed))
+            v->prev.store(expected, std::memory_order_relaxed);
+    }
+
+    // Newest version; call inside an epoch guard when other threads may trim.
+    const Version* latest() const { return head.load(std::memory_order_acquire); }
+
+    // Newest version committed at or before layer, or nullptr if the object did not
+    // exist yet (or that part of its history was trimmed). Call inside an epoch guard.
+    const Version* as_of(size_t layer) const {
+        const Version* v = head.load(std::memory_order_acquire);
+        while (v && v->layer > layer) v = v->prev.load(std::memory_order_acquire);
+        return v;
+    }
+
+    // Detaches every version that no read at horizon or later can reach: all versions
+    // behind the newest one with layer <= horizon. Returns how many were retired.
+    // One trimmer per chain at a time (the pool compacts under its own mutex).
+    size_t trim(size_t horizon) {
+        Version* keep = const_cast<Version*>(as_of(horizon));
+        if (!keep) return 0;
+        Version* tail = keep->prev.exchange(nullptr, std::memory_order_acq_rel);
+        if (!tail) return 0;
+        size_t n = 0;
+        for (Version* v = tail; v; v = v->prev.load(std::memory_order_relaxed)) ++n;
+        EpochManager::global().retire(tail, free_list);
+        return n;
+    }
+
+    size_t length() const {
+        size_t n = 0;
+        for (const Version* v = latest(); v; v = v->prev.load(std::memory_order_acquire)) ++n;
+        return n;
+    }
+};
+
+// Layers that open snapshots are reading, and the floor below which history is gone.
+// Both move under one mutex so a snapshot can never open below a concurrent trim.
+class ReaderHorizon {
+    mutable std::mutex mutex;
+    std::map<size_t, size_t> active; // layer -> open snapshot count
+    size_t floor = 0;
+public:
+    // Registers a reader at layer; false if that history was already trimmed.
+    bool enter(size_t layer) {
+        std::lock_guard lock(mutex);
+        if (layer < floor) return false;
+        ++active[layer];
+        return true;
+    }
+    void leave(size_t layer) {
+        std::lock_guard lock(mutex);
+        auto it = active.find(layer);
+        if (it != active.end() && --it->second == 0) active.erase(it);
+    }
+    // Raises the floor toward requested, stopping at the oldest open snapshot.
+    // Returns the new floor: versions only reads below it could need may be trimmed.
+    size_t advance(size_t requested) {
+        std::lock_guard lock(mutex);
+        size_t h = active.empty() ? requested : std::min(active.begin()->first, requested);
+        floor = std::max(floor, h);
+        return floor;
+    }
+    size_t oldest_readable() const {
+        std::lock_guard lock(mutex);
+        return floor;
+    }
+};
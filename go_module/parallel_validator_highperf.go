@@ -5,12 +5,31 @@
 package main
 
 import (
+	"flag"
 	"fmt"
+	"os"
 	"sync"
 	"sync/atomic"
 	"time"
 )
 
+// Ontological states, in the order of the C++ OntState
+type OntState uint8
+
+const (
+	Undefined OntState = iota
+	Defined
+	Referenced
+	Reinterpreted
+	Contradicted
+	Split
+	Merged
+	Abstracted
+	ObserverRelativeState
+	Collapsed
+	ontStateCount
+)
+
 // Reference integrity status
 type RefIntegrityStatus int
 
@@ -45,55 +64,102 @@ func (s RefIntegrityStatus) String() string {
 	}
 }
 
+// Integrity policy: rules declared once, compiled into a table indexed by
+// (state at creation, new state), as cpp_module/integrity_policy.hpp does.
+// A rule with From or To set to anyState matches every state; To == sameState
+// matches when the target is back in its creation state. First match wins.
+const (
+	anyState  OntState = 0xFE
+	sameState OntState = 0xFF
+)
+
+type Rule struct {
+	From, To OntState
+	Status   RefIntegrityStatus
+}
+
+type Policy [ontStateCount][ontStateCount]RefIntegrityStatus
+
+func compilePolicy(rules []Rule) *Policy {
+	var p Policy
+	for c := OntState(0); c < ontStateCount; c++ {
+		for n := OntState(0); n < ontStateCount; n++ {
+			for _, r := range rules {
+				if (r.From == anyState || r.From == c) && (r.To == anyState || r.To == n || (r.To == sameState && n == c)) {
+					p[c][n] = r.Status
+					break
+				}
+			}
+		}
+	}
+	return &p
+}
+
+var policies = map[string]*Policy{
+	"standard": compilePolicy([]Rule{
+		{anyState, Split, Unresolved},
+		{anyState, Merged, IdentityMerged},
+		{anyState, ObserverRelativeState, ObserverRelative},
+		{anyState, Collapsed, Invalidated},
+		{anyState, sameState, Valid},
+		{anyState, anyState, IdentityChanged},
+	}),
+	"reinterpretation_valid": compilePolicy([]Rule{
+		{anyState, Split, Unresolved},
+		{anyState, Merged, IdentityMerged},
+		{anyState, ObserverRelativeState, ObserverRelative},
+		{anyState, Collapsed, Invalidated},
+		{anyState, Reinterpreted, Valid},
+		{anyState, Referenced, Valid},
+		{anyState, sameState, Valid},
+		{anyState, anyState, IdentityChanged},
+	}),
+	"terminal_only": compilePolicy([]Rule{
+		{anyState, Split, Unresolved},
+		{anyState, Collapsed, Invalidated},
+		{anyState, anyState, Valid},
+	}),
+}
+
 // Entity and Reference definitions
 type Entity struct {
-	ID      int
-	Name    string
-	State   string
-	Layer   int
+	ID    int
+	Name  string
+	State OntState
+	Layer int
 }
 
 type Reference struct {
-	ID             int
-	SourceID       int
-	TargetID       int
-	Status         RefIntegrityStatus
-	CandidateIDs   []int
-	LastValidated  int64 // unix timestamp
+	ID            int
+	SourceID      int
+	TargetID      int
+	CreatedState  OntState // target state when the reference was made
+	Status        RefIntegrityStatus
+	CandidateIDs  []int
+	LastValidated int64 // unix timestamp
 }
 
-// Validator engine
-func validateReference(ref *Reference, entities map[int]*Entity, splitMap map[int][]int, wg *sync.WaitGroup) {
+// Validator engine: one table load decides the status
+func validateReference(ref *Reference, policy *Policy, entities map[int]*Entity, splitMap map[int][]int, wg *sync.WaitGroup) {
 	defer wg.Done()
 	target, ok := entities[ref.TargetID]
 	if !ok {
 		ref.Status = Invalidated
 		return
 	}
-	switch target.State {
-	case "Split":
-		ref.Status = Unresolved
+	ref.Status = policy[ref.CreatedState][target.State]
+	if target.State == Split {
 		ref.CandidateIDs = splitMap[target.ID]
-	case "Merged":
-		ref.Status = IdentityMerged
-	case "ObserverRelative":
-		ref.Status = ObserverRelative
-	case "Collapsed":
-		ref.Status = Invalidated
-	case "Defined":
-		ref.Status = Valid
-	default:
-		ref.Status = IdentityChanged
 	}
 	atomic.StoreInt64(&ref.LastValidated, time.Now().UnixNano())
 }
 
 // Parallel validator
-func parallelValidate(references []*Reference, entities map[int]*Entity, splitMap map[int][]int) {
+func parallelValidate(references []*Reference, policy *Policy, entities map[int]*Entity, splitMap map[int][]int) {
 	var wg sync.WaitGroup
 	for _, ref := range references {
 		wg.Add(1)
-		go validateReference(ref, entities, splitMap, &wg)
+		go validateReference(ref, policy, entities, splitMap, &wg)
 	}
 	wg.Wait()
 }
@@ -104,12 +170,19 @@ func leakCheck(references []*Reference) {
 }
 
 func main() {
+	policyName := flag.String("policy", "standard", "integrity policy: standard, reinterpretation_valid, terminal_only")
+	flag.Parse()
+	policy, ok := policies[*policyName]
+	if !ok {
+		fmt.Fprintf(os.Stderr, "unknown policy %s\n", *policyName)
+		os.Exit(2)
+	}
 	// Entities
 	entities := map[int]*Entity{
-		1: {ID: 1, Name: "the man", State: "Defined", Layer: 0},
-		2: {ID: 2, Name: "the voice", State: "Defined", Layer: 1},
-		3: {ID: 3, Name: "the man (aspect A)", State: "Split", Layer: 2},
-		4: {ID: 4, Name: "the man (aspect B)", State: "Split", Layer: 2},
+		1: {ID: 1, Name: "the man", State: Defined, Layer: 0},
+		2: {ID: 2, Name: "the voice", State: Defined, Layer: 1},
+		3: {ID: 3, Name: "the man (aspect A)", State: Split, Layer: 2},
+		4: {ID: 4, Name: "the man (aspect B)", State: Split, Layer: 2},
 	}
 	// Split map for unresolved references
 	splitMap := map[int][]int{
@@ -117,15 +190,15 @@ func main() {
 	}
 	// References
 	references := []*Reference{
-		{ID: 1, SourceID: 2, TargetID: 1},
+		{ID: 1, SourceID: 2, TargetID: 1, CreatedState: Defined},
 	}
 	fmt.Println("Before validation:")
 	for _, ref := range references {
 		fmt.Printf("Reference[%d]: %d -> %d | Status: %s\n", ref.ID, ref.SourceID, ref.TargetID, ref.Status)
 	}
 	// Simulate split
-	entities[1].State = "Split"
-	parallelValidate(references, entities, splitMap)
+	entities[1].State = Split
+	parallelValidate(references, policy, entities, splitMap)
 	fmt.Println("\nAfter validation:")
 	for _, ref := range references {
 		fmt.Printf("Reference[%d]: %d -> %d | Status: %s", ref.ID, ref.SourceID, ref.TargetID, ref.Status)
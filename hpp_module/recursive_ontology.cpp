@@ -1,33 +1,57 @@
 // High-Performance Recursive Ontology and Paradox Resolution Engine (H++)
 // Plane 1: Ontological Logic Plane (Recursive/Paradox)
 // Author: 1proprogrammerchant
-// This is a stub for a higher-order functional/logic language (e.g., H++, Prolog, or advanced Haskell)
+// Recursive identity loops are detected on the real reference graph by the RIE paradox
+// engine (cpp_module/paradox_engine.hpp), not on a single linear chain.
+// Build: g++ -std=c++17 -O2 -pthread recursive_ontology.cpp -o recursive_ontology
 
 #include <iostream>
-#include <vector>
+#include <map>
 #include <string>
+#include <vector>
+#include "../cpp_module/paradox_engine.hpp"
+
+// Identities by name, with the references between them
+struct IdentityGraph {
+    MemoryPool pool;
+    ReferentialIntegrityEngine rie{pool};
+    ParadoxEngine paradoxes{pool, &rie};
+    std::map<std::string, size_t> ids;
+    size_t layer = 0;
 
-// Recursive identity chain structure
-struct IdentityChain {
-    std::vector<std::string> chain;
-    bool is_paradox = false;
-    void add(const std::string& id) {
-        if (!chain.empty() && id == chain.front()) is_paradox = true;
-        chain.push_back(id);
+    size_t identity(const std::string& name) {
+        auto it = ids.find(name);
+        if (it != ids.end()) return it->second;
+        return ids[name] = pool.create_entity(name, {"identity"}, OntState::Defined, layer)->id;
     }
-    void print() const {
-        std::cout << "Identity chain: ";
-        for (const auto& s : chain) std::cout << s << " -> ";
-        std::cout << (is_paradox ? "[PARADOX]" : "[OK]") << std::endl;
+    // "from refers to to"; prints the loop if this reference closes one
+    void refer(const std::string& from, const std::string& to) {
+        size_t s = identity(from), t = identity(to);
+        ++layer;
+        Entity* target = pool.get_entity(t);
+        ReferenceObject* ref = pool.create_reference(s, t, target->state, layer);
+        std::vector<size_t> loop = paradoxes.add_reference(ref->id);
+        std::cout << "Identity chain: " << from << " -> " << to;
+        if (loop.empty()) {
+            std::cout << " [OK]" << std::endl;
+            return;
+        }
+        std::cout << " [PARADOX] {";
+        for (size_t i = 0; i < loop.size(); ++i) std::cout << (i ? ", " : "") << pool.get_entity(loop[i])->name_str();
+        std::cout << "} marked Contradicted" << std::endl;
     }
 };
 
 int main() {
-    IdentityChain ic;
-    ic.add("A");
-    ic.add("B");
-    ic.add("C");
-    ic.add("A"); // recursive reference
-    ic.print();
+    IdentityGraph g;
+    g.refer("A", "B");
+    g.refer("B", "C");
+    g.refer("C", "A"); // recursive reference, closing at the start
+    g.refer("D", "E");
+    g.refer("E", "F");
+    g.refer("F", "E"); // closes mid-chain
+    g.refer("G", "G"); // self-reference
+    g.refer("C", "D"); // joins the loops without creating a new one
+    g.refer("F", "B"); // merges both loops into one
     return 0;
 }
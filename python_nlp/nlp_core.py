@@ -6,9 +6,17 @@ OPA-∞: This module only proposes semantic mutations and interpretations.
 It never mutates or finalizes identity. All input/output is by identity key.
 """
 
-from typing import List, Dict, Any
+from typing import List, Dict, Any, Tuple
+from array import array
 import json
 
+# Batched bridge wire format (cpp_module/python_bridge.h).
+# Requests: records separated by RS, fields by US: identity_key, from, layer, to...
+# Proposals: u32 count, count * 8 u32 (key, from, to, type as offset/length pairs into
+# the string blob), count * u32 layer, then the UTF-8 blob. Native byte order.
+RECORD_SEP = "\x1e"
+FIELD_SEP = "\x1f"
+
 class SemanticProposal:
     def __init__(self, identity_key: str, from_surface: str, to_surface: str, proposal_type: str, layer: int):
         self.identity_key = identity_key
@@ -36,6 +44,17 @@ class NLPCore:
         self.history.extend(proposals)
         return proposals
 
+    def propose_mutations_batch(self, packed: bytes) -> bytes:
+        """propose_mutations over many identity keys in one call; see the wire format above.
+        The embedding process keeps one NLPCore alive, so batches are not added to history."""
+        proposals: List[SemanticProposal] = []
+        for record in packed.decode("utf-8").split(RECORD_SEP):
+            if not record:
+                continue
+            key, from_surface, layer, *to_surfaces = record.split(FIELD_SEP)
+            proposals.extend(SemanticProposal(key, from_surface, to, "mutation", int(layer)) for to in to_surfaces)
+        return encode_proposals(proposals)
+
     def get_history(self) -> List[Dict[str, Any]]:
         return [p.to_dict() for p in self.history]
 
@@ -43,6 +62,23 @@ class NLPCore:
         for p in self.history:
             print(p)
 
+def encode_proposals(proposals: List[SemanticProposal]) -> bytes:
+    spans = array("I", [len(proposals)])
+    layers = array("I", [p.layer for p in proposals])
+    found: Dict[str, Tuple[int, int]] = {}  # repeated strings (keys, sources, types) are stored once
+    blob: List[bytes] = []
+    size = 0
+    for p in proposals:
+        for text in (p.identity_key, p.from_surface, p.to_surface, p.proposal_type):
+            span = found.get(text)
+            if span is None:
+                raw = text.encode("utf-8")
+                span = found[text] = (size, len(raw))
+                blob.append(raw)
+                size += len(raw)
+            spans.extend(span)
+    return spans.tobytes() + layers.tobytes() + b"".join(blob)
+
 if __name__ == "__main__":
     core = NLPCore()
     # Example: identity_key is a 128-bit string (simulate)